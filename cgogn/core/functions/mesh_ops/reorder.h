@@ -0,0 +1,399 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+
+#ifndef CGOGN_CORE_FUNCTIONS_MESH_OPS_REORDER_H_
+#define CGOGN_CORE_FUNCTIONS_MESH_OPS_REORDER_H_
+
+#include <cgogn/core/cgogn_core_export.h>
+
+#include <cgogn/core/types/cmap/cmap_base.h>
+#include <cgogn/core/types/cmap/dart_marker.h>
+#include <cgogn/core/types/cmap/orbit_traversal.h>
+#include <cgogn/core/types/cmap/phi.h>
+
+#include <cgogn/core/functions/traversals/global.h>
+
+#include <cgogn/core/utils/radix_sort.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace cgogn
+{
+
+/*****************************************************************************/
+
+// template <typename MESH>
+// void reorder(MESH& m);
+
+// template <typename MESH, typename ATTRIBUTE>
+// void reorder(MESH& m, const ATTRIBUTE* vertex_position);
+
+/*****************************************************************************/
+
+namespace internal
+{
+
+// top-dimensional cells of the map (faces of a CMap2, volumes of a CMap3)
+template <typename MESH>
+using ReorderCell = std::conditional_t<mesh_traits<MESH>::dimension == 2, typename mesh_traits<MESH>::Face,
+									   typename mesh_traits<MESH>::Volume>;
+
+template <typename MESH>
+inline Dart reorder_phi(const MESH& m, Dart d)
+{
+	if constexpr (mesh_traits<MESH>::dimension == 2)
+		return phi2(m, d);
+	else
+		return phi3(m, d);
+}
+
+// renumber the elements of the container so that the elements first met in order come first
+// (released or unreached indices are moved at the end)
+template <typename CONTAINER>
+std::vector<uint32> reorder_container(CONTAINER& container, const std::vector<uint32>& order)
+{
+	const uint32 n = container.maximum_index();
+	std::vector<uint32> new_to_old;
+	new_to_old.reserve(n);
+	std::vector<uint32> old_to_new(n, INVALID_INDEX);
+	for (uint32 i : order)
+	{
+		if (i < n && old_to_new[i] == INVALID_INDEX)
+		{
+			old_to_new[i] = uint32(new_to_old.size());
+			new_to_old.push_back(i);
+		}
+	}
+	for (uint32 i = 0u; i < n; ++i)
+	{
+		if (old_to_new[i] == INVALID_INDEX)
+		{
+			old_to_new[i] = uint32(new_to_old.size());
+			new_to_old.push_back(i);
+		}
+	}
+	container.permute(new_to_old);
+	return old_to_new;
+}
+
+// update the relations after a renumbering of the darts
+inline void remap_relations(CMapBase& m, const std::vector<uint32>& dart_old_to_new)
+{
+	const uint32 nb = std::min(m.darts_.maximum_index(), uint32(dart_old_to_new.size()));
+	const uint32 max_dart = uint32(dart_old_to_new.size());
+	for (auto& relation : m.relations_)
+	{
+		CMapBase::Attribute<Dart>& r = *relation;
+		thread_pool()->parallel_for(0u, nb, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				// values of released darts are meaningless
+				if (r[i].index < max_dart)
+					r[i] = Dart(dart_old_to_new[r[i].index]);
+			}
+		});
+	}
+}
+
+// update the indices of the cells of the given orbit after a renumbering of their container
+inline void remap_cells_indices(CMapBase& m, Orbit orbit, const std::vector<uint32>& cell_old_to_new)
+{
+	CMapBase::Attribute<uint32>& indices = *m.cells_indices_[orbit];
+	const uint32 max_cell = uint32(cell_old_to_new.size());
+	thread_pool()->parallel_for(0u, m.darts_.maximum_index(), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			if (indices[i] < max_cell)
+				indices[i] = cell_old_to_new[indices[i]];
+		}
+	});
+}
+
+// renumber darts along the given ordering of the top-dimensional cells, then renumber the cells of every
+// indexed orbit in the order of their first dart
+template <typename MESH>
+void reorder_darts(MESH& m, const std::vector<Dart>& cells)
+{
+	using TopCell = ReorderCell<MESH>;
+
+	CMapBase& mb = static_cast<CMapBase&>(m);
+
+	// darts of each cell are made consecutive, remaining (boundary) darts follow
+	std::vector<uint32> dart_order;
+	dart_order.reserve(mb.darts_.nb_elements());
+	{
+		DartEpochMarker dm(m);
+		for (Dart c : cells)
+		{
+			foreach_dart_of_orbit(m, TopCell(c), [&](Dart d) -> bool {
+				dm.mark(d);
+				dart_order.push_back(d.index);
+				return true;
+			});
+		}
+		for (Dart d = mb.begin(), end = mb.end(); d != end; d = mb.next(d))
+		{
+			if (!dm.is_marked(d))
+				dart_order.push_back(d.index);
+		}
+	}
+	const uint32 nb_darts = uint32(dart_order.size());
+
+	std::vector<uint32> dart_old_to_new = reorder_container(mb.darts_, dart_order);
+	dart_order.clear();
+	dart_order.shrink_to_fit();
+
+	remap_relations(mb, dart_old_to_new);
+
+	for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+	{
+		if (mb.cells_indices_[orbit] == nullptr)
+			continue;
+		const CMapBase::Attribute<uint32>& indices = *mb.cells_indices_[orbit];
+
+		std::vector<uint32> cell_order;
+		cell_order.reserve(mb.attribute_containers_[orbit].nb_elements());
+		for (uint32 i = 0u; i < nb_darts; ++i)
+		{
+			if (indices[i] != INVALID_INDEX)
+				cell_order.push_back(indices[i]);
+		}
+
+		remap_cells_indices(mb, Orbit(orbit), reorder_container(mb.attribute_containers_[orbit], cell_order));
+	}
+}
+
+} // namespace internal
+
+///////////////////////////////
+// CMapBase (or convertible) //
+///////////////////////////////
+
+/**
+ * @brief renumber darts and cells of the map for memory locality:
+ * top-dimensional cells (faces of a CMap2, volumes of a CMap3) are ordered by a breadth-first traversal
+ * of their adjacency graph, darts follow the cells and every indexed orbit follows the darts.
+ * Every attribute and relation is permuted accordingly and released indices are moved at the end.
+ * Darts and cells kept outside of the map (CellCache, stored Dart values, ...) are invalidated.
+ * @param m the map to reorder
+ */
+template <typename MESH>
+auto reorder(MESH& m)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, CMapBase&> &&
+						(mesh_traits<MESH>::dimension == 2 || mesh_traits<MESH>::dimension == 3)>
+{
+	using TopCell = internal::ReorderCell<MESH>;
+
+	std::vector<Dart> cells;
+	DartEpochMarker dm(m);
+	auto visit = [&](Dart c) {
+		foreach_dart_of_orbit(m, TopCell(c), [&](Dart d) -> bool {
+			dm.mark(d);
+			return true;
+		});
+		cells.push_back(c);
+	};
+
+	std::deque<Dart> queue;
+	foreach_cell(m, [&](TopCell c) -> bool {
+		if (dm.is_marked(c.dart))
+			return true;
+		visit(c.dart);
+		queue.push_back(c.dart);
+		while (!queue.empty())
+		{
+			Dart cd = queue.front();
+			queue.pop_front();
+			foreach_dart_of_orbit(m, TopCell(cd), [&](Dart d) -> bool {
+				Dart n = internal::reorder_phi(m, d);
+				if (!dm.is_marked(n) && !is_boundary(m, n))
+				{
+					visit(n);
+					queue.push_back(n);
+				}
+				return true;
+			});
+		}
+		return true;
+	});
+
+	internal::reorder_darts(m, cells);
+}
+
+/**
+ * @brief renumber darts and cells of the map for memory locality:
+ * top-dimensional cells (faces of a CMap2, volumes of a CMap3) are ordered along the Morton (Z-order) curve
+ * of their barycenter, darts follow the cells and every indexed orbit follows the darts.
+ * Every attribute and relation is permuted accordingly and released indices are moved at the end.
+ * Darts and cells kept outside of the map (CellCache, stored Dart values, ...) are invalidated.
+ * @param m the map to reorder
+ * @param vertex_position the vertex position attribute (3 coordinates) used to compute the barycenters
+ */
+template <typename MESH, typename ATTRIBUTE>
+auto reorder(MESH& m, const ATTRIBUTE* vertex_position)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, CMapBase&> &&
+						(mesh_traits<MESH>::dimension == 2 || mesh_traits<MESH>::dimension == 3)>
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using TopCell = internal::ReorderCell<MESH>;
+
+	std::vector<Dart> cells;
+	std::vector<std::array<float64, 3>> barycenters;
+	foreach_cell(m, [&](TopCell c) -> bool {
+		std::array<float64, 3> b = {0.0, 0.0, 0.0};
+		uint32 nb = 0u;
+		foreach_dart_of_orbit(m, c, [&](Dart d) -> bool {
+			const auto& p = (*vertex_position)[index_of(m, Vertex(d))];
+			for (uint32 k = 0u; k < 3u; ++k)
+				b[k] += p[k];
+			++nb;
+			return true;
+		});
+		for (uint32 k = 0u; k < 3u; ++k)
+			b[k] /= nb;
+		cells.push_back(c.dart);
+		barycenters.push_back(b);
+		return true;
+	});
+
+	const uint32 nb_cells = uint32(cells.size());
+	std::array<float64, 3> bb_min, bb_max;
+	bb_min.fill(std::numeric_limits<float64>::max());
+	bb_max.fill(std::numeric_limits<float64>::lowest());
+	for (const auto& b : barycenters)
+	{
+		for (uint32 k = 0u; k < 3u; ++k)
+		{
+			bb_min[k] = std::min(bb_min[k], b[k]);
+			bb_max[k] = std::max(bb_max[k], b[k]);
+		}
+	}
+
+	// 21 bits per axis interleaved in a 63 bits key
+	auto spread_bits = [](uint64 x) -> uint64 {
+		x &= 0x1fffffull;
+		x = (x | x << 32) & 0x1f00000000ffffull;
+		x = (x | x << 16) & 0x1f0000ff0000ffull;
+		x = (x | x << 8) & 0x100f00f00f00f00full;
+		x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+		x = (x | x << 2) & 0x1249249249249249ull;
+		return x;
+	};
+
+	std::vector<uint64> keys(nb_cells);
+	std::vector<uint32> order(nb_cells);
+	thread_pool()->parallel_for(0u, nb_cells, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint64 key = 0u;
+			for (uint32 k = 0u; k < 3u; ++k)
+			{
+				const float64 extent = bb_max[k] - bb_min[k];
+				const float64 t = extent > 0.0 ? (barycenters[i][k] - bb_min[k]) / extent : 0.0;
+				key |= spread_bits(uint64(t * float64(0x1fffff))) << k;
+			}
+			keys[i] = key;
+			order[i] = i;
+		}
+	});
+	radix_sort(keys, order, 63u);
+
+	std::vector<Dart> sorted_cells(nb_cells);
+	for (uint32 i = 0u; i < nb_cells; ++i)
+		sorted_cells[i] = cells[order[i]];
+
+	internal::reorder_darts(m, sorted_cells);
+}
+
+/*****************************************************************************/
+
+// template <typename MESH>
+// float64 fragmentation(const MESH& m);
+
+/*****************************************************************************/
+
+///////////////////////////////
+// CMapBase (or convertible) //
+///////////////////////////////
+
+/**
+ * @brief ratio of released indices among the darts and the indexed cells of the map
+ * (traversals still walk released indices, compact the map when it gets high)
+ */
+inline float64 fragmentation(const CMapBase& m)
+{
+	uint64 nb_elements = m.darts_.nb_elements();
+	uint64 nb_indices = m.darts_.maximum_index();
+	for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+	{
+		if (m.cells_indices_[orbit] == nullptr)
+			continue;
+		nb_elements += m.attribute_containers_[orbit].nb_elements();
+		nb_indices += m.attribute_containers_[orbit].maximum_index();
+	}
+	return nb_indices > 0u ? 1.0 - float64(nb_elements) / float64(nb_indices) : 0.0;
+}
+
+/*****************************************************************************/
+
+// template <typename MESH>
+// void compact(MESH& m);
+
+/*****************************************************************************/
+
+///////////////////////////////
+// CMapBase (or convertible) //
+///////////////////////////////
+
+/**
+ * @brief squeeze out the released darts and cells of the map:
+ * live darts and cells keep their relative order, relations and cells indices are remapped
+ * and the storage beyond the live elements is released.
+ * Darts and cells kept outside of the map (CellCache, stored Dart values, ...) are invalidated.
+ */
+inline void compact(CMapBase& m)
+{
+	// cells first: the cells indices are stored in the dart container
+	for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+	{
+		if (m.cells_indices_[orbit] == nullptr)
+			continue;
+		std::vector<uint32> cell_old_to_new = m.attribute_containers_[orbit].compact();
+		if (!cell_old_to_new.empty())
+			internal::remap_cells_indices(m, Orbit(orbit), cell_old_to_new);
+	}
+
+	std::vector<uint32> dart_old_to_new = m.darts_.compact();
+	if (!dart_old_to_new.empty())
+		internal::remap_relations(m, dart_old_to_new);
+}
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_FUNCTIONS_MESH_OPS_REORDER_H_
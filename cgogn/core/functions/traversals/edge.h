@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/utils/small_vector.h>
 #include <cgogn/core/utils/tuples.h>
 #include <cgogn/core/utils/type_traits.h>
 
@@ -158,7 +159,7 @@ auto foreach_incident_edge(const IncidenceGraph& ig, CELL c, const FUNC& func)
 /*****************************************************************************/
 
 // template <typename MESH, typename CELL>
-// std::vector<typename mesh_traits<MESH>::Edge> incident_edges(MESH& m, CELL c);
+// CellVector<typename mesh_traits<MESH>::Edge> incident_edges(MESH& m, CELL c);
 
 /*****************************************************************************/
 
@@ -167,11 +168,10 @@ auto foreach_incident_edge(const IncidenceGraph& ig, CELL c, const FUNC& func)
 /////////////
 
 template <typename MESH, typename CELL>
-std::vector<typename mesh_traits<MESH>::Edge> incident_edges(const MESH& m, CELL c)
+CellVector<typename mesh_traits<MESH>::Edge> incident_edges(const MESH& m, CELL c)
 {
 	using Edge = typename mesh_traits<MESH>::Edge;
-	std::vector<Edge> edges;
-	edges.reserve(32u);
+	CellVector<Edge> edges;
 	foreach_incident_edge(m, c, [&](Edge e) -> bool {
 		edges.push_back(e);
 		return true;
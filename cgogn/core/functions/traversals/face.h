@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/utils/small_vector.h>
 #include <cgogn/core/utils/tuples.h>
 #include <cgogn/core/utils/type_traits.h>
 
@@ -277,7 +278,7 @@ auto foreach_incident_face(const IncidenceGraph& ig, CELL c, const FUNC& func)
 /*****************************************************************************/
 
 // template <typename MESH, typename CELL>
-// std::vector<typename mesh_traits<MESH>::Face> incident_faces(MESH& m, CELL c);
+// CellVector<typename mesh_traits<MESH>::Face> incident_faces(MESH& m, CELL c);
 
 /*****************************************************************************/
 
@@ -286,11 +287,10 @@ auto foreach_incident_face(const IncidenceGraph& ig, CELL c, const FUNC& func)
 /////////////
 
 template <typename MESH, typename CELL>
-std::vector<typename mesh_traits<MESH>::Face> incident_faces(const MESH& m, CELL c)
+CellVector<typename mesh_traits<MESH>::Face> incident_faces(const MESH& m, CELL c)
 {
 	using Face = typename mesh_traits<MESH>::Face;
-	std::vector<Face> faces;
-	faces.reserve(32u);
+	CellVector<Face> faces;
 	foreach_incident_face(m, c, [&](Face f) -> bool {
 		faces.push_back(f);
 		return true;
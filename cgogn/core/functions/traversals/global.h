@@ -37,6 +37,8 @@
 #include <cgogn/core/types/cmap/dart_marker.h>
 #include <cgogn/core/types/cmap/orbit_traversal.h>
 
+#include <atomic>
+
 namespace cgogn
 {
 
@@ -68,7 +70,7 @@ auto foreach_cell(const MESH& m, const FUNC& f, CMapBase::TraversalPolicy traver
 
 	if (traversal_policy == CMapBase::TraversalPolicy::AUTO && is_indexed<CELL>(m))
 	{
-		CellMarker<MESH, CELL> cm(m);
+		CellEpochMarker<MESH, CELL> cm(m);
 		for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
 		{
 			const CELL c(d);
@@ -82,7 +84,7 @@ auto foreach_cell(const MESH& m, const FUNC& f, CMapBase::TraversalPolicy traver
 	}
 	else
 	{
-		DartMarker dm(m);
+		DartEpochMarker dm(m);
 		for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
 		{
 			if (!is_boundary(m, d) && !dm.is_marked(d))
@@ -184,115 +186,63 @@ auto parallel_foreach_cell(const MESH& m, const FUNC& f) -> std::enable_if_t<std
 	if (nb_workers == 0)
 		return foreach_cell(m, f);
 
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
-
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
-
-	Buffers<uint32>* buffers = uint32_buffers();
+	// the darts range is split among the workers which enumerate the cells themselves: a cell is handled by the
+	// non-boundary dart of smallest index of its orbit, which is also the dart given by foreach_cell
+	// - indexed cells: a first pass reduces the smallest dart of each index, a second pass calls f on these darts
+	// - otherwise each dart compares itself with the other darts of its orbit
 
-	Dart it = m.begin();
-	Dart last = m.end();
-
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
+	const uint32 first = m.begin().index;
+	const uint32 last = m.end().index;
 
 	if (is_indexed<CELL>(m))
 	{
-		CellMarker<MESH, CELL> cm(m);
-		while (it.index < last.index)
-		{
-			// fill buffer
-			cells_buffers[i].push_back(buffers->buffer());
-			VecCell& cells = *cells_buffers[i].back();
-			cells.reserve(PARALLEL_BUFFER_SIZE);
-			for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it.index < last.index;)
+		const CMapBase& mb = static_cast<const CMapBase&>(m);
+		std::vector<std::atomic<uint32>> representative(mb.attribute_containers_[CELL::ORBIT].maximum_index());
+		pool->parallel_for(0u, uint32(representative.size()), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+				representative[i].store(INVALID_INDEX, std::memory_order_relaxed);
+		});
+		pool->parallel_for(first, last, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (Dart it = b == first ? Dart(b) : m.next(Dart(b - 1)); it.index < e; it = m.next(it))
 			{
-				CELL c(it);
-				if (!is_boundary(m, it) && !cm.is_marked(c))
-				{
-					cm.mark(c);
-					cells.push_back(c.dart.index);
-					++k;
-				}
-				it = m.next(it);
+				if (is_boundary(m, it))
+					continue;
+				std::atomic<uint32>& r = representative[index_of(m, CELL(it))];
+				uint32 current = r.load(std::memory_order_relaxed);
+				while (it.index < current && !r.compare_exchange_weak(current, it.index, std::memory_order_relaxed))
+					;
 			}
-			// launch thread
-			futures[i].push_back(pool->enqueue([&cells, &f]() {
-				for (uint32 index : cells)
-					f(CELL(Dart(index)));
-			}));
-			// next thread
-			if (++j == nb_workers)
-			{ // again from 0 & change buffer
-				j = 0u;
-				i = (i + 1u) % 2u;
-				for (auto& fu : futures[i])
-					fu.wait();
-				for (auto& b : cells_buffers[i])
-					buffers->release_buffer(b);
-				futures[i].clear();
-				cells_buffers[i].clear();
+		});
+		pool->parallel_for(first, last, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (Dart it = b == first ? Dart(b) : m.next(Dart(b - 1)); it.index < e; it = m.next(it))
+			{
+				if (is_boundary(m, it))
+					continue;
+				CELL c(it);
+				if (representative[index_of(m, c)].load(std::memory_order_relaxed) == it.index)
+					f(c);
 			}
-		}
+		});
 	}
 	else
 	{
-		DartMarker dm(m);
-		while (it.index < last.index)
-		{
-			// fill buffer
-			cells_buffers[i].push_back(buffers->buffer());
-			VecCell& cells = *cells_buffers[i].back();
-			cells.reserve(PARALLEL_BUFFER_SIZE);
-			for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it.index < last.index;)
+		pool->parallel_for(first, last, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (Dart it = b == first ? Dart(b) : m.next(Dart(b - 1)); it.index < e; it = m.next(it))
 			{
-				if (!is_boundary(m, it) && !dm.is_marked(it))
-				{
-					CELL c(it);
-					foreach_dart_of_orbit(m, c, [&](Dart d) -> bool {
-						dm.mark(d);
-						return true;
-					});
-					cells.push_back(c.dart.index);
-					++k;
-				}
-				it = m.next(it);
-			}
-			// launch thread
-			futures[i].push_back(pool->enqueue([&cells, &f]() {
-				for (uint32 index : cells)
-					f(CELL(Dart(index)));
-			}));
-			// next thread
-			if (++j == nb_workers)
-			{ // again from 0 & change buffer
-				j = 0u;
-				i = (i + 1u) % 2u;
-				for (auto& fu : futures[i])
-					fu.wait();
-				for (auto& b : cells_buffers[i])
-					buffers->release_buffer(b);
-				futures[i].clear();
-				cells_buffers[i].clear();
+				if (is_boundary(m, it))
+					continue;
+				CELL c(it);
+				bool representative = true;
+				foreach_dart_of_orbit(m, c, [&](Dart d) -> bool {
+					if (d.index < it.index && !is_boundary(m, d))
+						representative = false;
+					return representative;
+				});
+				if (representative)
+					f(c);
 			}
-		}
+		});
 	}
-
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
 }
 
 /////////////////////////////////////
@@ -313,63 +263,14 @@ auto parallel_foreach_cell(const IncidenceGraph& m, const FUNC& f)
 	if (nb_workers == 0)
 		return foreach_cell(m, f);
 
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
-
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
-
-	Buffers<uint32>* buffers = uint32_buffers();
-
-	uint32 it = m.attribute_containers_[CELL::CELL_INDEX].first_index();
-	uint32 last = m.attribute_containers_[CELL::CELL_INDEX].last_index();
-
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
+	const auto& container = m.attribute_containers_[CELL::CELL_INDEX];
+	const uint32 first = container.first_index();
+	const uint32 last = container.last_index();
 
-	while (it < last)
-	{
-		// fill buffer
-		cells_buffers[i].push_back(buffers->buffer());
-		VecCell& cells = *cells_buffers[i].back();
-		cells.reserve(PARALLEL_BUFFER_SIZE);
-		for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it < last; ++k)
-		{
-			cells.push_back(it);
-			it = m.attribute_containers_[CELL::CELL_INDEX].next_index(it);
-		}
-		// launch thread
-		futures[i].push_back(pool->enqueue([&cells, &f]() {
-			for (uint32 index : cells)
-				f(CELL(index));
-		}));
-		// next thread
-		if (++j == nb_workers)
-		{ // again from 0 & change buffer
-			j = 0u;
-			i = (i + 1u) % 2u;
-			for (auto& fu : futures[i])
-				fu.wait();
-			for (auto& b : cells_buffers[i])
-				buffers->release_buffer(b);
-			futures[i].clear();
-			cells_buffers[i].clear();
-		}
-	}
-
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
+	pool->parallel_for(first, last, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 it = b == first ? b : container.next_index(b - 1); it < e; it = container.next_index(it))
+			f(CELL(it));
+	});
 }
 
 ///////////////
@@ -389,63 +290,11 @@ void parallel_foreach_cell(const CellCache<MESH>& cc, const FUNC& f)
 	if (nb_workers == 0)
 		return foreach_cell(cc, f);
 
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
-
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
-
-	Buffers<uint32>* buffers = uint32_buffers();
-
-	auto it = cc.template begin<CELL>();
-	auto last = cc.template end<CELL>();
-
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
-
-	while (it != last)
-	{
-		// fill buffer
-		cells_buffers[i].push_back(buffers->buffer());
-		VecCell& cells = *cells_buffers[i].back();
-		cells.reserve(PARALLEL_BUFFER_SIZE);
-		for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it != last; ++k)
-		{
-			cells.push_back((*it).dart.index);
-			it++;
-		}
-		// launch thread
-		futures[i].push_back(pool->enqueue([&cells, &f]() {
-			for (uint32 index : cells)
-				f(CELL(Dart(index)));
-		}));
-		// next thread
-		if (++j == nb_workers)
-		{ // again from 0 & change buffer
-			j = 0;
-			i = (i + 1u) % 2u;
-			for (auto& fu : futures[i])
-				fu.wait();
-			for (auto& b : cells_buffers[i])
-				buffers->release_buffer(b);
-			futures[i].clear();
-			cells_buffers[i].clear();
-		}
-	}
-
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
+	const std::vector<CELL>& cells = cc.template cell_vector<CELL>();
+	pool->parallel_for(0u, uint32(cells.size()), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+			f(cells[i]);
+	});
 }
 
 ////////////////
@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/utils/small_vector.h>
 #include <cgogn/core/utils/tuples.h>
 #include <cgogn/core/utils/type_traits.h>
 
@@ -59,7 +60,7 @@ auto foreach_incident_halfedge(const MESH& m, CELL c, const FUNC& func)
 /*****************************************************************************/
 
 // template <typename MESH, typename CELL>
-// std::vector<typename mesh_traits<MESH>::HalfEdge> incident_halfedges(MESH& m, CELL c);
+// CellVector<typename mesh_traits<MESH>::HalfEdge> incident_halfedges(MESH& m, CELL c);
 
 /*****************************************************************************/
 
@@ -68,11 +69,10 @@ auto foreach_incident_halfedge(const MESH& m, CELL c, const FUNC& func)
 /////////////
 
 template <typename MESH, typename CELL>
-std::vector<typename mesh_traits<MESH>::HalfEdge> incident_halfedges(const MESH& m, CELL c)
+CellVector<typename mesh_traits<MESH>::HalfEdge> incident_halfedges(const MESH& m, CELL c)
 {
 	using HalfEdge = typename mesh_traits<MESH>::HalfEdge;
-	std::vector<HalfEdge> halfedges;
-	halfedges.reserve(32u);
+	CellVector<HalfEdge> halfedges;
 	foreach_incident_halfedge(m, c, [&](HalfEdge e) -> bool {
 		halfedges.push_back(e);
 		return true;
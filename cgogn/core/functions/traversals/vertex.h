@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/utils/small_vector.h>
 #include <cgogn/core/utils/tuples.h>
 #include <cgogn/core/utils/type_traits.h>
 
@@ -247,7 +248,7 @@ auto foreach_adjacent_vertex_through_edge(const MESH& m, typename mesh_traits<ME
 /*****************************************************************************/
 
 // template <typename CELL, typename MESH>
-// std::vector<typename mesh_traits<MESH>::Vertex> incident_vertices(const MESH& m, CELL c);
+// CellVector<typename mesh_traits<MESH>::Vertex> incident_vertices(const MESH& m, CELL c);
 
 /*****************************************************************************/
 
@@ -256,11 +257,10 @@ auto foreach_adjacent_vertex_through_edge(const MESH& m, typename mesh_traits<ME
 /////////////
 
 template <typename MESH, typename CELL>
-std::vector<typename mesh_traits<MESH>::Vertex> incident_vertices(const MESH& m, CELL c)
+CellVector<typename mesh_traits<MESH>::Vertex> incident_vertices(const MESH& m, CELL c)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
-	std::vector<Vertex> vertices;
-	vertices.reserve(32u);
+	CellVector<Vertex> vertices;
 	foreach_incident_vertex(m, c, [&](Vertex v) -> bool {
 		vertices.push_back(v);
 		return true;
@@ -293,7 +293,7 @@ void append_incident_vertices(const MESH& m, CELL c, std::vector<typename mesh_t
 /*****************************************************************************/
 
 // template <typename MESH>
-// std::vector<typename mesh_traits<MESH>::Vertex>
+// CellVector<typename mesh_traits<MESH>::Vertex>
 // adjacent_vertices_through_edge(MESH& m, typename mesh_traits<MESH>::Vertex v);
 
 /*****************************************************************************/
@@ -303,12 +303,11 @@ void append_incident_vertices(const MESH& m, CELL c, std::vector<typename mesh_t
 /////////////
 
 template <typename MESH>
-std::vector<typename mesh_traits<MESH>::Vertex> adjacent_vertices_through_edge(const MESH& m,
-																			   typename mesh_traits<MESH>::Vertex v)
+CellVector<typename mesh_traits<MESH>::Vertex> adjacent_vertices_through_edge(const MESH& m,
+																			  typename mesh_traits<MESH>::Vertex v)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
-	std::vector<Vertex> vertices;
-	vertices.reserve(32u);
+	CellVector<Vertex> vertices;
 	foreach_adjacent_vertex_through_edge(m, v, [&](Vertex av) -> bool {
 		vertices.push_back(av);
 		return true;
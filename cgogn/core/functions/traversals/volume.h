@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/utils/small_vector.h>
 #include <cgogn/core/utils/tuples.h>
 #include <cgogn/core/utils/type_traits.h>
 
@@ -158,7 +159,7 @@ auto foreach_incident_volume(const MESH& m, CELL c, const FUNC& func, CMapBase::
 /*****************************************************************************/
 
 // template <typename MESH, typename CELL>
-// std::vector<typename mesh_traits<MESH>::Volume> incident_volumes(const MESH& m, CELL c);
+// CellVector<typename mesh_traits<MESH>::Volume> incident_volumes(const MESH& m, CELL c);
 
 /*****************************************************************************/
 
@@ -167,15 +168,14 @@ auto foreach_incident_volume(const MESH& m, CELL c, const FUNC& func, CMapBase::
 /////////////
 
 template <typename MESH, typename CELL>
-std::vector<typename mesh_traits<MESH>::Volume> incident_volumes(const MESH& m, CELL c)
+CellVector<typename mesh_traits<MESH>::Volume> incident_volumes(const MESH& m, CELL c)
 {
 	using Volume = typename mesh_traits<MESH>::Volume;
 	if constexpr (mesh_traits<MESH>::dimension == 2)
 		return {Volume(c.dart)};
 	else
 	{
-		std::vector<Volume> volumes;
-		volumes.reserve(32u);
+		CellVector<Volume> volumes;
 		foreach_incident_volume(m, c, [&](Volume v) -> bool {
 			volumes.push_back(v);
 			return true;
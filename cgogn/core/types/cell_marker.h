@@ -94,6 +94,67 @@ void release_mark_attribute(const IncidenceGraph& ig, IncidenceGraph::MarkAttrib
 
 /*****************************************************************************/
 
+// template <typename CELL, typename MESH>
+// typename mesh_traits<MESH>::EpochMark* get_epoch_mark_attribute(const MESH& m);
+
+/*****************************************************************************/
+
+//////////////
+// CMapBase //
+//////////////
+
+template <typename CELL, typename MESH>
+auto get_epoch_mark_attribute(const MESH& m)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, CMapBase&>, typename mesh_traits<MESH>::EpochMark*>
+{
+	static_assert(is_in_tuple<CELL, typename mesh_traits<MESH>::Cells>::value, "CELL not supported in this MESH");
+	if (!is_indexed<CELL>(m))
+		index_cells<CELL>(const_cast<MESH&>(m));
+	const CMapBase& mb = static_cast<const CMapBase&>(m);
+	return mb.attribute_containers_[CELL::ORBIT].get_epoch_mark_attribute();
+}
+
+////////////////////
+// IncidenceGraph //
+////////////////////
+
+template <typename CELL>
+auto get_epoch_mark_attribute(const IncidenceGraph& ig)
+{
+	static_assert(is_in_tuple<CELL, typename mesh_traits<IncidenceGraph>::Cells>::value,
+				  "CELL not supported in this MESH");
+	return ig.attribute_containers_[CELL::CELL_INDEX].get_epoch_mark_attribute();
+}
+
+/*****************************************************************************/
+
+// template <typename CELL, typename MESH>
+// void release_epoch_mark_attribute(const MESH& m, typename mesh_traits<MESH>::EpochMark* attribute);
+
+/*****************************************************************************/
+
+//////////////
+// CMapBase //
+//////////////
+
+template <typename CELL>
+void release_epoch_mark_attribute(const CMapBase& m, CMapBase::EpochMark* attribute)
+{
+	return m.attribute_containers_[CELL::ORBIT].release_epoch_mark_attribute(attribute);
+}
+
+////////////////////
+// IncidenceGraph //
+////////////////////
+
+template <typename CELL>
+void release_epoch_mark_attribute(const IncidenceGraph& ig, IncidenceGraph::EpochMark* attribute)
+{
+	return ig.attribute_containers_[CELL::CELL_INDEX].release_epoch_mark_attribute(attribute);
+}
+
+/*****************************************************************************/
+
 template <typename MESH, typename CELL>
 class CellMarker
 {
@@ -198,6 +259,53 @@ public:
 	}
 };
 
+/**
+ * @brief cell marker whose unmark_all (and destruction) cost does not depend on the number of cells:
+ * marks store the current epoch of a pooled attribute and unmarking everything starts a new epoch.
+ * Prefer it over CellMarker for local traversals on large meshes.
+ */
+template <typename MESH, typename CELL>
+class CellEpochMarker
+{
+private:
+	const MESH& mesh_;
+	typename mesh_traits<MESH>::EpochMark* epoch_mark_;
+	decltype(epoch_mark_->attribute()) mark_attribute_;
+
+public:
+	CellEpochMarker(const MESH& mesh) : mesh_(mesh)
+	{
+		epoch_mark_ = get_epoch_mark_attribute<CELL>(mesh_);
+		mark_attribute_ = epoch_mark_->attribute();
+	}
+
+	~CellEpochMarker()
+	{
+		release_epoch_mark_attribute<CELL>(mesh_, epoch_mark_);
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CellEpochMarker);
+
+	inline void mark(CELL c)
+	{
+		(*mark_attribute_)[index_of(mesh_, c)] = epoch_mark_->epoch();
+	}
+	inline void unmark(CELL c)
+	{
+		(*mark_attribute_)[index_of(mesh_, c)] = 0u;
+	}
+
+	inline bool is_marked(CELL c) const
+	{
+		return (*mark_attribute_)[index_of(mesh_, c)] == epoch_mark_->epoch();
+	}
+
+	inline void unmark_all()
+	{
+		epoch_mark_->next_epoch();
+	}
+};
+
 } // namespace cgogn
 
 #endif // CGOGN_CORE_TYPES_MARKER_H_
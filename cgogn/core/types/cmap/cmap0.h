@@ -59,6 +59,7 @@ struct mesh_traits<CMap0>
 	using Attribute = CMapBase::Attribute<T>;
 	using AttributeGen = CMapBase::AttributeGen;
 	using MarkAttribute = CMapBase::MarkAttribute;
+	using EpochMark = CMapBase::EpochMark;
 };
 
 } // namespace cgogn
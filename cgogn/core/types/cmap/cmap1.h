@@ -68,6 +68,7 @@ struct mesh_traits<CMap1>
 	using Attribute = CMapBase::Attribute<T>;
 	using AttributeGen = CMapBase::AttributeGen;
 	using MarkAttribute = CMapBase::MarkAttribute;
+	using EpochMark = CMapBase::EpochMark;
 };
 
 } // namespace cgogn
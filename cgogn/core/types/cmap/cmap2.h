@@ -71,6 +71,7 @@ struct mesh_traits<CMap2>
 	using Attribute = CMapBase::Attribute<T>;
 	using AttributeGen = CMapBase::AttributeGen;
 	using MarkAttribute = CMapBase::MarkAttribute;
+	using EpochMark = CMapBase::EpochMark;
 };
 
 } // namespace cgogn
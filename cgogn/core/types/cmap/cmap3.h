@@ -77,6 +77,7 @@ struct mesh_traits<CMap3>
 	using Attribute = CMapBase::Attribute<T>;
 	using AttributeGen = CMapBase::AttributeGen;
 	using MarkAttribute = CMapBase::MarkAttribute;
+	using EpochMark = CMapBase::EpochMark;
 };
 
 } // namespace cgogn
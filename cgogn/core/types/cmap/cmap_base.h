@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/types/container/aligned_array.h>
 #include <cgogn/core/types/container/attribute_container.h>
 #include <cgogn/core/types/container/chunk_array.h>
 #include <cgogn/core/types/container/vector.h>
@@ -43,12 +44,18 @@ namespace cgogn
 struct CGOGN_CORE_EXPORT CMapBase
 {
 	// using AttributeContainer = AttributeContainerT<Vector>;
+#ifdef CGOGN_CONTIGUOUS_ATTRIBUTES
+	using AttributeContainer = AttributeContainerT<AlignedArray>;
+#else
 	using AttributeContainer = AttributeContainerT<ChunkArray>;
+#endif
 
 	template <typename T>
 	using Attribute = AttributeContainer::Attribute<T>;
 	using AttributeGen = AttributeContainer::AttributeGen;
 	using MarkAttribute = AttributeContainer::MarkAttribute;
+	using EpochMarkAttribute = AttributeContainer::EpochMarkAttribute;
+	using EpochMark = AttributeContainer::EpochMark;
 
 	/*************************************************************************/
 	// Map-wise attributes container
@@ -39,6 +39,7 @@ struct CPH3
 	using Attribute = CMAP::Attribute<T>;
 	using AttributeGen = CMAP::AttributeGen;
 	using MarkAttribute = CMAP::MarkAttribute;
+	using EpochMark = CMAP::EpochMark;
 
 	using Vertex = Cell<PHI21_PHI31>;
 	using Vertex2 = Cell<PHI21>;
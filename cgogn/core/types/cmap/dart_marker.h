@@ -66,6 +66,38 @@ inline void release_dart_mark_attribute(const CMapBase& m, CMapBase::MarkAttribu
 
 /*****************************************************************************/
 
+// template <typename MESH>
+// typename mesh_traits<MESH>::EpochMark* get_dart_epoch_mark_attribute(const MESH& m);
+
+/*****************************************************************************/
+
+///////////////////////////////
+// CMapBase (or convertible) //
+///////////////////////////////
+
+inline typename CMapBase::EpochMark* get_dart_epoch_mark_attribute(const CMapBase& m)
+{
+	return m.darts_.get_epoch_mark_attribute();
+}
+
+/*****************************************************************************/
+
+// template <typename MESH>
+// void release_dart_epoch_mark_attribute(const MESH& m, typename mesh_traits<MESH>::EpochMark* attribute);
+
+/*****************************************************************************/
+
+///////////////////////////////
+// CMapBase (or convertible) //
+///////////////////////////////
+
+inline void release_dart_epoch_mark_attribute(const CMapBase& m, CMapBase::EpochMark* attribute)
+{
+	return m.darts_.release_epoch_mark_attribute(attribute);
+}
+
+/*****************************************************************************/
+
 template <typename CMAP>
 class CGOGN_CORE_EXPORT DartMarker
 {
@@ -168,6 +200,53 @@ public:
 	}
 };
 
+/**
+ * @brief dart marker whose unmark_all (and destruction) cost does not depend on the size of the map:
+ * marks store the current epoch of a pooled attribute and unmarking everything starts a new epoch.
+ * Prefer it over DartMarker for local traversals on large maps.
+ */
+template <typename CMAP>
+class CGOGN_CORE_EXPORT DartEpochMarker
+{
+private:
+	const CMAP& map_;
+	CMapBase::EpochMark* epoch_mark_;
+	CMapBase::EpochMarkAttribute* mark_attribute_;
+
+public:
+	DartEpochMarker(const CMAP& map) : map_(map)
+	{
+		epoch_mark_ = get_dart_epoch_mark_attribute(map_);
+		mark_attribute_ = epoch_mark_->attribute();
+	}
+
+	~DartEpochMarker()
+	{
+		release_dart_epoch_mark_attribute(map_, epoch_mark_);
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(DartEpochMarker);
+
+	inline void mark(Dart d)
+	{
+		(*mark_attribute_)[d.index] = epoch_mark_->epoch();
+	}
+	inline void unmark(Dart d)
+	{
+		(*mark_attribute_)[d.index] = 0u;
+	}
+
+	inline bool is_marked(Dart d) const
+	{
+		return (*mark_attribute_)[d.index] == epoch_mark_->epoch();
+	}
+
+	inline void unmark_all()
+	{
+		epoch_mark_->next_epoch();
+	}
+};
+
 } // namespace cgogn
 
 #endif // CGOGN_CORE_TYPES_CMAP_DART_MARKER_H_
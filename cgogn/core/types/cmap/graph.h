@@ -71,6 +71,7 @@ struct mesh_traits<Graph>
 	using Attribute = CMapBase::Attribute<T>;
 	using AttributeGen = CMapBase::AttributeGen;
 	using MarkAttribute = CMapBase::MarkAttribute;
+	using EpochMark = CMapBase::EpochMark;
 };
 
 } // namespace cgogn
@@ -0,0 +1,363 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_CONTAINER_ALIGNED_ARRAY_H_
+#define CGOGN_CORE_CONTAINER_ALIGNED_ARRAY_H_
+
+#include <cgogn/core/cgogn_core_export.h>
+
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/span.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/core/types/container/attribute_container.h>
+
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cgogn
+{
+
+//////////////////////
+// AlignedAllocator //
+//////////////////////
+
+template <typename T, std::size_t ALIGNMENT>
+struct AlignedAllocator
+{
+	static_assert(ALIGNMENT >= alignof(T), "Alignment must be at least the natural alignment of T");
+
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = AlignedAllocator<U, ALIGNMENT>;
+	};
+
+	AlignedAllocator() = default;
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, ALIGNMENT>&)
+	{
+	}
+
+	inline T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT)));
+	}
+
+	inline void deallocate(T* p, std::size_t)
+	{
+		::operator delete(p, std::align_val_t(ALIGNMENT));
+	}
+
+	template <typename U>
+	inline bool operator==(const AlignedAllocator<U, ALIGNMENT>&) const
+	{
+		return true;
+	}
+	template <typename U>
+	inline bool operator!=(const AlignedAllocator<U, ALIGNMENT>&) const
+	{
+		return false;
+	}
+};
+
+////////////////////////
+// AlignedArray class //
+////////////////////////
+
+/**
+ * Attribute stored in a single contiguous block aligned on a cache line.
+ * Element access is a plain offset (no chunk lookup) and the whole [0, maximum_index) range
+ * can be accessed as a raw array through span(). Unlike ChunkArray, references to elements
+ * are invalidated when the container grows.
+ */
+template <typename T>
+class CGOGN_CORE_EXPORT AlignedArray : public AttributeGenT
+{
+	using AttributeContainer = AttributeContainerT<AlignedArray>;
+
+public:
+	static const std::size_t ALIGNMENT = 64u;
+
+private:
+	// std::vector<bool> is a packed bitset whose elements are not addressable:
+	// booleans are stored one per byte in a wrapper from which a bool& can be taken
+	struct Bool
+	{
+		bool value_;
+	};
+	static_assert(sizeof(Bool) == sizeof(bool), "Bool wrapper must have the size of a bool");
+
+	using Stored = std::conditional_t<std::is_same_v<T, bool>, Bool, T>;
+
+	std::vector<Stored, AlignedAllocator<Stored, ALIGNMENT>> data_;
+
+	static inline T& element(Stored& s)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			return s.value_;
+		else
+			return s;
+	}
+
+	static inline const T& element(const Stored& s)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			return s.value_;
+		else
+			return s;
+	}
+
+	inline T* data()
+	{
+		return reinterpret_cast<T*>(data_.data());
+	}
+
+	inline const T* data() const
+	{
+		return reinterpret_cast<const T*>(data_.data());
+	}
+
+	inline void manage_index(uint32 index) override
+	{
+		if (index >= uint32(data_.size()))
+			data_.resize(index + 1u);
+	}
+
+	inline uint32 live_size() const
+	{
+		return container_ ? std::min(maximum_index(), uint32(data_.size())) : uint32(data_.size());
+	}
+
+public:
+	AlignedArray(AttributeContainer* container, const std::string& name) : AttributeGenT(container, name)
+	{
+		data_.reserve(1024u);
+	}
+
+	~AlignedArray() override
+	{
+	}
+
+	inline T& operator[](uint32 index)
+	{
+		cgogn_message_assert(index < uint32(data_.size()), "index out of bounds");
+		return element(data_[index]);
+	}
+
+	inline const T& operator[](uint32 index) const
+	{
+		cgogn_message_assert(index < uint32(data_.size()), "index out of bounds");
+		return element(data_[index]);
+	}
+
+	/**
+	 * @brief view over the elements of indices [0, maximum_index)
+	 * Released indices are part of the view: their values are meaningless
+	 */
+	inline Span<T> span()
+	{
+		return Span<T>(data(), live_size());
+	}
+
+	inline Span<const T> span() const
+	{
+		return Span<const T>(data(), live_size());
+	}
+
+	inline void fill(const T& value)
+	{
+		for (Stored& s : data_)
+			element(s) = value;
+	}
+
+	inline void swap(AlignedArray<T>* aa)
+	{
+		if (aa->container_ == this->container_) // only swap from same container
+			data_.swap(aa->data_);
+	}
+
+	inline void copy(AlignedArray<T>* aa)
+	{
+		if (aa->container_ == this->container_) // only copy from same container
+			data_ = aa->data_;
+	}
+
+	inline void clear() override
+	{
+		data_.clear();
+		data_.shrink_to_fit();
+		data_.reserve(1024u);
+	}
+
+	inline void permute(const std::vector<uint32>& new_to_old) override
+	{
+		std::vector<Stored, AlignedAllocator<Stored, ALIGNMENT>> data(data_.size());
+		const uint32 n = uint32(new_to_old.size());
+		// elements beyond the permuted range are kept in place
+		std::copy(data_.begin() + n, data_.end(), data.begin() + n);
+		thread_pool()->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+				data[i] = std::move(data_[new_to_old[i]]);
+		});
+		data_.swap(data);
+	}
+
+	inline void shrink(uint32 size) override
+	{
+		if (size < uint32(data_.size()))
+		{
+			data_.resize(size);
+			data_.shrink_to_fit();
+		}
+	}
+
+	inline std::shared_ptr<AttributeGenT> create_in(AttributeContainerGen& dst) const override
+	{
+		AttributeContainer* dst_container = dynamic_cast<AttributeContainer*>(&dst);
+		if (dst_container)
+		{
+			auto attribute = dst_container->get_attribute<T>(name_);
+			if (!attribute)
+				attribute = dst_container->add_attribute<T>(name_);
+			return attribute;
+		}
+		return nullptr;
+	}
+
+	inline void copy(const AttributeGenT& src) override
+	{
+		const AlignedArray<T>* src_aa = dynamic_cast<const AlignedArray<T>*>(&src);
+		if (src_aa)
+		{
+			cgogn_message_assert(src_aa->data_.size() == data_.size(), "Copy from src with different capacity");
+			data_ = src_aa->data_;
+		}
+	}
+
+	inline const void* data_pointer() const
+	{
+		return data_.data();
+	}
+
+	class const_iterator
+	{
+		const AlignedArray<T>* aa_;
+		uint32 index_;
+
+	public:
+		inline const_iterator(const AlignedArray<T>* aa, uint32 index) : aa_(aa), index_(index)
+		{
+		}
+		inline const_iterator(const const_iterator& it) : aa_(it.aa_), index_(it.index_)
+		{
+		}
+		inline const_iterator& operator=(const const_iterator& it)
+		{
+			aa_ = it.aa_;
+			index_ = it.index_;
+			return *this;
+		}
+		inline bool operator!=(const_iterator it) const
+		{
+			cgogn_assert(aa_ == it.aa_);
+			return index_ != it.index_;
+		}
+		inline const_iterator& operator++()
+		{
+			index_ = aa_->container_->next_index(index_);
+			return *this;
+		}
+		inline const T& operator*() const
+		{
+			return aa_->operator[](index_);
+		}
+		inline uint32 index()
+		{
+			return index_;
+		}
+	};
+	inline const_iterator begin() const
+	{
+		return const_iterator(this, this->container_->first_index());
+	}
+	inline const_iterator end() const
+	{
+		return const_iterator(this, this->container_->last_index());
+	}
+
+	class iterator
+	{
+		AlignedArray<T>* aa_;
+		uint32 index_;
+
+	public:
+		inline iterator(AlignedArray<T>* aa, uint32 index) : aa_(aa), index_(index)
+		{
+		}
+		inline iterator(const iterator& it) : aa_(it.aa_), index_(it.index_)
+		{
+		}
+		inline iterator& operator=(const iterator& it)
+		{
+			aa_ = it.aa_;
+			index_ = it.index_;
+			return *this;
+		}
+		inline bool operator!=(iterator it) const
+		{
+			cgogn_assert(aa_ == it.aa_);
+			return index_ != it.index_;
+		}
+		inline iterator& operator++()
+		{
+			index_ = aa_->container_->next_index(index_);
+			return *this;
+		}
+		inline T& operator*() const
+		{
+			return aa_->operator[](index_);
+		}
+		inline uint32 index()
+		{
+			return index_;
+		}
+	};
+	inline iterator begin()
+	{
+		return iterator(this, this->container_->first_index());
+	}
+	inline iterator end()
+	{
+		return iterator(this, this->container_->last_index());
+	}
+};
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_CONTAINER_ALIGNED_ARRAY_H_
@@ -26,6 +26,8 @@
 #include <cgogn/core/utils/assert.h>
 #include <cgogn/core/utils/thread_pool.h>
 
+#include <algorithm>
+
 namespace cgogn
 {
 
@@ -71,10 +73,14 @@ AttributeContainerGen::AttributeContainerGen() : nb_elements_(0), maximum_index_
 
 	mark_attributes_.resize(max);
 	available_mark_attributes_.resize(max);
+	epoch_mark_attributes_.resize(max);
+	available_epoch_mark_attributes_.resize(max);
 	for (uint32 i = 0; i < max; ++i)
 	{
 		mark_attributes_[i].reserve(32);
 		available_mark_attributes_[i].reserve(32);
+		epoch_mark_attributes_[i].reserve(32);
+		available_epoch_mark_attributes_[i].reserve(32);
 	}
 
 	available_indices_.reserve(1024);
@@ -92,13 +98,16 @@ AttributeContainerGen::~AttributeContainerGen()
 uint32 AttributeContainerGen::new_index()
 {
 	uint32 index;
-	if (uint32(available_indices_.size()) > 0)
 	{
-		index = available_indices_.back();
-		available_indices_.pop_back();
+		std::lock_guard<std::mutex> lock(available_indices_mutex_);
+		if (uint32(available_indices_.size()) > 0)
+		{
+			index = available_indices_.back();
+			available_indices_.pop_back();
+		}
+		else
+			index = maximum_index_++;
 	}
-	else
-		index = maximum_index_++;
 
 	for (AttributeGenT* ag : attributes_)
 		ag->manage_index(index);
@@ -109,6 +118,8 @@ uint32 AttributeContainerGen::new_index()
 		{
 			for (AttributeGenT* ag : mark_attributes_[i])
 				ag->manage_index(index);
+			for (EpochMarkAttributeGen* em : epoch_mark_attributes_[i])
+				em->attribute_->manage_index(index);
 		}
 		init_mark_attributes(index);
 	}
@@ -119,11 +130,53 @@ uint32 AttributeContainerGen::new_index()
 	return index;
 }
 
+void AttributeContainerGen::new_indices(uint32 nb, uint32* indices)
+{
+	if (nb == 0u)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(available_indices_mutex_);
+		uint32 i = 0u;
+		for (; i < nb && uint32(available_indices_.size()) > 0; ++i)
+		{
+			indices[i] = available_indices_.back();
+			available_indices_.pop_back();
+		}
+		for (; i < nb; ++i)
+			indices[i] = maximum_index_++;
+	}
+
+	// the storage of the attributes only has to be extended once, up to the largest index
+	const uint32 max_index = *std::max_element(indices, indices + nb);
+	for (AttributeGenT* ag : attributes_)
+		ag->manage_index(max_index);
+
+	{
+		std::lock_guard<std::mutex> lock(mark_attributes_mutex_);
+		for (uint32 i = 0, nb_threads = uint32(mark_attributes_.size()); i < nb_threads; ++i)
+		{
+			for (AttributeGenT* ag : mark_attributes_[i])
+				ag->manage_index(max_index);
+			for (EpochMarkAttributeGen* em : epoch_mark_attributes_[i])
+				em->attribute_->manage_index(max_index);
+		}
+		for (uint32 i = 0u; i < nb; ++i)
+			init_mark_attributes(indices[i]);
+	}
+
+	for (uint32 i = 0u; i < nb; ++i)
+		init_ref_counter(indices[i]);
+
+	nb_elements_ += nb;
+}
+
 void AttributeContainerGen::release_index(uint32 index)
 {
 	cgogn_message_assert(nb_refs(index) > 0, "Trying to release an unused index");
-	available_indices_.push_back(index);
 	reset_ref_counter(index);
+	std::lock_guard<std::mutex> lock(available_indices_mutex_);
+	available_indices_.push_back(index);
 	--nb_elements_;
 }
 
@@ -156,6 +209,8 @@ void AttributeContainerGen::clear_attributes()
 	{
 		for (AttributeGenT* mark_attribute : mark_attributes_[i])
 			mark_attribute->clear();
+		for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+			epoch_mark_attribute->attribute_->clear();
 	}
 	available_indices_.clear();
 	nb_elements_ = 0;
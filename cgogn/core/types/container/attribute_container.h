@@ -72,6 +72,10 @@ private:
 	virtual void clear() = 0;
 	virtual std::shared_ptr<AttributeGenT> create_in(AttributeContainerGen& container) const = 0;
 	virtual void copy(const AttributeGenT& src) = 0;
+	// the element at index i becomes the element previously at index new_to_old[i], for i in [0, new_to_old.size())
+	virtual void permute(const std::vector<uint32>& new_to_old) = 0;
+	// release the storage of the elements of indices >= size
+	virtual void shrink(uint32 size) = 0;
 };
 
 /////////////////////////////////
@@ -93,7 +97,15 @@ public:
 		return maximum_index_;
 	}
 
+	// ratio of released indices in [0, maximum_index): traversals still walk them
+	inline float64 fragmentation() const
+	{
+		return maximum_index_ > 0u ? 1.0 - float64(nb_elements_) / float64(maximum_index_) : 0.0;
+	}
+
 	uint32 new_index();
+	// get nb new indices at once (written in indices)
+	void new_indices(uint32 nb, uint32* indices);
 	void release_index(uint32 index);
 
 	void remove_attribute(const std::shared_ptr<AttributeGenT>& attribute);
@@ -144,6 +156,18 @@ protected:
 	std::vector<std::vector<AttributeGenT*>> mark_attributes_;
 	std::vector<std::vector<uint32>> available_mark_attributes_;
 
+	// epoch mark attributes: an element is marked iff its value equals the current epoch of the attribute
+	// (unmarking everything only increments the epoch, a full reset is done when the epoch wraps around)
+	struct EpochMarkAttributeGen
+	{
+		AttributeGenT* attribute_;
+		uint16 epoch_;
+	};
+	std::vector<std::vector<EpochMarkAttributeGen*>> epoch_mark_attributes_;
+	std::vector<std::vector<uint32>> available_epoch_mark_attributes_;
+
+	// protects available_indices_ so that disjoint parts of a mesh can be removed concurrently
+	std::mutex available_indices_mutex_;
 	std::vector<uint32> available_indices_;
 
 	uint32 nb_elements_;
@@ -171,6 +195,28 @@ public:
 	using Attribute = AttributeT<T>;
 	using AttributeGen = AttributeGenT;
 	using MarkAttribute = Attribute<uint8>;
+	using EpochMarkAttribute = Attribute<uint16>;
+
+	struct EpochMark : public EpochMarkAttributeGen
+	{
+		inline EpochMarkAttribute* attribute() const
+		{
+			return static_cast<EpochMarkAttribute*>(this->attribute_);
+		}
+		inline uint16 epoch() const
+		{
+			return this->epoch_;
+		}
+		// start a new epoch: every element becomes unmarked
+		inline void next_epoch()
+		{
+			if (++this->epoch_ == 0u)
+			{
+				attribute()->fill(0u);
+				this->epoch_ = 1u;
+			}
+		}
+	};
 
 protected:
 	std::unique_ptr<Attribute<uint32>> ref_counter_;
@@ -201,6 +247,11 @@ protected:
 				MarkAttribute* m = static_cast<MarkAttribute*>(mark_attribute);
 				(*m)[index] = 0u;
 			}
+			for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+			{
+				EpochMarkAttribute* m = static_cast<EpochMarkAttribute*>(epoch_mark_attribute->attribute_);
+				(*m)[index] = 0u;
+			}
 		}
 	}
 
@@ -212,6 +263,14 @@ public:
 
 	~AttributeContainerT()
 	{
+		for (uint32 i = 0, nb = uint32(epoch_mark_attributes_.size()); i < nb; ++i)
+		{
+			for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+			{
+				delete epoch_mark_attribute->attribute_;
+				delete static_cast<EpochMark*>(epoch_mark_attribute);
+			}
+		}
 	}
 
 	void copy(const AttributeContainerT<AttributeT>& src)
@@ -237,6 +296,12 @@ public:
 			{
 				for (AttributeGenT* mark_attribute : mark_attributes_[i])
 					mark_attribute->manage_index(maximum_index_);
+				for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+				{
+					EpochMark* em = static_cast<EpochMark*>(epoch_mark_attribute);
+					static_cast<AttributeGenT*>(em->attribute())->manage_index(maximum_index_);
+					em->attribute()->fill(0u);
+				}
 			}
 		}
 
@@ -305,6 +370,175 @@ public:
 			int32(std::distance(mark_attributes_[thread_index].begin(), it)));
 	}
 
+	EpochMark* get_epoch_mark_attribute()
+	{
+		uint32 thread_index = current_thread_index();
+		EpochMark* em;
+		if (available_epoch_mark_attributes_[thread_index].size() > 0)
+		{
+			uint32 index = available_epoch_mark_attributes_[thread_index].back();
+			available_epoch_mark_attributes_[thread_index].pop_back();
+			em = static_cast<EpochMark*>(epoch_mark_attributes_[thread_index][index]);
+		}
+		else
+		{
+			em = new EpochMark();
+			EpochMarkAttribute* ap = new EpochMarkAttribute(nullptr, "__epoch_mark");
+			// AttributeContainerT is friend of AttributeGenT
+			static_cast<AttributeGenT*>(ap)->manage_index(maximum_index_);
+			ap->fill(0u);
+			em->attribute_ = ap;
+			em->epoch_ = 0u;
+			epoch_mark_attributes_[thread_index].push_back(em);
+		}
+		em->next_epoch();
+		return em;
+	}
+
+	void release_epoch_mark_attribute(EpochMark* em)
+	{
+		uint32 thread_index = current_thread_index();
+		auto it = std::find(epoch_mark_attributes_[thread_index].begin(), epoch_mark_attributes_[thread_index].end(),
+							static_cast<EpochMarkAttributeGen*>(em));
+		cgogn_message_assert(it != epoch_mark_attributes_[thread_index].end(),
+							 "Epoch Mark Attribute not found on release");
+		available_epoch_mark_attributes_[thread_index].push_back(
+			uint32(std::distance(epoch_mark_attributes_[thread_index].begin(), it)));
+	}
+
+	/**
+	 * @brief renumber the elements of the container: the element at index i becomes the element
+	 * previously at index new_to_old[i]. new_to_old must be a permutation of [0, maximum_index).
+	 * All attributes (including mark attributes and reference counters) are permuted and
+	 * released indices follow their elements.
+	 */
+	void permute(const std::vector<uint32>& new_to_old)
+	{
+		cgogn_message_assert(uint32(new_to_old.size()) == maximum_index_, "permutation size differs from maximum_index");
+
+		for (AttributeGenT* ag : attributes_)
+			ag->permute(new_to_old);
+		for (uint32 i = 0, nb = uint32(mark_attributes_.size()); i < nb; ++i)
+		{
+			for (AttributeGenT* mark_attribute : mark_attributes_[i])
+				mark_attribute->permute(new_to_old);
+			for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+				epoch_mark_attribute->attribute_->permute(new_to_old);
+		}
+		static_cast<AttributeGenT*>(ref_counter_.get())->permute(new_to_old);
+
+		// released indices are given back in increasing order
+		available_indices_.clear();
+		for (uint32 i = maximum_index_; i > 0u; --i)
+		{
+			if (nb_refs(i - 1u) == 0u)
+				available_indices_.push_back(i - 1u);
+		}
+	}
+
+	/**
+	 * @brief squeeze out the released indices: live elements keep their relative order and are moved
+	 * to [0, nb_elements), the storage beyond is released.
+	 * @return the new index of each former index (INVALID_INDEX for released ones),
+	 * or an empty vector if the container was not fragmented
+	 */
+	std::vector<uint32> compact()
+	{
+		if (nb_elements_ == maximum_index_)
+			return {};
+
+		std::vector<uint32> new_to_old;
+		new_to_old.reserve(maximum_index_);
+		std::vector<uint32> old_to_new(maximum_index_, INVALID_INDEX);
+		for (uint32 i = 0u; i < maximum_index_; ++i)
+		{
+			if (nb_refs(i) > 0u)
+			{
+				old_to_new[i] = uint32(new_to_old.size());
+				new_to_old.push_back(i);
+			}
+		}
+		for (uint32 i = 0u; i < maximum_index_; ++i)
+		{
+			if (nb_refs(i) == 0u)
+				new_to_old.push_back(i);
+		}
+		permute(new_to_old);
+
+		maximum_index_ = nb_elements_;
+		available_indices_.clear();
+		for (AttributeGenT* ag : attributes_)
+			ag->shrink(maximum_index_);
+		for (uint32 i = 0, nb = uint32(mark_attributes_.size()); i < nb; ++i)
+		{
+			for (AttributeGenT* mark_attribute : mark_attributes_[i])
+				mark_attribute->shrink(maximum_index_);
+			for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+				epoch_mark_attribute->attribute_->shrink(maximum_index_);
+		}
+		static_cast<AttributeGenT*>(ref_counter_.get())->shrink(maximum_index_);
+
+		return old_to_new;
+	}
+
+	// reference counters of the indices [0, maximum_index) (0 for released indices)
+	std::vector<uint32> ref_counters() const
+	{
+		std::vector<uint32> result(maximum_index_);
+		for (uint32 i = 0u; i < maximum_index_; ++i)
+			result[i] = nb_refs(i);
+		return result;
+	}
+
+	/**
+	 * @brief set the indexing state of the container from the reference counters of [0, maximum_index)
+	 * (e.g. when loading a saved container): attributes are sized accordingly but their values are left to the
+	 * caller, mark attributes are reset
+	 */
+	void restore(const std::vector<uint32>& ref_counters)
+	{
+		clear_attributes();
+
+		const uint32 nb = uint32(ref_counters.size());
+		AttributeGenT* ref_counter = ref_counter_.get();
+		ref_counter->clear();
+		if (nb > 0u)
+		{
+			for (AttributeGenT* ag : attributes_)
+				ag->manage_index(nb - 1u);
+			for (uint32 i = 0, nb_threads = uint32(mark_attributes_.size()); i < nb_threads; ++i)
+			{
+				for (AttributeGenT* mark_attribute : mark_attributes_[i])
+				{
+					mark_attribute->manage_index(nb - 1u);
+					static_cast<MarkAttribute*>(mark_attribute)->fill(0u);
+				}
+				for (EpochMarkAttributeGen* epoch_mark_attribute : epoch_mark_attributes_[i])
+				{
+					EpochMark* em = static_cast<EpochMark*>(epoch_mark_attribute);
+					static_cast<AttributeGenT*>(em->attribute())->manage_index(nb - 1u);
+					em->attribute()->fill(0u);
+				}
+			}
+			ref_counter->manage_index(nb - 1u);
+		}
+
+		maximum_index_ = nb;
+		nb_elements_ = 0u;
+		for (uint32 i = 0u; i < nb; ++i)
+		{
+			(*ref_counter_)[i] = ref_counters[i];
+			if (ref_counters[i] > 0u)
+				++nb_elements_;
+		}
+		// released indices are given back in increasing order
+		for (uint32 i = nb; i > 0u; --i)
+		{
+			if (ref_counters[i - 1u] == 0u)
+				available_indices_.push_back(i - 1u);
+		}
+	}
+
 	inline void ref_index(uint32 index)
 	{
 		cgogn_message_assert(nb_refs(index) > 0, "Trying to ref an unused index");
@@ -27,6 +27,7 @@
 #include <cgogn/core/cgogn_core_export.h>
 
 #include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/core/types/container/attribute_container.h>
 
@@ -114,6 +115,39 @@ public:
 		capacity_ = 0;
 	}
 
+	inline void permute(const std::vector<uint32>& new_to_old) override
+	{
+		std::vector<T*> chunks(chunks_.size());
+		for (uint32 i = 0; i < uint32(chunks.size()); ++i)
+		{
+			chunks[i] = new T[CHUNK_SIZE]();
+			// elements beyond the permuted range are kept in place
+			if ((i + 1u) * CHUNK_SIZE > uint32(new_to_old.size()))
+				std::copy(chunks_[i], chunks_[i] + CHUNK_SIZE, chunks[i]);
+		}
+		thread_pool()->parallel_for(0u, uint32(new_to_old.size()), CHUNK_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				const uint32 j = new_to_old[i];
+				chunks[i / CHUNK_SIZE][i % CHUNK_SIZE] = std::move(chunks_[j / CHUNK_SIZE][j % CHUNK_SIZE]);
+			}
+		});
+		for (auto chunk : chunks_)
+			delete[] chunk;
+		chunks_.swap(chunks);
+	}
+
+	inline void shrink(uint32 size) override
+	{
+		const uint32 nb_chunks = (size + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+		while (uint32(chunks_.size()) > nb_chunks)
+		{
+			delete[] chunks_.back();
+			chunks_.pop_back();
+		}
+		capacity_ = uint32(chunks_.size()) * CHUNK_SIZE;
+	}
+
 	inline std::shared_ptr<AttributeGenT> create_in(AttributeContainerGen& dst) const override
 	{
 		AttributeContainer* dst_container = dynamic_cast<AttributeContainer*>(&dst);
@@ -27,6 +27,8 @@
 #include <cgogn/core/cgogn_core_export.h>
 
 #include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/span.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/core/types/container/attribute_container.h>
 
@@ -77,6 +79,21 @@ public:
 		return data_[index];
 	}
 
+	/**
+	 * @brief view over the elements of indices [0, maximum_index)
+	 * Released indices are part of the view: their values are meaningless
+	 */
+	inline Span<T> span()
+	{
+		return Span<T>(data_.data(), container_ ? std::min(maximum_index(), uint32(data_.size())) : uint32(data_.size()));
+	}
+
+	inline Span<const T> span() const
+	{
+		return Span<const T>(data_.data(),
+							 container_ ? std::min(maximum_index(), uint32(data_.size())) : uint32(data_.size()));
+	}
+
 	inline void fill(const T& value)
 	{
 		std::fill(data_.begin(), data_.end(), value);
@@ -101,6 +118,37 @@ public:
 		data_.shrink_to_fit();
 	}
 
+	inline void permute(const std::vector<uint32>& new_to_old) override
+	{
+		std::vector<T> data(data_.size());
+		const uint32 n = uint32(new_to_old.size());
+		// elements beyond the permuted range are kept in place
+		std::copy(data_.begin() + n, data_.end(), data.begin() + n);
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			// std::vector<bool> elements cannot be written concurrently
+			for (uint32 i = 0; i < n; ++i)
+				data[i] = data_[new_to_old[i]];
+		}
+		else
+		{
+			thread_pool()->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 i = b; i < e; ++i)
+					data[i] = std::move(data_[new_to_old[i]]);
+			});
+		}
+		data_.swap(data);
+	}
+
+	inline void shrink(uint32 size) override
+	{
+		if (size < uint32(data_.size()))
+		{
+			data_.resize(size);
+			data_.shrink_to_fit();
+		}
+	}
+
 	inline std::shared_ptr<AttributeGenT> create_in(AttributeContainerGen& dst) const override
 	{
 		AttributeContainer* dst_container = dynamic_cast<AttributeContainer*>(&dst);
@@ -26,6 +26,7 @@
 
 #include <cgogn/core/cgogn_core_export.h>
 
+#include <cgogn/core/types/container/aligned_array.h>
 #include <cgogn/core/types/container/attribute_container.h>
 #include <cgogn/core/types/container/chunk_array.h>
 #include <cgogn/core/types/container/vector.h>
@@ -40,12 +41,18 @@ namespace cgogn
 struct CGOGN_CORE_EXPORT IncidenceGraph
 {
 	// using AttributeContainer = AttributeContainerT<Vector>;
+#ifdef CGOGN_CONTIGUOUS_ATTRIBUTES
+	using AttributeContainer = AttributeContainerT<AlignedArray>;
+#else
 	using AttributeContainer = AttributeContainerT<ChunkArray>;
+#endif
 
 	template <typename T>
 	using Attribute = AttributeContainer::Attribute<T>;
 	using AttributeGen = AttributeContainer::AttributeGen;
 	using MarkAttribute = AttributeContainer::MarkAttribute;
+	using EpochMark = AttributeContainer::EpochMark;
+	using EpochMarkAttribute = AttributeContainer::EpochMarkAttribute;
 
 	/*************************************************************************/
 	// Graph attributes container
@@ -163,6 +170,7 @@ struct mesh_traits<IncidenceGraph>
 	using Attribute = IncidenceGraph::Attribute<T>;
 	using AttributeGen = IncidenceGraph::AttributeGen;
 	using MarkAttribute = IncidenceGraph::MarkAttribute;
+	using EpochMark = IncidenceGraph::EpochMark;
 };
 
 } // namespace cgogn
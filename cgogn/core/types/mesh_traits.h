@@ -53,6 +53,7 @@ struct mesh_traits
 	// using Attribute;
 	// using AttributeGen;
 	// using MarkAttribute;
+	// using EpochMark;
 };
 
 template <typename MESH>
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_UTILS_RADIX_SORT_H_
+#define CGOGN_CORE_UTILS_RADIX_SORT_H_
+
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <array>
+#include <vector>
+
+namespace cgogn
+{
+
+/**
+ * @brief number of bits needed to represent the given value
+ */
+inline uint32 nb_bits(uint64 value)
+{
+	uint32 n = 0u;
+	while (value != 0u)
+	{
+		++n;
+		value >>= 1u;
+	}
+	return n;
+}
+
+/**
+ * @brief stable parallel LSD radix sort of (key, value) pairs
+ * The input is split into one part per worker: each pass builds the per-part histograms of the current digit,
+ * computes the scatter offsets and scatters the parts concurrently.
+ * @param keys the keys to sort
+ * @param values the values associated to the keys (permuted along with them)
+ * @param key_bits only the key_bits lowest bits of the keys are considered
+ */
+template <typename T>
+void radix_sort(std::vector<uint64>& keys, std::vector<T>& values, uint32 key_bits = 64u)
+{
+	static const uint32 RADIX_BITS = 11u;
+	static const uint32 NB_BUCKETS = 1u << RADIX_BITS;
+
+	cgogn_message_assert(keys.size() == values.size(), "radix_sort: keys and values sizes differ");
+
+	const uint32 n = uint32(keys.size());
+	if (n < 2u || key_bits == 0u)
+		return;
+
+	ThreadPool* pool = thread_pool();
+	const uint32 nb_parts = std::max(1u, std::min(pool->nb_workers(), n / NB_BUCKETS));
+	const uint32 part_size = (n + nb_parts - 1u) / nb_parts;
+
+	std::vector<uint64> tmp_keys(n);
+	std::vector<T> tmp_values(n);
+	std::vector<std::array<uint32, NB_BUCKETS>> offsets(nb_parts);
+
+	for (uint32 shift = 0u; shift < key_bits; shift += RADIX_BITS)
+	{
+		const uint64 mask = NB_BUCKETS - 1u;
+
+		pool->parallel_for(0u, nb_parts, 1u, [&](uint32 b, uint32 e) {
+			for (uint32 p = b; p < e; ++p)
+			{
+				std::array<uint32, NB_BUCKETS>& histogram = offsets[p];
+				histogram.fill(0u);
+				for (uint32 i = p * part_size, end = std::min(n, (p + 1u) * part_size); i < end; ++i)
+					++histogram[(keys[i] >> shift) & mask];
+			}
+		});
+
+		// bucket-major then part-major offsets keep the sort stable
+		uint32 sum = 0u;
+		for (uint32 bucket = 0u; bucket < NB_BUCKETS; ++bucket)
+		{
+			for (uint32 p = 0u; p < nb_parts; ++p)
+			{
+				uint32 count = offsets[p][bucket];
+				offsets[p][bucket] = sum;
+				sum += count;
+			}
+		}
+
+		pool->parallel_for(0u, nb_parts, 1u, [&](uint32 b, uint32 e) {
+			for (uint32 p = b; p < e; ++p)
+			{
+				std::array<uint32, NB_BUCKETS>& offset = offsets[p];
+				for (uint32 i = p * part_size, end = std::min(n, (p + 1u) * part_size); i < end; ++i)
+				{
+					uint32 pos = offset[(keys[i] >> shift) & mask]++;
+					tmp_keys[pos] = keys[i];
+					tmp_values[pos] = values[i];
+				}
+			}
+		});
+
+		keys.swap(tmp_keys);
+		values.swap(tmp_values);
+	}
+}
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_UTILS_RADIX_SORT_H_
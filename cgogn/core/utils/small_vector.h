@@ -0,0 +1,251 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_UTILS_SMALL_VECTOR_H_
+#define CGOGN_CORE_UTILS_SMALL_VECTOR_H_
+
+#include <cgogn/core/utils/numerics.h>
+
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace cgogn
+{
+
+/**
+ * @brief vector of trivially destructible elements (e.g. cells) that stores up to N elements inline
+ * and only allocates on the heap beyond that
+ */
+template <typename T, uint32 N>
+class SmallVector
+{
+	static_assert(std::is_trivially_destructible_v<T>, "SmallVector elements should be trivially destructible");
+	static_assert(N > 0u, "SmallVector inline capacity should not be null");
+
+	alignas(T) unsigned char storage_[N * sizeof(T)];
+	T* data_;
+	uint32 size_;
+	uint32 capacity_;
+
+	inline T* inline_data()
+	{
+		return reinterpret_cast<T*>(storage_);
+	}
+	inline bool is_inline() const
+	{
+		return data_ == reinterpret_cast<const T*>(storage_);
+	}
+
+	static inline void copy_elements(T* dst, const T* src, uint32 nb)
+	{
+		for (uint32 i = 0u; i < nb; ++i)
+			new (dst + i) T(src[i]);
+	}
+
+	void grow(uint32 capacity)
+	{
+		T* data = static_cast<T*>(::operator new(std::size_t(capacity) * sizeof(T)));
+		copy_elements(data, data_, size_);
+		if (!is_inline())
+			::operator delete(data_);
+		data_ = data;
+		capacity_ = capacity;
+	}
+
+public:
+	using value_type = T;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	inline SmallVector() : data_(inline_data()), size_(0u), capacity_(N)
+	{
+	}
+	inline SmallVector(std::initializer_list<T> l) : SmallVector()
+	{
+		reserve(uint32(l.size()));
+		for (const T& x : l)
+			push_back(x);
+	}
+	inline SmallVector(const SmallVector& v) : SmallVector()
+	{
+		*this = v;
+	}
+	inline SmallVector(SmallVector&& v) noexcept : SmallVector()
+	{
+		*this = std::move(v);
+	}
+	inline ~SmallVector()
+	{
+		if (!is_inline())
+			::operator delete(data_);
+	}
+
+	inline SmallVector& operator=(const SmallVector& v)
+	{
+		if (this != &v)
+		{
+			size_ = 0u;
+			reserve(v.size_);
+			copy_elements(data_, v.data_, v.size_);
+			size_ = v.size_;
+		}
+		return *this;
+	}
+	inline SmallVector& operator=(SmallVector&& v) noexcept
+	{
+		if (this != &v)
+		{
+			if (v.is_inline())
+			{
+				// v has at most N elements: they fit in the current storage
+				copy_elements(data_, v.data_, v.size_);
+				size_ = v.size_;
+			}
+			else
+			{
+				if (!is_inline())
+					::operator delete(data_);
+				data_ = v.data_;
+				size_ = v.size_;
+				capacity_ = v.capacity_;
+				v.data_ = v.inline_data();
+				v.capacity_ = N;
+			}
+			v.size_ = 0u;
+		}
+		return *this;
+	}
+
+	// allows the result of the incident_* / adjacent_* functions to initialize a std::vector
+	inline operator std::vector<T>() const
+	{
+		return std::vector<T>(begin(), end());
+	}
+
+	inline uint32 size() const
+	{
+		return size_;
+	}
+	inline uint32 capacity() const
+	{
+		return capacity_;
+	}
+	inline bool empty() const
+	{
+		return size_ == 0u;
+	}
+
+	inline void reserve(uint32 capacity)
+	{
+		if (capacity > capacity_)
+			grow(capacity);
+	}
+	inline void clear()
+	{
+		size_ = 0u;
+	}
+
+	inline void push_back(const T& x)
+	{
+		if (size_ == capacity_)
+		{
+			T copy = x; // x may be an element of this vector
+			grow(2u * capacity_);
+			new (data_ + size_++) T(copy);
+		}
+		else
+			new (data_ + size_++) T(x);
+	}
+	template <typename... Args>
+	inline T& emplace_back(Args&&... args)
+	{
+		if (size_ == capacity_)
+			grow(2u * capacity_);
+		return *new (data_ + size_++) T(std::forward<Args>(args)...);
+	}
+	inline void pop_back()
+	{
+		--size_;
+	}
+
+	inline T& operator[](uint32 i)
+	{
+		return data_[i];
+	}
+	inline const T& operator[](uint32 i) const
+	{
+		return data_[i];
+	}
+	inline T& front()
+	{
+		return data_[0];
+	}
+	inline const T& front() const
+	{
+		return data_[0];
+	}
+	inline T& back()
+	{
+		return data_[size_ - 1u];
+	}
+	inline const T& back() const
+	{
+		return data_[size_ - 1u];
+	}
+
+	inline T* data()
+	{
+		return data_;
+	}
+	inline const T* data() const
+	{
+		return data_;
+	}
+
+	inline iterator begin()
+	{
+		return data_;
+	}
+	inline iterator end()
+	{
+		return data_ + size_;
+	}
+	inline const_iterator begin() const
+	{
+		return data_;
+	}
+	inline const_iterator end() const
+	{
+		return data_ + size_;
+	}
+};
+
+// container returned by the incident_* / adjacent_* traversal functions
+template <typename CELL>
+using CellVector = SmallVector<CELL, 16u>;
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_UTILS_SMALL_VECTOR_H_
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_UTILS_SPAN_H_
+#define CGOGN_CORE_UTILS_SPAN_H_
+
+#include <cgogn/core/utils/numerics.h>
+
+namespace cgogn
+{
+
+/**
+ * @brief non-owning view over a contiguous sequence of T (subset of C++20 std::span)
+ */
+template <typename T>
+class Span
+{
+	T* data_;
+	uint32 size_;
+
+public:
+	using value_type = std::remove_cv_t<T>;
+	using iterator = T*;
+
+	inline Span() : data_(nullptr), size_(0u)
+	{
+	}
+	inline Span(T* data, uint32 size) : data_(data), size_(size)
+	{
+	}
+	template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+	inline Span(const Span<U>& s) : data_(s.data()), size_(s.size())
+	{
+	}
+
+	inline T* data() const
+	{
+		return data_;
+	}
+	inline uint32 size() const
+	{
+		return size_;
+	}
+	inline bool empty() const
+	{
+		return size_ == 0u;
+	}
+
+	inline T& operator[](uint32 index) const
+	{
+		cgogn_message_assert(index < size_, "index out of bounds");
+		return data_[index];
+	}
+
+	inline iterator begin() const
+	{
+		return data_;
+	}
+	inline iterator end() const
+	{
+		return data_ + size_;
+	}
+
+	inline Span<T> subspan(uint32 offset, uint32 count) const
+	{
+		cgogn_message_assert(offset + count <= size_, "subspan out of bounds");
+		return Span<T>(data_ + offset, count);
+	}
+};
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_UTILS_SPAN_H_
@@ -27,47 +27,42 @@
 namespace cgogn
 {
 
-ThreadPool::ThreadPool() : stop_(false)
+// index of the queue of the calling thread if it is a worker of a pool
+static CGOGN_TLS ThreadPool* worker_pool_ = nullptr;
+static CGOGN_TLS uint32 worker_queue_ = 0u;
+
+ThreadPool::ThreadPool() : nb_pending_tasks_(0u), next_queue_(0u), stop_(false)
 {
 	nb_working_workers_ = std::thread::hardware_concurrency() - 1;
 
+	for (uint32 i = 0u; i < nb_working_workers_; ++i)
+		queues_.push_back(std::make_unique<WorkerQueue>());
+
 	for (uint32 i = 0u; i < nb_working_workers_; ++i)
 	{
 		workers_.emplace_back([this, i]() -> void {
 			thread_start(i + 1);
+			worker_pool_ = this;
+			worker_queue_ = i;
 			for (;;)
 			{
-				while (i >= nb_working_workers_)
+				Task task;
+				if (i < nb_working_workers_ && pop_task(i, task))
 				{
-					std::unique_lock<std::mutex> lock(running_mutex_);
-					condition_running_.wait(lock);
+					task();
+					continue;
 				}
 
 				std::unique_lock<std::mutex> lock(queue_mutex_);
-				condition_task_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+				condition_task_.wait(lock, [this, i]() {
+					return stop_ || (i < nb_working_workers_ && nb_pending_tasks_.load() > 0u);
+				});
 
-				if (stop_ && tasks_.empty())
+				if (stop_ && nb_pending_tasks_.load() == 0u)
 				{
 					thread_stop();
 					return;
 				}
-
-				if (i < nb_working_workers_)
-				{
-					PackagedTask task = std::move(tasks_.front());
-					tasks_.pop();
-					lock.unlock();
-#if defined(_MSC_VER) && _MSC_VER < 1900
-					(*task)();
-#else
-					task();
-#endif
-				}
-				else
-				{
-					lock.unlock();
-					condition_task_.notify_one();
-				}
 			}
 		});
 	}
@@ -78,7 +73,6 @@ ThreadPool::ThreadPool() : stop_(false)
 ThreadPool::~ThreadPool()
 {
 	nb_working_workers_ = uint32(workers_.size());
-	condition_running_.notify_all();
 
 	{
 		std::unique_lock<std::mutex> lock(queue_mutex_);
@@ -86,7 +80,6 @@ ThreadPool::~ThreadPool()
 	}
 
 #if !(defined(CGOGN_WIN_VER) && (CGOGN_WIN_VER <= 61))
-	condition_running_.notify_all();
 	condition_task_.notify_all();
 #endif
 
@@ -94,6 +87,98 @@ ThreadPool::~ThreadPool()
 		worker.join();
 }
 
+void ThreadPool::push_task(Task&& task)
+{
+	// without workers, tasks are executed by the calling thread
+	if (queues_.empty())
+	{
+		task();
+		return;
+	}
+
+	uint32 q;
+	if (worker_pool_ == this)
+		q = worker_queue_;
+	else
+		q = next_queue_++ % std::max(1u, std::min(nb_working_workers_, uint32(queues_.size())));
+
+	{
+		std::lock_guard<std::mutex> lock(queues_[q]->mutex_);
+		queues_[q]->tasks_.push_back(std::move(task));
+	}
+	++nb_pending_tasks_;
+
+	{
+		std::unique_lock<std::mutex> lock(queue_mutex_);
+		// don't allow enqueueing after stopping the pool
+		if (stop_)
+		{
+			std::cout << "ThreadPool::enqueue : Enqueue on stopped ThreadPool." << std::endl;
+			cgogn_assert_not_reached("Enqueue on stopped ThreadPool");
+		}
+	}
+
+	// Notify a thread that there is new work to perform
+	condition_task_.notify_one();
+}
+
+bool ThreadPool::pop_task(uint32 worker, Task& task)
+{
+	const uint32 nb_queues = uint32(queues_.size());
+	// own deque: LIFO
+	{
+		WorkerQueue& q = *queues_[worker];
+		std::lock_guard<std::mutex> lock(q.mutex_);
+		if (!q.tasks_.empty())
+		{
+			task = std::move(q.tasks_.back());
+			q.tasks_.pop_back();
+			--nb_pending_tasks_;
+			return true;
+		}
+	}
+	// steal: FIFO (oldest tasks are the largest ranges)
+	for (uint32 k = 1u; k < nb_queues; ++k)
+	{
+		WorkerQueue& q = *queues_[(worker + k) % nb_queues];
+		std::unique_lock<std::mutex> lock(q.mutex_, std::try_to_lock);
+		if (lock.owns_lock() && !q.tasks_.empty())
+		{
+			task = std::move(q.tasks_.front());
+			q.tasks_.pop_front();
+			--nb_pending_tasks_;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::wait(JobBase& job)
+{
+	if (worker_pool_ == this)
+	{
+		// a worker cannot block: it helps until the job is done
+		for (;;)
+		{
+			{
+				std::lock_guard<std::mutex> lock(job.mutex_);
+				if (job.done_)
+					return;
+			}
+			Task task;
+			if (pop_task(worker_queue_, task))
+				task();
+			else
+				std::this_thread::yield();
+		}
+	}
+	else
+	{
+		std::unique_lock<std::mutex> lock(job.mutex_);
+		job.condition_done_.wait(lock, [&job]() { return job.done_; });
+	}
+}
+
 void ThreadPool::set_nb_workers(uint32 nb)
 {
 	if (nb == 0xffffffff)
@@ -101,7 +186,10 @@ void ThreadPool::set_nb_workers(uint32 nb)
 	else
 		nb_working_workers_ = std::min(uint32(workers_.size()), nb);
 
-	condition_running_.notify_all();
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+	}
+	condition_task_.notify_all();
 
 	std::cout << "ThreadPool now using " << nb_working_workers_ << " workers" << std::endl;
 }
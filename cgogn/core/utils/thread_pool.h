@@ -61,13 +61,15 @@
 #include <cgogn/core/utils/definitions.h>
 #include <cgogn/core/utils/numerics.h>
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
@@ -110,11 +112,7 @@ public:
 	~ThreadPool();
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ThreadPool);
 
-#if defined(_MSC_VER) && _MSC_VER < 1900
-	using PackagedTask = std::shared_ptr<std::packaged_task<void()>>; // avoiding a MSVC 2013 Bug
-#else
-	using PackagedTask = std::packaged_task<void()>;
-#endif
+	using Task = std::function<void()>;
 
 	template <class F, class... Args>
 	std::future<void> enqueue(const F& f, Args&&... args)
@@ -123,30 +121,46 @@ public:
 		static_assert(std::is_same<typename std::result_of<F(Args...)>::type, void>::value,
 					  "The thread pool only accepts non-returning functions.");
 
-#if defined(_MSC_VER) && _MSC_VER < 1900
-		PackagedTask task = std::make_shared<std::packaged_task<void()>>(std::bind(f, std::forward<Args>(args)...));
+		auto task = std::make_shared<std::packaged_task<void()>>([&, f]() -> void { f(std::forward<Args>(args)...); });
 		std::future<void> res = task->get_future();
-#else
-		PackagedTask task([&, f]() -> void { f(std::forward<Args>(args)...); });
-		std::future<void> res = task.get_future();
-#endif
 
+		push_task([task]() { (*task)(); });
+
+		return res;
+	}
+
+	/**
+	 * @brief apply f on sub-ranges of [begin, end) using the work-stealing workers
+	 * The range is recursively split in halves: a worker keeps one half and pushes the other one on its own
+	 * deque where idle workers can steal it, until the sub-ranges are no larger than grain_size.
+	 * The calling thread only waits for the completion of the whole range (or helps if it is itself a worker).
+	 * @param f a function taking the bounds (uint32 b, uint32 e) of a sub-range
+	 */
+	template <typename FUNC>
+	void parallel_for(uint32 begin, uint32 end, uint32 grain_size, const FUNC& f)
+	{
+		static_assert(std::is_same<typename std::result_of<FUNC(uint32, uint32)>::type, void>::value,
+					  "The given function should take a range (uint32, uint32) and return nothing.");
+
+		if (begin >= end)
+			return;
+		if (nb_working_workers_ == 0)
 		{
-			std::unique_lock<std::mutex> lock(queue_mutex_);
-			// don't allow enqueueing after stopping the pool
-			if (stop_)
-			{
-				std::cout << "ThreadPool::enqueue : Enqueue on stopped ThreadPool." << std::endl;
-				cgogn_assert_not_reached("Enqueue on stopped ThreadPool");
-			}
-			// Push work back on the queue
-			tasks_.push(std::move(task));
+			f(begin, end);
+			return;
 		}
 
-		// Notify a thread that there is new work to perform
-		condition_task_.notify_one();
-
-		return res;
+		auto job = std::make_shared<RangeJob<FUNC>>(this, f, std::max(1u, grain_size), end - begin);
+		// initial distribution: one contiguous part per working worker
+		const uint32 nb_parts = std::min(nb_working_workers_, (end - begin + job->grain_size_ - 1) / job->grain_size_);
+		const uint32 part_size = (end - begin) / nb_parts;
+		for (uint32 i = 0; i < nb_parts; ++i)
+		{
+			uint32 b = begin + i * part_size;
+			uint32 e = i == nb_parts - 1 ? end : b + part_size;
+			push_task([job, b, e]() { RangeJob<FUNC>::run(job, b, e); });
+		}
+		wait(*job);
 	}
 
 	template <class FUNC>
@@ -190,13 +204,77 @@ public:
 	void set_nb_workers(uint32 nb = 0xffffffff);
 
 private:
+	struct JobBase
+	{
+		std::atomic<uint32> remaining_;
+		bool done_ = false;
+		std::mutex mutex_;
+		std::condition_variable condition_done_;
+
+		explicit JobBase(uint32 nb) : remaining_(nb)
+		{
+		}
+
+		// called by the worker that processed the nb last elements of the job
+		inline void completed(uint32 nb)
+		{
+			if (remaining_.fetch_sub(nb) == nb)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				done_ = true;
+				condition_done_.notify_all();
+			}
+		}
+	};
+
+	template <typename FUNC>
+	struct RangeJob : public JobBase
+	{
+		ThreadPool* pool_;
+		const FUNC& f_;
+		uint32 grain_size_;
+
+		RangeJob(ThreadPool* pool, const FUNC& f, uint32 grain_size, uint32 nb)
+			: JobBase(nb), pool_(pool), f_(f), grain_size_(grain_size)
+		{
+		}
+
+		static void run(const std::shared_ptr<RangeJob>& job, uint32 b, uint32 e)
+		{
+			// lazy binary splitting: the second half is left for thieves
+			while (e - b > job->grain_size_)
+			{
+				uint32 mid = b + (e - b) / 2u;
+				job->pool_->push_task([job, mid, e]() { run(job, mid, e); });
+				e = mid;
+			}
+			job->f_(b, e);
+			job->completed(e - b);
+		}
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex mutex_;
+		std::deque<Task> tasks_;
+	};
+
+	// push on the deque of the calling worker or distribute among working workers if called from outside
+	void push_task(Task&& task);
+	// pop from the back of the worker own deque or steal from the front of another one
+	bool pop_task(uint32 worker, Task& task);
+	// wait for the completion of the given job (workers execute pending tasks meanwhile)
+	void wait(JobBase& job);
+
 #pragma warning(push)
 #pragma warning(disable : 4251)
 
 	// need to keep track of threads so we can join them
 	std::vector<std::thread> workers_;
-	// the task queue
-	std::queue<PackagedTask> tasks_;
+	// one task deque per worker
+	std::vector<std::unique_ptr<WorkerQueue>> queues_;
+	std::atomic<uint32> nb_pending_tasks_;
+	std::atomic<uint32> next_queue_;
 
 	std::vector<std::thread> additional_threads_;
 
@@ -207,8 +285,6 @@ private:
 
 	// limit usage to the n-th first workers
 	uint32 nb_working_workers_;
-	std::mutex running_mutex_;
-	std::condition_variable condition_running_;
 
 #pragma warning(pop)
 };
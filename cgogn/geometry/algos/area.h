@@ -42,8 +42,7 @@ template <typename MESH>
 Scalar area(const MESH& m, typename mesh_traits<MESH>::Face f,
 			const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	std::vector<Vertex> vertices = incident_vertices(m, f);
+	auto vertices = incident_vertices(m, f);
 	Scalar face_area{0};
 	for (uint32 i = 1, size = uint32(vertices.size()); i < size - 1; ++i)
 	{
@@ -26,9 +26,12 @@
 
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/utils/span.h>
 #include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/geometry/functions/distance.h>
+#include <cgogn/geometry/types/bvh.h>
+#include <cgogn/geometry/types/grid.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
 namespace cgogn
@@ -42,14 +45,13 @@ Vec3 closest_point_on_surface(const MESH& m,
 							  const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
 							  const Vec3& p)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Face = typename mesh_traits<MESH>::Face;
 
 	Vec3 closest(0, 0, 0);
 	Scalar min_dist = std::numeric_limits<Scalar>::max();
 
 	foreach_cell(m, [&](Face f) -> bool {
-		std::vector<Vertex> vertices = incident_vertices(m, f);
+		auto vertices = incident_vertices(m, f);
 		// std::vector<const Vec3*> vertices_position;
 		// std::transform(vertices.begin(), vertices.end(), std::back_inserter(vertices_position),
 		// 			   [&](Vertex v) -> const Vec3* { return &value<Vec3>(m, vertex_position, v); });
@@ -72,40 +74,32 @@ Vec3 closest_point_on_surface(const MESH& m,
 	return closest;
 }
 
-template <typename MESH, typename GRID>
-Vec3 closest_point_on_surface(const MESH& m,
-							  const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
-							  const GRID& g, const Vec3& p)
+template <typename MESH>
+Vec3 closest_point_on_surface(const MESH&, const typename mesh_traits<MESH>::template Attribute<Vec3>*,
+							  const Grid<MESH, typename mesh_traits<MESH>::Face>& g, const Vec3& p)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	using Face = typename mesh_traits<MESH>::Face;
-
 	Vec3 closest(0, 0, 0);
-	Scalar min_dist = std::numeric_limits<Scalar>::max();
-
-	g.foreach_face_around(p, [&](Face f) {
-		std::vector<Vertex> vertices = incident_vertices(m, f);
-		// std::vector<const Vec3*> vertices_position;
-		// std::transform(vertices.begin(), vertices.end(), std::back_inserter(vertices_position),
-		// 			   [&](Vertex v) -> const Vec3* { return &value<Vec3>(m, vertex_position, v); });
-		Scalar u, v, w;
-		// assume triangle faces
-		const Vec3& a = value<Vec3>(m, vertex_position, vertices[0]);
-		const Vec3& b = value<Vec3>(m, vertex_position, vertices[1]);
-		const Vec3& c = value<Vec3>(m, vertex_position, vertices[2]);
-		closest_point_in_triangle(p, a, b, c, u, v, w);
-		Vec3 pos = u * a + v * b + w * c;
-		Scalar dist = (pos - p).squaredNorm();
-		if (dist < min_dist)
-		{
-			closest = pos;
-			min_dist = dist;
-		}
-	});
+	g.closest_point(p, closest);
+	return closest;
+}
 
+template <typename MESH>
+Vec3 closest_point_on_surface(const MESH&, const typename mesh_traits<MESH>::template Attribute<Vec3>*,
+							  const BVH<MESH>& bvh, const Vec3& p)
+{
+	Vec3 closest(0, 0, 0);
+	bvh.closest_point(p, closest);
 	return closest;
 }
 
+template <typename MESH>
+void closest_points_on_surface(const MESH&, const typename mesh_traits<MESH>::template Attribute<Vec3>*,
+							   const BVH<MESH>& bvh, Span<const Vec3> points,
+							   Span<typename BVH<MESH>::ClosestPoint> results, bool signed_distance = false)
+{
+	bvh.closest_points(points, results, signed_distance);
+}
+
 } // namespace geometry
 
 } // namespace cgogn
@@ -67,20 +67,14 @@ void filter_regularize(MESH& m, typename mesh_traits<MESH>::template Attribute<V
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 
-	auto vertex_index = add_attribute<uint32, Vertex>(m, "__vertex_index");
-	uint32 nb_vertices = 0;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		value<uint32>(m, vertex_index, v) = nb_vertices++;
-		return true;
-	});
-
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> LAPL_COT =
-		geometry::cotan_laplacian_matrix(m, vertex_index.get(), vertex_position);
+	CotanLaplacian<MESH> laplacian(m, vertex_position);
+	const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& LAPL_COT = laplacian.matrix();
+	uint32 nb_vertices = laplacian.nb_vertices();
 
 	Eigen::MatrixXd vpos(nb_vertices, 3);
 	parallel_foreach_cell(m, [&](Vertex v) -> bool {
 		const Vec3& pv = value<Vec3>(m, vertex_position, v);
-		uint32 vidx = value<uint32>(m, vertex_index, v);
+		uint32 vidx = laplacian.vertex_index(v);
 		vpos(vidx, 0) = pv[0];
 		vpos(vidx, 1) = pv[1];
 		vpos(vidx, 2) = pv[2];
@@ -95,12 +89,12 @@ void filter_regularize(MESH& m, typename mesh_traits<MESH>::template Attribute<V
 	Eigen::MatrixXd b(2 * nb_vertices, 3);
 
 	foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, vertex_index, v);
+		uint32 vidx = laplacian.vertex_index(v);
 		if (!is_incident_to_boundary(m, v))
 		{
 			uint32 nbv = 0;
 			foreach_adjacent_vertex_through_edge(m, v, [&](Vertex av) -> bool {
-				uint32 avidx = value<uint32>(m, vertex_index, av);
+				uint32 avidx = laplacian.vertex_index(av);
 				Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx), int(avidx), 1));
 				++nbv;
 				return true;
@@ -124,15 +118,13 @@ void filter_regularize(MESH& m, typename mesh_traits<MESH>::template Attribute<V
 	vpos = solver.solve(At * b);
 
 	parallel_foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, vertex_index, v);
+		uint32 vidx = laplacian.vertex_index(v);
 		Vec3& pos = value<Vec3>(m, vertex_position, v);
 		pos[0] = vpos(vidx, 0);
 		pos[1] = vpos(vidx, 1);
 		pos[2] = vpos(vidx, 2);
 		return true;
 	});
-
-	remove_attribute<Vertex>(m, vertex_index);
 }
 
 template <typename MESH>
@@ -0,0 +1,323 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_ALGOS_INCREMENTAL_GEOMETRY_H_
+#define CGOGN_GEOMETRY_ALGOS_INCREMENTAL_GEOMETRY_H_
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_ops/edge.h>
+#include <cgogn/core/functions/mesh_ops/face.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cmap/dart_marker.h>
+
+#include <cgogn/geometry/algos/area.h>
+#include <cgogn/geometry/algos/laplacian.h>
+#include <cgogn/geometry/algos/length.h>
+#include <cgogn/geometry/algos/normal.h>
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <vector>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+/**
+ * @brief keeps the attributes derived from the vertex positions of a surface up to date under local edits
+ * Position writes and topological operations done through this object mark the vertices they touch. update() then
+ * recomputes the maintained attributes only on the faces incident to the marked vertices, on the edges and on the
+ * vertices of these faces: its cost is proportional to the size of the edits, not to the size of the mesh.
+ * Only the attributes that have been set are maintained. Topological edits that do not go through this object must
+ * be followed by a call to update_all().
+ */
+template <typename MESH>
+class IncrementalGeometry
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
+	static_assert(std::is_convertible_v<MESH&, CMap2&>, "MESH should be a CMap2");
+
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+public:
+	IncrementalGeometry(MESH& m, Attribute<Vec3>* vertex_position)
+		: m_(m), vertex_position_(vertex_position), vertex_normal_(nullptr), face_normal_(nullptr), face_area_(nullptr),
+		  edge_length_(nullptr), edge_cotan_weight_(nullptr)
+	{
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(IncrementalGeometry);
+
+	inline void set_vertex_normal(Attribute<Vec3>* vertex_normal)
+	{
+		vertex_normal_ = vertex_normal;
+	}
+	inline void set_face_normal(Attribute<Vec3>* face_normal)
+	{
+		face_normal_ = face_normal;
+	}
+	inline void set_face_area(Attribute<Scalar>* face_area)
+	{
+		face_area_ = face_area;
+	}
+	inline void set_edge_length(Attribute<Scalar>* edge_length)
+	{
+		edge_length_ = edge_length;
+	}
+	inline void set_edge_cotan_weight(Attribute<Scalar>* edge_cotan_weight)
+	{
+		edge_cotan_weight_ = edge_cotan_weight;
+	}
+
+	// a vertex marked several times is counted several times
+	inline uint32 nb_dirty_vertices() const
+	{
+		return uint32(dirty_vertices_.size());
+	}
+
+	/**
+	 * @brief mark v as modified (to be called after writing its position directly)
+	 */
+	inline void vertex_moved(Vertex v)
+	{
+		mark(v);
+	}
+
+	inline void set_position(Vertex v, const Vec3& p)
+	{
+		value<Vec3>(m_, vertex_position_, v) = p;
+		mark(v);
+	}
+
+	Vertex cut_edge(Edge e)
+	{
+		Vertex v = cgogn::cut_edge(m_, e);
+		mark(v);
+		return v;
+	}
+
+	Edge cut_face(Vertex v1, Vertex v2)
+	{
+		Edge e = cgogn::cut_face(m_, v1, v2);
+		mark(Vertex(e.dart));
+		mark(Vertex(phi2(m_, e.dart)));
+		return e;
+	}
+
+	// the marked vertices are updated first: a flip changes the vertex of the darts of the edge
+	bool flip_edge(Edge e)
+	{
+		update();
+		if (!cgogn::flip_edge(m_, e))
+			return false;
+		mark(Vertex(e.dart));
+		mark(Vertex(phi2(m_, e.dart)));
+		return true;
+	}
+
+	// the marked vertices are updated first: a collapse removes darts
+	Vertex collapse_edge(Edge e)
+	{
+		update();
+		Vertex v = cgogn::collapse_edge(m_, e);
+		mark(v);
+		return v;
+	}
+
+	/**
+	 * @brief recompute the maintained attributes in the neighborhood of the marked vertices & clear the marks
+	 */
+	void update()
+	{
+		if (dirty_vertices_.empty())
+			return;
+
+		// faces incident to the marked vertices, their edges & their vertices
+		// (a vertex marked several times only adds its faces once)
+		DartEpochMarker<MESH> visited(m_);
+		std::vector<Face> faces;
+		std::vector<Edge> edges;
+		std::vector<Vertex> vertices;
+		for (Vertex v : dirty_vertices_)
+		{
+			foreach_incident_face(m_, v, [&](Face f) -> bool {
+				if (!visited.is_marked(f.dart))
+				{
+					foreach_dart_of_orbit(m_, f, [&](Dart d) -> bool {
+						visited.mark(d);
+						return true;
+					});
+					faces.push_back(f);
+				}
+				return true;
+			});
+		}
+		dirty_vertices_.clear();
+
+		visited.unmark_all();
+		for (Face f : faces)
+		{
+			foreach_dart_of_orbit(m_, f, [&](Dart d) -> bool {
+				if (!visited.is_marked(d))
+				{
+					visited.mark(d);
+					visited.mark(phi2(m_, d));
+					edges.push_back(Edge(d));
+				}
+				return true;
+			});
+		}
+
+		visited.unmark_all();
+		for (Face f : faces)
+		{
+			foreach_dart_of_orbit(m_, f, [&](Dart d) -> bool {
+				if (!visited.is_marked(d))
+				{
+					foreach_dart_of_orbit(m_, Vertex(d), [&](Dart vd) -> bool {
+						visited.mark(vd);
+						return true;
+					});
+					vertices.push_back(Vertex(d));
+				}
+				return true;
+			});
+		}
+
+		if (face_normal_ || face_area_)
+		{
+			for (Face f : faces)
+				update_face(f);
+		}
+		if (edge_length_ || edge_cotan_weight_)
+		{
+			for (Edge e : edges)
+				update_edge(e);
+		}
+		if (vertex_normal_)
+		{
+			for (Vertex v : vertices)
+				update_vertex(v);
+		}
+	}
+
+	/**
+	 * @brief recompute the maintained attributes on the whole mesh & clear the marks
+	 */
+	void update_all()
+	{
+		dirty_vertices_.clear();
+
+		if (face_normal_ || face_area_)
+		{
+			parallel_foreach_cell(m_, [&](Face f) -> bool {
+				update_face(f);
+				return true;
+			});
+		}
+		if (edge_length_ || edge_cotan_weight_)
+		{
+			parallel_foreach_cell(m_, [&](Edge e) -> bool {
+				update_edge(e);
+				return true;
+			});
+		}
+		if (vertex_normal_)
+		{
+			parallel_foreach_cell(m_, [&](Vertex v) -> bool {
+				update_vertex(v);
+				return true;
+			});
+		}
+	}
+
+private:
+	// the list is not deduplicated here: update() skips the faces already collected
+	inline void mark(Vertex v)
+	{
+		dirty_vertices_.push_back(v);
+	}
+
+	// the values are computed from the smallest dart of the cells so that they do not depend on the dart that
+	// represents the cell in the traversal (e.g. the area of non-planar faces), and thus match the global computation
+	template <typename CELL>
+	inline CELL smallest_dart(CELL c) const
+	{
+		Dart sd = c.dart;
+		foreach_dart_of_orbit(m_, c, [&](Dart d) -> bool {
+			if (d.index < sd.index)
+				sd = d;
+			return true;
+		});
+		return CELL(sd);
+	}
+
+	inline void update_vertex(Vertex v)
+	{
+		value<Vec3>(m_, vertex_normal_, v) = normal(m_, smallest_dart(v), vertex_position_);
+	}
+
+	inline void update_face(Face f)
+	{
+		f = smallest_dart(f);
+		if (face_normal_)
+			value<Vec3>(m_, face_normal_, f) = normal(m_, f, vertex_position_);
+		if (face_area_)
+			value<Scalar>(m_, face_area_, f) = area(m_, f, vertex_position_);
+	}
+
+	inline void update_edge(Edge e)
+	{
+		if (edge_length_)
+			value<Scalar>(m_, edge_length_, e) = length(m_, e, vertex_position_);
+		if (edge_cotan_weight_)
+		{
+			// the weight is computed from a dart that is not on the boundary
+			Edge ie = is_boundary(m_, e.dart) ? Edge(phi2(m_, e.dart)) : e;
+			value<Scalar>(m_, edge_cotan_weight_, e) = edge_cotan_weight(m_, ie, vertex_position_);
+		}
+	}
+
+	MESH& m_;
+	Attribute<Vec3>* vertex_position_;
+
+	Attribute<Vec3>* vertex_normal_;
+	Attribute<Vec3>* face_normal_;
+	Attribute<Scalar>* face_area_;
+	Attribute<Scalar>* edge_length_;
+	Attribute<Scalar>* edge_cotan_weight_;
+
+	std::vector<Vertex> dirty_vertices_;
+};
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_ALGOS_INCREMENTAL_GEOMETRY_H_
@@ -27,6 +27,7 @@
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/traversals/global.h>
 #include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 // #include <cgogn/geometry/algos/angle.h>
 #include <cgogn/geometry/algos/area.h>
@@ -35,6 +36,10 @@
 
 #include <Eigen/Sparse>
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 namespace cgogn
 {
 
@@ -169,6 +174,151 @@ Eigen::SparseMatrix<Scalar, Eigen::ColMajor> topo_laplacian_matrix(
 	return LAPL;
 }
 
+/**
+ * @brief cotan Laplacian operator bound to a mesh
+ * The vertex indexing and the sparsity pattern of the matrix are built by update_connectivity() and kept until its
+ * next call: update_values() only refills the coefficients when the positions change (the weights are computed in
+ * parallel). As the pattern does not change between two calls to update_connectivity(), the solvers built on this
+ * matrix can keep their symbolic factorization (analyzePattern once, factorize after each update_values()).
+ * The coefficients are the same as the ones of cotan_laplacian_matrix.
+ */
+template <typename MESH>
+class CotanLaplacian
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
+
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+
+public:
+	using Matrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+
+	CotanLaplacian(MESH& m, const Attribute<Vec3>* vertex_position) : m_(m), vertex_position_(vertex_position)
+	{
+		update_connectivity();
+		update_values();
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CotanLaplacian);
+
+	/**
+	 * @brief index the vertices & build the sparsity pattern of the matrix (to call after each topological change)
+	 * The coefficients are set to zero until the next call to update_values().
+	 */
+	void update_connectivity()
+	{
+		// the vertex indexing is kept in a local array (not in an attribute of the mesh): several operators can be
+		// bound to the same mesh
+		nb_vertices_ = 0;
+		vertex_index_.resize(maximum_index<Vertex>(m_));
+		foreach_cell(m_, [&](Vertex v) -> bool {
+			vertex_index_[index_of(m_, v)] = nb_vertices_++;
+			return true;
+		});
+
+		edges_.clear();
+		edges_vertices_.clear();
+		foreach_cell(m_, [&](Edge e) -> bool {
+			auto vertices = incident_vertices(m_, e);
+			edges_.push_back(e);
+			edges_vertices_.push_back({vertex_index(vertices[0]), vertex_index(vertices[1])});
+			return true;
+		});
+		edges_weight_.resize(edges_.size());
+
+		std::vector<Eigen::Triplet<Scalar>> coeffs;
+		coeffs.reserve(2 * edges_.size() + nb_vertices_);
+		for (const std::array<uint32, 2>& ev : edges_vertices_)
+		{
+			coeffs.push_back(Eigen::Triplet<Scalar>(int(ev[0]), int(ev[1]), 0.0));
+			coeffs.push_back(Eigen::Triplet<Scalar>(int(ev[1]), int(ev[0]), 0.0));
+		}
+		for (uint32 i = 0; i < nb_vertices_; ++i)
+			coeffs.push_back(Eigen::Triplet<Scalar>(int(i), int(i), 0.0));
+		matrix_.resize(nb_vertices_, nb_vertices_);
+		matrix_.setFromTriplets(coeffs.begin(), coeffs.end());
+		matrix_.makeCompressed();
+
+		// position of the coefficients of each edge & of the diagonal in the values array of the matrix
+		edges_coefficients_.resize(edges_.size());
+		thread_pool()->parallel_for(0u, uint32(edges_.size()), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				const std::array<uint32, 2>& ev = edges_vertices_[i];
+				edges_coefficients_[i] = {coefficient_position(ev[0], ev[1]), coefficient_position(ev[1], ev[0])};
+			}
+		});
+		diagonal_coefficients_.resize(nb_vertices_);
+		for (uint32 i = 0; i < nb_vertices_; ++i)
+			diagonal_coefficients_[i] = coefficient_position(i, i);
+	}
+
+	/**
+	 * @brief compute the coefficients of the matrix from the current vertex positions
+	 */
+	void update_values()
+	{
+		thread_pool()->parallel_for(0u, uint32(edges_.size()), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+				edges_weight_[i] = edge_cotan_weight(m_, edges_[i], vertex_position_);
+		});
+
+		// the accumulation is sequential: several edges may share the same coefficients (multiple edges)
+		Scalar* values = matrix_.valuePtr();
+		std::fill(values, values + matrix_.nonZeros(), 0.0);
+		for (uint32 i = 0, nb = uint32(edges_.size()); i < nb; ++i)
+		{
+			const Scalar w = edges_weight_[i];
+			const std::array<uint32, 2>& ev = edges_vertices_[i];
+			const std::array<uint32, 2>& ec = edges_coefficients_[i];
+			values[ec[0]] += w;
+			values[ec[1]] += w;
+			values[diagonal_coefficients_[ev[0]]] -= w;
+			values[diagonal_coefficients_[ev[1]]] -= w;
+		}
+	}
+
+	inline const Matrix& matrix() const
+	{
+		return matrix_;
+	}
+
+	inline uint32 nb_vertices() const
+	{
+		return nb_vertices_;
+	}
+
+	// index of the given vertex in the matrix
+	inline uint32 vertex_index(Vertex v) const
+	{
+		return vertex_index_[index_of(m_, v)];
+	}
+
+private:
+	inline uint32 coefficient_position(uint32 row, uint32 col) const
+	{
+		const int* inner = matrix_.innerIndexPtr();
+		const int* outer = matrix_.outerIndexPtr();
+		return uint32(std::lower_bound(inner + outer[col], inner + outer[col + 1], int(row)) - inner);
+	}
+
+	MESH& m_;
+	const Attribute<Vec3>* vertex_position_;
+	std::vector<uint32> vertex_index_;
+	uint32 nb_vertices_;
+
+	std::vector<Edge> edges_;
+	std::vector<std::array<uint32, 2>> edges_vertices_;
+	std::vector<std::array<uint32, 2>> edges_coefficients_;
+	std::vector<uint32> diagonal_coefficients_;
+	std::vector<Scalar> edges_weight_;
+
+	Matrix matrix_;
+};
+
 } // namespace geometry
 
 } // namespace cgogn
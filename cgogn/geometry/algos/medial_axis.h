@@ -24,16 +24,25 @@
 #ifndef CGOGN_GEOMETRY_ALGOS_MEDIAL_AXIS_H_
 #define CGOGN_GEOMETRY_ALGOS_MEDIAL_AXIS_H_
 
+#include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/traversals/global.h>
 #include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/radix_sort.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/geometry/functions/angle.h>
+#include <cgogn/geometry/types/bvh.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
 #include <vector>
 
-#include <libacc/bvh_tree.h>
 #include <libacc/kd_tree.h>
 
 namespace cgogn
@@ -57,133 +66,161 @@ inline Scalar compute_radius(const Vec3& p, const Vec3& n, const Vec3& q)
 
 // adapted from https://github.com/tudelft3d/masbcpp
 
+/**
+ * compute the center of the maximal inscribed ball touching each vertex (shrinking ball algorithm)
+ * The vertices are processed in parallel, in the order of a space filling curve: the nearest neighbour found for the
+ * previous ball of a chunk bounds the search for the current one.
+ * The nearest vertex queries use a kd-tree: the query balls are about as large as the medial balls, which a hash grid
+ * (Grid) answers by visiting many grid cells (about 7 times slower on the sample meshes).
+ * @param vertex_position shared with the BVH built on the surface
+ * @param phase_timings if given, receives the duration (in seconds) of each phase
+ */
 template <typename MESH>
-void shrinking_ball_centers(MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+void shrinking_ball_centers(MESH& m,
+							const std::shared_ptr<typename mesh_traits<MESH>::template Attribute<Vec3>>& vertex_position,
 							const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_normal,
-							typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_shrinking_ball_center)
+							typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_shrinking_ball_center,
+							std::vector<std::pair<std::string, float64>>* phase_timings = nullptr)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
-	using Face = typename mesh_traits<MESH>::Face;
-
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	uint32 nb_faces = nb_cells<Face>(m);
-
-	auto bvh_vertex_index = add_attribute<uint32, Vertex>(m, "__bvh_vertex_index");
-	std::vector<Vec3> bvh_vertex_position;
-	bvh_vertex_position.reserve(nb_vertices);
-	uint32 idx = 0;
+	using Clock = std::chrono::high_resolution_clock;
+
+	ThreadPool* pool = thread_pool();
+	auto phase_start = Clock::now();
+	auto end_phase = [&](const std::string& name) {
+		auto now = Clock::now();
+		if (phase_timings)
+			phase_timings->emplace_back(name, std::chrono::duration<float64>(now - phase_start).count());
+		phase_start = now;
+	};
+
+	std::vector<Vertex> vertices;
+	vertices.reserve(nb_cells<Vertex>(m));
 	foreach_cell(m, [&](Vertex v) -> bool {
-		value<uint32>(m, bvh_vertex_index, v) = idx++;
-		bvh_vertex_position.push_back(value<Vec3>(m, vertex_position, v));
+		vertices.push_back(v);
 		return true;
 	});
-	std::vector<Face> bvh_faces;
-	bvh_faces.reserve(nb_faces);
-	std::vector<uint32> face_vertex_indices;
-	face_vertex_indices.reserve(nb_faces * 3);
-	foreach_cell(m, [&](Face f) -> bool {
-		bvh_faces.push_back(f);
-		foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
-			face_vertex_indices.push_back(value<uint32>(m, bvh_vertex_index, v));
-			return true;
-		});
-		return true;
+	const uint32 nb_vertices = uint32(vertices.size());
+	std::vector<Vec3> surface_vertex_position(nb_vertices);
+	pool->parallel_for(0u, nb_vertices, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+			surface_vertex_position[i] = value<Vec3>(m, vertex_position, vertices[i]);
 	});
-	acc::BVHTree<uint32, Vec3>* surface_bvh = new acc::BVHTree<uint32, Vec3>(face_vertex_indices, bvh_vertex_position);
-
-	std::vector<Vertex> kdt_vertices;
-	std::vector<Vec3> kdt_vertex_position;
-	kdt_vertices.reserve(nb_vertices);
-	kdt_vertex_position.reserve(nb_vertices);
-	foreach_cell(m, [&](Vertex v) -> bool {
-		kdt_vertices.push_back(v);
-		kdt_vertex_position.push_back(value<Vec3>(m, vertex_position, v));
-		return true;
+	end_phase("gather");
+
+	BVH<MESH> surface_bvh(m, vertex_position);
+	end_phase("bvh");
+	// the kd-tree splits its nodes in parallel
+	acc::KDTree<3, uint32> surface_kdt(surface_vertex_position, int32(std::max(1u, pool->nb_workers())));
+	end_phase("kd-tree");
+
+	// Morton order of the vertices (10 bits per axis) so that consecutive queries are spatially coherent
+	Vec3 bb_min = Vec3::Constant(std::numeric_limits<Scalar>::max());
+	Vec3 bb_max = Vec3::Constant(std::numeric_limits<Scalar>::lowest());
+	for (const Vec3& p : surface_vertex_position)
+	{
+		bb_min = bb_min.cwiseMin(p);
+		bb_max = bb_max.cwiseMax(p);
+	}
+	const Vec3 extent = (bb_max - bb_min).cwiseMax(std::numeric_limits<Scalar>::min());
+	auto spread_bits = [](uint64 x) -> uint64 {
+		x = (x | (x << 16)) & 0x030000FF;
+		x = (x | (x << 8)) & 0x0300F00F;
+		x = (x | (x << 4)) & 0x030C30C3;
+		x = (x | (x << 2)) & 0x09249249;
+		return x;
+	};
+	std::vector<uint64> keys(nb_vertices);
+	std::vector<uint32> order(nb_vertices);
+	pool->parallel_for(0u, nb_vertices, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint64 code = 0u;
+			for (uint32 k = 0; k < 3; ++k)
+			{
+				Scalar x = std::clamp((surface_vertex_position[i][k] - bb_min[k]) / extent[k], Scalar(0), Scalar(1));
+				code |= spread_bits(uint64(x * 1023.0)) << k;
+			}
+			keys[i] = code;
+			order[i] = i;
+		}
 	});
-	acc::KDTree<3, uint32>* surface_kdt = new acc::KDTree<3, uint32>(kdt_vertex_position);
+	radix_sort(keys, order, 30u);
+	end_phase("sort");
 
 	const Scalar denoise_preserve = 20.0 * M_PI / 180.0;
 	const Scalar denoise_planar = 32.0 * M_PI / 180.0;
 	const Scalar delta_convergence = 1e-5;
 	const uint32 iteration_limit = 30;
 
-	parallel_foreach_cell(m, [&](Vertex v) -> bool {
-		const Vec3& p = value<Vec3>(m, vertex_position, v);
-		const Vec3& n = value<Vec3>(m, vertex_normal, v);
+	pool->parallel_for(0u, nb_vertices, 256u, [&](uint32 b, uint32 e) {
+		// last nearest neighbour found in this chunk
+		uint32 last_nn = INVALID_INDEX;
 
-		uint32 j = 0;
-		Scalar r = 0.;
-
-		acc::Ray<Vec3> ray{p, -n, 1e-10, acc::inf};
-		acc::BVHTree<uint32, Vec3>::Hit h;
-		if (surface_bvh->intersect(ray, &h))
+		for (uint32 i = b; i < e; ++i)
 		{
-			Face f = bvh_faces[h.idx];
-			std::vector<Vertex> vertices = incident_vertices(m, f);
-			Vec3 ip = h.bcoords[0] * value<Vec3>(m, vertex_position, vertices[0]) +
-					  h.bcoords[1] * value<Vec3>(m, vertex_position, vertices[1]) +
-					  h.bcoords[2] * value<Vec3>(m, vertex_position, vertices[2]);
-			r = (p - ip).norm() * 0.51;
-		}
-		// else
-		// 	std::cout << "intersection point not found !!!";
+			const uint32 vi = order[i];
+			const Vec3& p = surface_vertex_position[vi];
+			const Vec3& n = value<Vec3>(m, vertex_normal, vertices[vi]);
 
-		Vec3 c = p - (r * n);
+			uint32 j = 0;
+			Scalar r = 0.;
 
-		while (true)
-		{
-			// find closest point to c
-			std::pair<uint32, Scalar> k_res;
-			bool found = surface_kdt->find_nn(c, &k_res);
-			// std::pair<uint32, Vec3> cp_res;
-			// bool found = surface_bvh->closest_point(c, &cp_res);
-			if (!found)
-				std::cout << "closest point not found !!!";
-
-			const Vec3& q = surface_kdt->vertex(k_res.first);
-			Scalar d = k_res.second;
-			// Vec3 q = cp_res.second;
-			// Scalar d = (q - c).norm();
-
-			// This should handle all (special) cases where we want to break the loop
-			// - normal case when ball no longer shrinks
-			// - the case where q == p
-			// - any duplicate point cases
-			if ((d >= r - delta_convergence) || (p == q))
-				break;
-
-			// Compute next ball center
-			r = compute_radius(p, n, q);
-			Vec3 c_next = p - (r * n);
-
-			// // Denoising
-			if (denoise_preserve > 0 || denoise_planar > 0)
+			Vec3 ip;
+			if (surface_bvh.first_hit(p, -n, ip, nullptr, 1e-10))
+				r = (p - ip).norm() * 0.51;
+
+			Vec3 c = p - (r * n);
+
+			while (true)
 			{
-				Scalar separation_angle = geometry::angle(p - c_next, q - c_next);
+				// find closest point to c
+				// p is at distance r from c & the last nearest neighbour gives another bound for the search
+				Scalar max_dist = r;
+				if (last_nn != INVALID_INDEX)
+					max_dist = std::min(max_dist, (surface_vertex_position[last_nn] - c).norm());
+				std::pair<uint32, double> k_res;
+				if (!surface_kdt.find_nn(c, &k_res, max_dist * (1 + 1e-9) + 1e-12))
+					break;
+				last_nn = k_res.first;
 
-				// if (j == 0 && denoise_planar > 0 && separation_angle < denoise_planar)
-				// 	break;
-				if (j > 0 && denoise_preserve > 0 && (separation_angle < denoise_preserve && r > (q - p).norm()))
+				const Vec3& q = surface_vertex_position[k_res.first];
+				Scalar d = k_res.second;
+
+				// This should handle all (special) cases where we want to break the loop
+				// - normal case when ball no longer shrinks
+				// - the case where q == p
+				// - any duplicate point cases
+				if ((d >= r - delta_convergence) || (p == q))
 					break;
-			}
 
-			// // Stop iteration if this looks like an infinite loop:
-			if (j > iteration_limit)
-				break;
+				// Compute next ball center
+				r = compute_radius(p, n, q);
+				Vec3 c_next = p - (r * n);
 
-			c = c_next;
-			j++;
-		}
+				// // Denoising
+				if (denoise_preserve > 0 || denoise_planar > 0)
+				{
+					Scalar separation_angle = geometry::angle(p - c_next, q - c_next);
 
-		value<Vec3>(m, vertex_shrinking_ball_center, v) = c;
+					// if (j == 0 && denoise_planar > 0 && separation_angle < denoise_planar)
+					// 	break;
+					if (j > 0 && denoise_preserve > 0 && (separation_angle < denoise_preserve && r > (q - p).norm()))
+						break;
+				}
 
-		return true;
-	});
+				// // Stop iteration if this looks like an infinite loop:
+				if (j > iteration_limit)
+					break;
 
-	delete surface_kdt;
+				c = c_next;
+				j++;
+			}
 
-	remove_attribute<Vertex>(m, bvh_vertex_index);
-	delete surface_bvh;
+			value<Vec3>(m, vertex_shrinking_ball_center, vertices[vi]) = c;
+		}
+	});
+	end_phase("shrink");
 }
 
 } // namespace geometry
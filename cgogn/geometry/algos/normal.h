@@ -45,8 +45,7 @@ Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Face f,
 {
 	static_assert(mesh_traits<MESH>::dimension >= 2, "MESH dimension should be >= 2");
 
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	std::vector<Vertex> vertices = incident_vertices(m, f);
+	auto vertices = incident_vertices(m, f);
 	if (uint32(vertices.size()) == 3)
 	{
 		Vec3 n = normal(value<Vec3>(m, vertex_position, vertices[0]), value<Vec3>(m, vertex_position, vertices[1]),
@@ -74,8 +73,7 @@ template <typename MESH>
 Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Face2 f,
 			const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	std::vector<Vertex> vertices = incident_vertices(m, f);
+	auto vertices = incident_vertices(m, f);
 	if (uint32(vertices.size()) == 3)
 	{
 		Vec3 n = normal(value<Vec3>(m, vertex_position, vertices[0]), value<Vec3>(m, vertex_position, vertices[1]),
@@ -105,7 +103,6 @@ Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Vertex v,
 {
 	static_assert(mesh_traits<MESH>::dimension >= 2, "MESH dimension should be >= 2");
 
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Face = typename mesh_traits<MESH>::Face;
 	Vec3 n{0.0, 0.0, 0.0};
 	foreach_incident_face(m, v, [&](Face f) -> bool {
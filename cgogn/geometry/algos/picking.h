@@ -29,6 +29,7 @@
 
 #include <cgogn/geometry/functions/distance.h>
 #include <cgogn/geometry/functions/intersection.h>
+#include <cgogn/geometry/types/bvh.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
 namespace cgogn
@@ -45,7 +46,6 @@ std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>> picking(
 	const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position, const Vec3& A,
 	const Vec3& B)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Face = typename mesh_traits<MESH>::Face;
 	using SelectedFace = std::tuple<Face, Vec3, Scalar>;
 
@@ -59,7 +59,7 @@ std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>> picking(
 	parallel_foreach_cell(m, [&](Face f) -> bool {
 		uint32 worker_index = current_worker_index();
 		Vec3 intersection_point;
-		std::vector<Vertex> vertices = incident_vertices(m, f);
+		auto vertices = incident_vertices(m, f);
 		if (vertices.size() == 3)
 		{
 			if (intersection_ray_triangle(A, AB, value<Vec3>(m, vertex_position, vertices[0]),
@@ -114,17 +114,33 @@ std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>> picking(
 	return result;
 }
 
-} // namespace internal
-
 template <typename MESH>
-void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position, const Vec3& A,
-			 const Vec3& B, std::vector<typename mesh_traits<MESH>::Vertex>& result)
+std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>> picking(const BVH<MESH>& bvh, const Vec3& A,
+																				 const Vec3& B)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Face = typename mesh_traits<MESH>::Face;
 	using SelectedFace = std::tuple<Face, Vec3, Scalar>;
 
-	std::vector<SelectedFace> selected_faces = internal::picking(m, vertex_position, A, B);
+	Vec3 AB = B - A;
+	cgogn_message_assert(AB.squaredNorm() > 0.0, "line must be defined by 2 different points");
+	AB.normalize();
+
+	std::vector<SelectedFace> result;
+	bvh.foreach_face_on_ray(A, AB, [&](Face f, const Vec3& I, Scalar d2) { result.emplace_back(f, I, d2); });
+
+	std::sort(result.begin(), result.end(),
+			  [](const SelectedFace& f1, const SelectedFace& f2) -> bool { return std::get<2>(f1) < std::get<2>(f2); });
+
+	return result;
+}
+
+template <typename MESH>
+void picked_cells(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+				  const std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>>& selected_faces,
+				  std::vector<typename mesh_traits<MESH>::Vertex>& result)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Face = typename mesh_traits<MESH>::Face;
 
 	CellMarkerStore<MESH, Vertex> cm(m);
 	result.clear();
@@ -156,15 +172,12 @@ void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute
 }
 
 template <typename MESH>
-void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position, const Vec3& A,
-			 const Vec3& B, std::vector<typename mesh_traits<MESH>::Edge>& result)
+void picked_cells(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+				  const std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>>& selected_faces,
+				  std::vector<typename mesh_traits<MESH>::Edge>& result)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Edge = typename mesh_traits<MESH>::Edge;
 	using Face = typename mesh_traits<MESH>::Face;
-	using SelectedFace = std::tuple<Face, Vec3, Scalar>;
-
-	std::vector<SelectedFace> selected_faces = internal::picking(m, vertex_position, A, B);
 
 	CellMarkerStore<MESH, Edge> cm(m);
 	result.clear();
@@ -178,7 +191,7 @@ void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute
 		const Vec3& I = std::get<1>(sf);
 
 		foreach_incident_edge(m, f, [&](Edge e) -> bool {
-			std::vector<Vertex> vertices = incident_vertices(m, e);
+			auto vertices = incident_vertices(m, e);
 			Scalar d2 = squared_distance_line_point(value<Vec3>(m, vertex_position, vertices[0]),
 													value<Vec3>(m, vertex_position, vertices[1]), I);
 			if (d2 < min_d2)
@@ -198,20 +211,36 @@ void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute
 }
 
 template <typename MESH>
-void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position, const Vec3& A,
-			 const Vec3& B, std::vector<typename mesh_traits<MESH>::Face>& result)
+void picked_cells(const MESH&, const typename mesh_traits<MESH>::template Attribute<Vec3>*,
+				  const std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>>& selected_faces,
+				  std::vector<typename mesh_traits<MESH>::Face>& result)
 {
-	using Face = typename mesh_traits<MESH>::Face;
-	using SelectedFace = std::tuple<Face, Vec3, Scalar>;
-
-	std::vector<SelectedFace> selected_faces = internal::picking(m, vertex_position, A, B);
-
 	result.clear();
 	result.reserve(selected_faces.size());
 	for (const auto& sf : selected_faces)
 		result.push_back(std::get<0>(sf));
 }
 
+} // namespace internal
+
+// CELL is Vertex, Edge or Face: the picked cells are sorted by distance to A
+// repeated picks on a static mesh should use the BVH overload: the hierarchy skips the empty space along the ray,
+// whereas a uniform grid (Grid) would visit every grid cell the ray crosses
+
+template <typename MESH, typename CELL>
+void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position, const Vec3& A,
+			 const Vec3& B, std::vector<CELL>& result)
+{
+	internal::picked_cells(m, vertex_position, internal::picking(m, vertex_position, A, B), result);
+}
+
+template <typename MESH, typename CELL>
+void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+			 const BVH<MESH>& bvh, const Vec3& A, const Vec3& B, std::vector<CELL>& result)
+{
+	internal::picked_cells(m, vertex_position, internal::picking(bvh, A, B), result);
+}
+
 } // namespace geometry
 
 } // namespace cgogn
@@ -42,6 +42,11 @@ namespace cgogn
 namespace geometry
 {
 
+/**
+ * select the cells of the connected patch around center that lies within the sphere, and the half-edges that leave it
+ * The patch is grown from center through the edges: a spatial query (e.g. Grid::foreach_in_sphere) would also return
+ * the vertices of other parts of the surface that cross the sphere, and could not give the leaving half-edges.
+ */
 CellCache<CMap2> within_sphere(const CMap2& m, typename CMap2::Vertex center, geometry::Scalar radius,
 							   const typename CMap2::template Attribute<Vec3>* vertex_position)
 {
@@ -54,7 +59,7 @@ CellCache<CMap2> within_sphere(const CMap2& m, typename CMap2::Vertex center, ge
 
 	const Vec3& center_position = value<Vec3>(m, vertex_position, center);
 
-	DartMarkerStore dm(m);
+	DartEpochMarker dm(m);
 
 	auto mark_vertex = [&](Vertex v) {
 		foreach_dart_of_orbit(m, v, [&](Dart d) -> bool {
@@ -0,0 +1,238 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cmap/cmap2.h>
+#include <cgogn/geometry/algos/incremental_geometry.h>
+#include <cgogn/io/surface/surface_import.h>
+
+#include <cmath>
+
+namespace cgogn
+{
+
+using Vec3 = geometry::Vec3;
+using Scalar = geometry::Scalar;
+
+class IncrementalGeometryTest : public ::testing::Test
+{
+protected:
+	using Vertex = CMap2::Vertex;
+	using Edge = CMap2::Edge;
+	using Face = CMap2::Face;
+
+	static const uint32 GRID_SIZE = 8u;
+
+	CMap2 map_;
+	std::shared_ptr<CMap2::Attribute<Vec3>> vertex_position_;
+	std::shared_ptr<CMap2::Attribute<Vec3>> vertex_normal_;
+	std::shared_ptr<CMap2::Attribute<Vec3>> face_normal_;
+	std::shared_ptr<CMap2::Attribute<Scalar>> face_area_;
+	std::shared_ptr<CMap2::Attribute<Scalar>> edge_length_;
+	std::shared_ptr<CMap2::Attribute<Scalar>> edge_cotan_weight_;
+	std::unique_ptr<geometry::IncrementalGeometry<CMap2>> incremental_geometry_;
+
+	// triangulated grid with a non planar height field
+	void SetUp() override
+	{
+		io::SurfaceImportData surface_data;
+		surface_data.reserve(GRID_SIZE * GRID_SIZE, 2u * (GRID_SIZE - 1u) * (GRID_SIZE - 1u));
+		for (uint32 j = 0u; j < GRID_SIZE; ++j)
+			for (uint32 i = 0u; i < GRID_SIZE; ++i)
+				surface_data.vertex_position_.push_back(Vec3(i, j, 0.3 * std::sin(Scalar(i)) * std::cos(Scalar(j))));
+		for (uint32 j = 0u; j < GRID_SIZE - 1u; ++j)
+		{
+			for (uint32 i = 0u; i < GRID_SIZE - 1u; ++i)
+			{
+				uint32 v = j * GRID_SIZE + i;
+				surface_data.faces_nb_vertices_.insert(surface_data.faces_nb_vertices_.end(), {3u, 3u});
+				surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+														  {v, v + 1u, v + GRID_SIZE + 1u, v, v + GRID_SIZE + 1u,
+														   v + GRID_SIZE});
+			}
+		}
+		surface_data.nb_vertices_ = uint32(surface_data.vertex_position_.size());
+		surface_data.nb_faces_ = uint32(surface_data.faces_nb_vertices_.size());
+		io::import_surface_data(map_, surface_data);
+
+		vertex_position_ = get_attribute<Vec3, Vertex>(map_, "position");
+		vertex_normal_ = add_attribute<Vec3, Vertex>(map_, "normal");
+		face_normal_ = add_attribute<Vec3, Face>(map_, "normal");
+		face_area_ = add_attribute<Scalar, Face>(map_, "area");
+		edge_length_ = add_attribute<Scalar, Edge>(map_, "length");
+		edge_cotan_weight_ = add_attribute<Scalar, Edge>(map_, "cotan_weight");
+
+		incremental_geometry_ = std::make_unique<geometry::IncrementalGeometry<CMap2>>(map_, vertex_position_.get());
+		incremental_geometry_->set_vertex_normal(vertex_normal_.get());
+		incremental_geometry_->set_face_normal(face_normal_.get());
+		incremental_geometry_->set_face_area(face_area_.get());
+		incremental_geometry_->set_edge_length(edge_length_.get());
+		incremental_geometry_->set_edge_cotan_weight(edge_cotan_weight_.get());
+		incremental_geometry_->update_all();
+	}
+
+	Vertex grid_vertex(uint32 i, uint32 j)
+	{
+		Vertex result;
+		foreach_cell(map_, [&](Vertex v) -> bool {
+			const Vec3& p = value<Vec3>(map_, vertex_position_, v);
+			if (p[0] == Scalar(i) && p[1] == Scalar(j))
+			{
+				result = v;
+				return false;
+			}
+			return true;
+		});
+		return result;
+	}
+
+	Edge grid_edge(uint32 i1, uint32 j1, uint32 i2, uint32 j2)
+	{
+		Vertex v1 = grid_vertex(i1, j1);
+		Vertex v2 = grid_vertex(i2, j2);
+		Edge result;
+		foreach_dart_of_orbit(map_, v1, [&](Dart d) -> bool {
+			if (index_of(map_, Vertex(phi1(map_, d))) == index_of(map_, v2))
+			{
+				result = Edge(d);
+				return false;
+			}
+			return true;
+		});
+		return result;
+	}
+
+	// compare the maintained attributes with a global recomputation
+	void expect_up_to_date()
+	{
+		EXPECT_EQ(incremental_geometry_->nb_dirty_vertices(), 0u);
+		foreach_cell(map_, [&](Vertex v) -> bool {
+			EXPECT_LT((value<Vec3>(map_, vertex_normal_, v) - geometry::normal(map_, v, vertex_position_.get())).norm(),
+					  1e-9);
+			return true;
+		});
+		foreach_cell(map_, [&](Face f) -> bool {
+			EXPECT_LT((value<Vec3>(map_, face_normal_, f) - geometry::normal(map_, f, vertex_position_.get())).norm(),
+					  1e-9);
+			EXPECT_NEAR(value<Scalar>(map_, face_area_, f), geometry::area(map_, f, vertex_position_.get()), 1e-9);
+			return true;
+		});
+		foreach_cell(map_, [&](Edge e) -> bool {
+			EXPECT_NEAR(value<Scalar>(map_, edge_length_, e), geometry::length(map_, e, vertex_position_.get()),
+						1e-9);
+			// the weight of the boundary edges depends on the dart it is computed from
+			if (!is_incident_to_boundary(map_, e))
+			{
+				EXPECT_NEAR(value<Scalar>(map_, edge_cotan_weight_, e),
+							geometry::edge_cotan_weight(map_, e, vertex_position_.get()), 1e-9);
+			}
+			return true;
+		});
+	}
+};
+
+TEST_F(IncrementalGeometryTest, UpdateAll)
+{
+	expect_up_to_date();
+}
+
+TEST_F(IncrementalGeometryTest, SetPosition)
+{
+	Vertex v = grid_vertex(3, 3);
+	incremental_geometry_->set_position(v, Vec3(3.2, 2.9, 1.0));
+	incremental_geometry_->set_position(grid_vertex(0, 5), Vec3(-0.5, 5.0, -0.4));
+	// a vertex marked several times
+	incremental_geometry_->set_position(v, Vec3(3.1, 3.1, 0.7));
+	EXPECT_EQ(incremental_geometry_->nb_dirty_vertices(), 3u);
+	incremental_geometry_->update();
+	expect_up_to_date();
+}
+
+TEST_F(IncrementalGeometryTest, VertexMoved)
+{
+	Vertex v = grid_vertex(5, 2);
+	value<Vec3>(map_, vertex_position_, v) += Vec3(0.1, -0.2, 0.5);
+	incremental_geometry_->vertex_moved(v);
+	incremental_geometry_->update();
+	expect_up_to_date();
+}
+
+TEST_F(IncrementalGeometryTest, UpdateIsLocal)
+{
+	Vertex far = grid_vertex(7, 7);
+	value<Vec3>(map_, vertex_normal_, far) = Vec3(0.0, 0.0, 0.0);
+	incremental_geometry_->set_position(grid_vertex(1, 1), Vec3(1.0, 1.0, 2.0));
+	incremental_geometry_->update();
+	EXPECT_EQ(value<Vec3>(map_, vertex_normal_, far), Vec3(0.0, 0.0, 0.0));
+}
+
+TEST_F(IncrementalGeometryTest, CutEdge)
+{
+	Vertex v = incremental_geometry_->cut_edge(grid_edge(2, 2, 3, 3));
+	incremental_geometry_->set_position(v, Vec3(2.5, 2.5, 0.8));
+	// the position of a new vertex is not set by cut_edge
+	v = incremental_geometry_->cut_edge(grid_edge(0, 0, 1, 0));
+	incremental_geometry_->set_position(
+		v, 0.5 * (value<Vec3>(map_, vertex_position_, grid_vertex(0, 0)) +
+				  value<Vec3>(map_, vertex_position_, grid_vertex(1, 0))));
+	incremental_geometry_->update();
+	expect_up_to_date();
+}
+
+TEST_F(IncrementalGeometryTest, CutFace)
+{
+	// the cut of the diagonal leaves 2 quads, each of them is cut back into triangles
+	Vertex v = incremental_geometry_->cut_edge(grid_edge(4, 4, 5, 5));
+	Dart d1 = v.dart;
+	Dart d2 = phi1(map_, phi2(map_, d1));
+	incremental_geometry_->cut_face(Vertex(d1), Vertex(phi1(map_, phi1(map_, d1))));
+	incremental_geometry_->cut_face(Vertex(d2), Vertex(phi1(map_, phi1(map_, d2))));
+	incremental_geometry_->set_position(v, Vec3(4.5, 4.5, -0.6));
+	incremental_geometry_->update();
+	expect_up_to_date();
+	EXPECT_EQ(nb_cells<Face>(map_), 2u * (GRID_SIZE - 1u) * (GRID_SIZE - 1u) + 2u);
+}
+
+TEST_F(IncrementalGeometryTest, FlipEdge)
+{
+	incremental_geometry_->set_position(grid_vertex(2, 5), Vec3(2.0, 5.0, 1.5));
+	EXPECT_TRUE(incremental_geometry_->flip_edge(grid_edge(3, 3, 4, 4)));
+	EXPECT_TRUE(incremental_geometry_->flip_edge(grid_edge(2, 5, 3, 6)));
+	incremental_geometry_->update();
+	expect_up_to_date();
+}
+
+TEST_F(IncrementalGeometryTest, CollapseEdge)
+{
+	incremental_geometry_->set_position(grid_vertex(4, 2), Vec3(4.0, 2.0, 1.0));
+	Vertex v = incremental_geometry_->collapse_edge(grid_edge(3, 3, 4, 3));
+	incremental_geometry_->set_position(v, Vec3(3.5, 3.0, 0.2));
+	incremental_geometry_->collapse_edge(grid_edge(5, 5, 5, 6));
+	incremental_geometry_->update();
+	expect_up_to_date();
+	EXPECT_EQ(nb_cells<Vertex>(map_), GRID_SIZE * GRID_SIZE - 2u);
+}
+
+} // namespace cgogn
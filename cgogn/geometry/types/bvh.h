@@ -0,0 +1,937 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_TYPES_BVH_H_
+#define CGOGN_GEOMETRY_TYPES_BVH_H_
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/radix_sort.h>
+#include <cgogn/core/utils/span.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/functions/distance.h>
+#include <cgogn/geometry/functions/intersection.h>
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+/**
+ * Bounding volume hierarchy over the faces of a surface mesh.
+ * Faces are fan-triangulated and the triangles are organized in a binary tree of axis aligned boxes.
+ * The hierarchy is built in parallel and can be refitted after the vertices have moved
+ * (the topology of the mesh must not change, otherwise the BVH has to be rebuilt).
+ * Batches of closest point queries are processed in parallel (closest_points).
+ */
+template <typename MESH>
+class BVH
+{
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	static const uint32 LEAF_SIZE = 4u;
+
+	struct Triangle
+	{
+		uint32 face_;		 // index in faces_
+		uint32 vertices_[3]; // indices of the vertices in vertex_position_
+	};
+
+	struct Node
+	{
+		Vec3 bb_min_;
+		Vec3 bb_max_;
+		uint32 first_; // inner node: index of the left child (right child is first_ + 1) - leaf: first triangle
+		uint32 nb_;	   // number of triangles (0 for inner nodes)
+	};
+
+	struct Range
+	{
+		uint32 node_;
+		uint32 begin_;
+		uint32 end_;
+	};
+
+public:
+	struct ClosestPoint
+	{
+		Vec3 point_;
+		Face face_;
+		uint32 vertices_[3]; // indices of the vertices of the triangle (of the fan of face_) that contains point_
+		Vec3 barycentric_;	 // coordinates of point_ in this triangle
+		Scalar distance_;	 // signed if requested (positive on the side the faces normals point to)
+	};
+
+	BVH(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_position)
+		: mesh_(m), vertex_position_(vertex_position), pseudo_normals_valid_(false)
+	{
+		build();
+	}
+
+	inline uint32 nb_faces() const
+	{
+		return uint32(faces_.size());
+	}
+
+	inline uint32 nb_nodes() const
+	{
+		return uint32(nodes_.size());
+	}
+
+	/**
+	 * (re)build the hierarchy from the current faces of the mesh
+	 */
+	void build()
+	{
+		ThreadPool* pool = thread_pool();
+
+		faces_.clear();
+		foreach_cell(mesh_, [&](Face f) -> bool {
+			faces_.push_back(f);
+			return true;
+		});
+		const uint32 nb_faces = uint32(faces_.size());
+
+		// fan triangulation of the faces
+		std::vector<uint32> offsets(nb_faces + 1u);
+		offsets[0] = 0u;
+		pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				uint32 nbv = 0u;
+				foreach_incident_vertex(mesh_, faces_[i], [&](Vertex) -> bool {
+					++nbv;
+					return true;
+				});
+				offsets[i + 1] = nbv > 2u ? nbv - 2u : 0u;
+			}
+		});
+		for (uint32 i = 0u; i < nb_faces; ++i)
+			offsets[i + 1] += offsets[i];
+
+		triangles_.resize(offsets[nb_faces]);
+		pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				uint32 k = 0u;
+				uint32 first_vertex = INVALID_INDEX;
+				uint32 previous_vertex = INVALID_INDEX;
+				foreach_incident_vertex(mesh_, faces_[i], [&](Vertex v) -> bool {
+					uint32 vertex_index = index_of(mesh_, v);
+					if (k == 0u)
+						first_vertex = vertex_index;
+					else if (k > 1u)
+						triangles_[offsets[i] + k - 2u] = {i, {first_vertex, previous_vertex, vertex_index}};
+					previous_vertex = vertex_index;
+					++k;
+					return true;
+				});
+			}
+		});
+		face_offsets_.swap(offsets);
+
+		const uint32 nb_triangles = uint32(triangles_.size());
+		triangles_bb_min_.resize(nb_triangles);
+		triangles_bb_max_.resize(nb_triangles);
+		std::vector<Vec3> centroids(nb_triangles);
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+			{
+				triangle_bounds(t, triangles_bb_min_[t], triangles_bb_max_[t]);
+				centroids[t] = (triangles_bb_min_[t] + triangles_bb_max_[t]) / Scalar(2);
+			}
+		});
+
+		// the top of the tree is built sequentially until there are enough subtrees to keep the workers busy,
+		// these subtrees are then built in parallel in separate node vectors that are finally appended to nodes_
+
+		std::vector<uint32> order(nb_triangles);
+		for (uint32 t = 0u; t < nb_triangles; ++t)
+			order[t] = t;
+
+		nodes_.clear();
+		triangle_position_.clear();
+		pseudo_normals_valid_ = false;
+		if (nb_triangles == 0u)
+			return;
+
+		const uint32 subtree_size = std::max(4u * LEAF_SIZE, nb_triangles / (8u * std::max(1u, pool->nb_workers())));
+		std::vector<Range> subtrees;
+		std::vector<Range> stack;
+		nodes_.push_back(Node());
+		stack.push_back({0u, 0u, nb_triangles});
+		while (!stack.empty())
+		{
+			Range r = stack.back();
+			stack.pop_back();
+			if (r.end_ - r.begin_ <= subtree_size)
+			{
+				subtrees.push_back(r);
+				continue;
+			}
+			uint32 mid = split(order, centroids, nodes_[r.node_], r.begin_, r.end_);
+			nodes_[r.node_].first_ = uint32(nodes_.size());
+			nodes_[r.node_].nb_ = 0u;
+			stack.push_back({uint32(nodes_.size()), r.begin_, mid});
+			stack.push_back({uint32(nodes_.size()) + 1u, mid, r.end_});
+			nodes_.push_back(Node());
+			nodes_.push_back(Node());
+		}
+
+		std::vector<std::vector<Node>> subtrees_nodes(subtrees.size());
+		pool->parallel_for(0u, uint32(subtrees.size()), 1u, [&](uint32 b, uint32 e) {
+			for (uint32 s = b; s < e; ++s)
+				build_subtree(order, centroids, subtrees[s].begin_, subtrees[s].end_, subtrees_nodes[s]);
+		});
+
+		for (uint32 s = 0u, nb = uint32(subtrees.size()); s < nb; ++s)
+		{
+			// local node i > 0 goes to base + i - 1, local root replaces the reserved node
+			const uint32 base = uint32(nodes_.size());
+			std::vector<Node>& local = subtrees_nodes[s];
+			for (Node& n : local)
+			{
+				if (n.nb_ == 0u)
+					n.first_ = base + n.first_ - 1u;
+			}
+			nodes_[subtrees[s].node_] = local[0];
+			nodes_.insert(nodes_.end(), local.begin() + 1, local.end());
+		}
+
+		// triangles are stored in the leaves order
+		std::vector<Triangle> ordered_triangles(nb_triangles);
+		std::vector<Vec3> ordered_bb_min(nb_triangles), ordered_bb_max(nb_triangles);
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+			{
+				ordered_triangles[t] = triangles_[order[t]];
+				ordered_bb_min[t] = triangles_bb_min_[order[t]];
+				ordered_bb_max[t] = triangles_bb_max_[order[t]];
+			}
+		});
+		triangles_.swap(ordered_triangles);
+		triangles_bb_min_.swap(ordered_bb_min);
+		triangles_bb_max_.swap(ordered_bb_max);
+
+		for (std::vector<Scalar>& g : triangles_geometry_)
+			g.resize(nb_triangles);
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+				triangle_geometry(t);
+		});
+		pseudo_normals_valid_ = false;
+
+		triangle_position_.resize(nb_triangles);
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+				triangle_position_[order[t]] = t;
+		});
+	}
+
+	/**
+	 * update the bounding boxes after the vertices have moved
+	 */
+	void refit()
+	{
+		ThreadPool* pool = thread_pool();
+		const uint32 nb_triangles = uint32(triangles_.size());
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+			{
+				triangle_bounds(t, triangles_bb_min_[t], triangles_bb_max_[t]);
+				triangle_geometry(t);
+			}
+		});
+		pseudo_normals_valid_ = false;
+		// children are always stored after their parent
+		for (uint32 i = uint32(nodes_.size()); i-- > 0u;)
+		{
+			Node& n = nodes_[i];
+			if (n.nb_ > 0u)
+				leaf_bounds(n);
+			else
+			{
+				n.bb_min_ = nodes_[n.first_].bb_min_.cwiseMin(nodes_[n.first_ + 1].bb_min_);
+				n.bb_max_ = nodes_[n.first_].bb_max_.cwiseMax(nodes_[n.first_ + 1].bb_max_);
+			}
+		}
+	}
+
+	/**
+	 * compute the closest point to p on the surface
+	 * @param p the query point
+	 * @param closest the closest point
+	 * @param face the face that contains the closest point (optional)
+	 * @return false if the mesh has no face
+	 */
+	bool closest_point(const Vec3& p, Vec3& closest, Face* face = nullptr) const
+	{
+		uint32 t = closest_triangle(p);
+		if (t == INVALID_INDEX)
+			return false;
+
+		Scalar u, v, w;
+		const Vec3& a = position(triangles_[t].vertices_[0]);
+		const Vec3& b = position(triangles_[t].vertices_[1]);
+		const Vec3& c = position(triangles_[t].vertices_[2]);
+		closest_point_in_triangle(p, a, b, c, u, v, w);
+		closest = u * a + v * b + w * c;
+		if (face)
+			*face = faces_[triangles_[t].face_];
+		return true;
+	}
+
+	/**
+	 * compute the closest points to a batch of points (in parallel)
+	 * The points are processed in the order of a space filling curve so that consecutive queries traverse the same
+	 * parts of the hierarchy. The signed distances are only meaningful on closed & consistently oriented surfaces:
+	 * the sign is given by the angle weighted pseudo-normal of the closest feature (face, edge or vertex).
+	 * @param points the query points
+	 * @param results the closest points (same size as points)
+	 * @param signed_distance compute signed distances (otherwise distances are positive)
+	 * @return false if the mesh has no face
+	 */
+	bool closest_points(Span<const Vec3> points, Span<ClosestPoint> results, bool signed_distance = false) const
+	{
+		cgogn_message_assert(points.size() == results.size(), "closest_points: points and results sizes differ");
+		if (nodes_.empty())
+			return false;
+		if (signed_distance)
+			update_pseudo_normals();
+
+		ThreadPool* pool = thread_pool();
+		const uint32 nb_points = points.size();
+
+		// 10 bits per axis Morton codes in the bounding box of the root
+		const Vec3& bb_min = nodes_[0].bb_min_;
+		const Vec3 extent = (nodes_[0].bb_max_ - bb_min).cwiseMax(std::numeric_limits<Scalar>::min());
+		std::vector<uint64> keys(nb_points);
+		std::vector<uint32> order(nb_points);
+		pool->parallel_for(0u, nb_points, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				uint64 code = 0u;
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					Scalar x = std::clamp((points[i][k] - bb_min[k]) / extent[k], Scalar(0), Scalar(1));
+					code |= spread_bits(uint32(x * 1023.0)) << k;
+				}
+				keys[i] = code;
+				order[i] = i;
+			}
+		});
+		radix_sort(keys, order, 30u);
+
+		pool->parallel_for(0u, nb_points, 256u, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				const Vec3& p = points[order[i]];
+				ClosestPoint& r = results[order[i]];
+				const uint32 t = closest_triangle(p);
+				const Triangle& tri = triangles_[t];
+				const Vec3& a = position(tri.vertices_[0]);
+				const Vec3& bp = position(tri.vertices_[1]);
+				const Vec3& c = position(tri.vertices_[2]);
+				closest_point_in_triangle(p, a, bp, c, r.barycentric_[0], r.barycentric_[1], r.barycentric_[2]);
+				r.point_ = r.barycentric_[0] * a + r.barycentric_[1] * bp + r.barycentric_[2] * c;
+				r.face_ = faces_[tri.face_];
+				for (uint32 k = 0; k < 3; ++k)
+					r.vertices_[k] = tri.vertices_[k];
+				r.distance_ = (p - r.point_).norm();
+				if (signed_distance && (p - r.point_).dot(pseudo_normal(t, r.barycentric_)) < Scalar(0))
+					r.distance_ = -r.distance_;
+			}
+		});
+
+		return true;
+	}
+
+	/**
+	 * call func(Face, Vec3 intersection_point, Scalar squared_distance_to_origin) for each face hit by the ray
+	 * (in no particular order, each face is reported once)
+	 */
+	template <typename FUNC>
+	void foreach_face_on_ray(const Vec3& origin, const Vec3& direction, const FUNC& func) const
+	{
+		if (nodes_.empty())
+			return;
+
+		Vec3 inv_direction;
+		for (uint32 i = 0; i < 3; ++i)
+			inv_direction[i] = Scalar(1) / direction[i];
+
+		auto hit = [&](uint32 t, Vec3* I) -> bool {
+			const Triangle& tri = triangles_[t];
+			return intersection_ray_triangle(origin, direction, position(tri.vertices_[0]), position(tri.vertices_[1]),
+											 position(tri.vertices_[2]), I);
+		};
+
+		TraversalStack stack;
+		stack.push(0u);
+		while (!stack.empty())
+		{
+			const Node& n = nodes_[stack.pop()];
+			if (!intersection_ray_box(origin, inv_direction, n.bb_min_, n.bb_max_))
+				continue;
+			if (n.nb_ > 0u)
+			{
+				for (uint32 t = n.first_, end = n.first_ + n.nb_; t < end; ++t)
+				{
+					Vec3 I;
+					if (hit(t, &I) && first_matching_triangle_of_face(t, [&](uint32 ft) { return hit(ft, nullptr); }))
+						func(faces_[triangles_[t].face_], I, (I - origin).squaredNorm());
+				}
+			}
+			else
+			{
+				stack.push(n.first_ + 1);
+				stack.push(n.first_);
+			}
+		}
+	}
+
+	/**
+	 * compute the first intersection of the ray with the surface
+	 * @param origin the origin of the ray
+	 * @param direction the direction of the ray
+	 * @param point the intersection point
+	 * @param face the face that contains the intersection point (optional)
+	 * @param min_distance the intersections that are closer to the origin are ignored
+	 * @return false if the ray does not hit the surface
+	 */
+	bool first_hit(const Vec3& origin, const Vec3& direction, Vec3& point, Face* face = nullptr,
+				   Scalar min_distance = 0) const
+	{
+		if (nodes_.empty())
+			return false;
+
+		Vec3 inv_direction;
+		for (uint32 i = 0; i < 3; ++i)
+			inv_direction[i] = Scalar(1) / direction[i];
+		const Scalar direction_norm = direction.norm();
+		const Scalar min_dist = min_distance * min_distance;
+
+		// squared distance from the origin to the closest intersection found so far
+		Scalar first_dist = std::numeric_limits<Scalar>::max();
+		uint32 first = INVALID_INDEX;
+
+		// distance from the origin to the box entry point (squared)
+		auto entry_dist = [&](const Node& n) -> Scalar {
+			Scalar t;
+			if (!intersection_ray_box(origin, inv_direction, n.bb_min_, n.bb_max_, &t))
+				return std::numeric_limits<Scalar>::max();
+			return t * t * direction_norm * direction_norm;
+		};
+
+		TraversalStack stack;
+		stack.push(0u);
+		while (!stack.empty())
+		{
+			const Node& n = nodes_[stack.pop()];
+			if (entry_dist(n) >= first_dist)
+				continue;
+			if (n.nb_ > 0u)
+			{
+				for (uint32 t = n.first_, end = n.first_ + n.nb_; t < end; ++t)
+				{
+					const Triangle& tri = triangles_[t];
+					Vec3 I;
+					if (intersection_ray_triangle(origin, direction, position(tri.vertices_[0]),
+												  position(tri.vertices_[1]), position(tri.vertices_[2]), &I))
+					{
+						Scalar d = (I - origin).squaredNorm();
+						if (d > min_dist && d < first_dist)
+						{
+							first_dist = d;
+							first = t;
+							point = I;
+						}
+					}
+				}
+			}
+			else
+			{
+				// the nearest child is visited first
+				if (entry_dist(nodes_[n.first_]) < entry_dist(nodes_[n.first_ + 1]))
+				{
+					stack.push(n.first_ + 1);
+					stack.push(n.first_);
+				}
+				else
+				{
+					stack.push(n.first_);
+					stack.push(n.first_ + 1);
+				}
+			}
+		}
+
+		if (first == INVALID_INDEX)
+			return false;
+		if (face)
+			*face = faces_[triangles_[first].face_];
+		return true;
+	}
+
+	/**
+	 * call func(Face) for each face that has a point at a distance smaller than radius from center
+	 */
+	template <typename FUNC>
+	void foreach_face_in_sphere(const Vec3& center, Scalar radius, const FUNC& func) const
+	{
+		static_assert(is_func_parameter_same<FUNC, Face>::value, "Wrong function parameter type");
+		if (nodes_.empty())
+			return;
+
+		const Scalar radius2 = radius * radius;
+		auto inside = [&](uint32 t) -> bool {
+			const Triangle& tri = triangles_[t];
+			return squared_distance_point_triangle(center, position(tri.vertices_[0]), position(tri.vertices_[1]),
+												   position(tri.vertices_[2])) <= radius2;
+		};
+
+		TraversalStack stack;
+		stack.push(0u);
+		while (!stack.empty())
+		{
+			const Node& n = nodes_[stack.pop()];
+			if (squared_distance_box_point(n.bb_min_, n.bb_max_, center) > radius2)
+				continue;
+			if (n.nb_ > 0u)
+			{
+				for (uint32 t = n.first_, end = n.first_ + n.nb_; t < end; ++t)
+				{
+					if (inside(t) && first_matching_triangle_of_face(t, inside))
+						func(faces_[triangles_[t].face_]);
+				}
+			}
+			else
+			{
+				stack.push(n.first_ + 1);
+				stack.push(n.first_);
+			}
+		}
+	}
+
+private:
+	inline const Vec3& position(uint32 vertex_index) const
+	{
+		return (*vertex_position_)[vertex_index];
+	}
+
+	// index (in triangles_) of the triangle closest to p (INVALID_INDEX if there is no triangle)
+	uint32 closest_triangle(const Vec3& p) const
+	{
+		if (nodes_.empty())
+			return INVALID_INDEX;
+
+		Scalar min_dist = std::numeric_limits<Scalar>::max();
+		uint32 closest = INVALID_INDEX;
+
+		TraversalStack stack;
+		stack.push(0u);
+		while (!stack.empty())
+		{
+			const Node& n = nodes_[stack.pop()];
+			if (squared_distance_box_point(n.bb_min_, n.bb_max_, p) >= min_dist)
+				continue;
+			if (n.nb_ > 0u)
+			{
+				Scalar dist[LEAF_SIZE];
+				leaf_squared_distances(p, n.first_, n.nb_, dist);
+				for (uint32 i = 0; i < n.nb_; ++i)
+				{
+					if (dist[i] < min_dist)
+					{
+						min_dist = dist[i];
+						closest = n.first_ + i;
+					}
+				}
+			}
+			else
+			{
+				// the nearest child is visited first
+				const Node& left = nodes_[n.first_];
+				const Node& right = nodes_[n.first_ + 1];
+				if (squared_distance_box_point(left.bb_min_, left.bb_max_, p) <
+					squared_distance_box_point(right.bb_min_, right.bb_max_, p))
+				{
+					stack.push(n.first_ + 1);
+					stack.push(n.first_);
+				}
+				else
+				{
+					stack.push(n.first_);
+					stack.push(n.first_ + 1);
+				}
+			}
+		}
+
+		return closest;
+	}
+
+	// squared distances from p to the nb (<= LEAF_SIZE) triangles starting at first
+	// all the cases (interior & 3 edges) are evaluated & selected without branches so that the loop over the
+	// triangles of the leaf (stored as structure of arrays) can be vectorized
+	inline void leaf_squared_distances(const Vec3& p, uint32 first, uint32 nb, Scalar* dist) const
+	{
+		const Scalar* ax = triangles_geometry_[0].data() + first;
+		const Scalar* ay = triangles_geometry_[1].data() + first;
+		const Scalar* az = triangles_geometry_[2].data() + first;
+		const Scalar* e0x = triangles_geometry_[3].data() + first;
+		const Scalar* e0y = triangles_geometry_[4].data() + first;
+		const Scalar* e0z = triangles_geometry_[5].data() + first;
+		const Scalar* e1x = triangles_geometry_[6].data() + first;
+		const Scalar* e1y = triangles_geometry_[7].data() + first;
+		const Scalar* e1z = triangles_geometry_[8].data() + first;
+		for (uint32 i = 0; i < nb; ++i)
+		{
+			const Scalar dx = ax[i] - p[0];
+			const Scalar dy = ay[i] - p[1];
+			const Scalar dz = az[i] - p[2];
+			const Scalar a = e0x[i] * e0x[i] + e0y[i] * e0y[i] + e0z[i] * e0z[i];
+			const Scalar b = e0x[i] * e1x[i] + e0y[i] * e1y[i] + e0z[i] * e1z[i];
+			const Scalar c = e1x[i] * e1x[i] + e1y[i] * e1y[i] + e1z[i] * e1z[i];
+			const Scalar d = e0x[i] * dx + e0y[i] * dy + e0z[i] * dz;
+			const Scalar e = e1x[i] * dx + e1y[i] * dy + e1z[i] * dz;
+			const Scalar f = dx * dx + dy * dy + dz * dz;
+
+			// interior of the triangle
+			const Scalar det = a * c - b * b;
+			const Scalar s = b * e - c * d;
+			const Scalar t = b * d - a * e;
+			const bool inside = det > Scalar(0) && s >= Scalar(0) && t >= Scalar(0) && s + t <= det;
+			const Scalar inv_det = Scalar(1) / std::max(det, std::numeric_limits<Scalar>::min());
+			const Scalar si = s * inv_det;
+			const Scalar ti = t * inv_det;
+			const Scalar d_in = si * (a * si + b * ti + Scalar(2) * d) + ti * (b * si + c * ti + Scalar(2) * e) + f;
+
+			// edges AB, AC & BC (clamped projections, NaN from degenerated edges clamps to 0)
+			const Scalar u0 = std::min(std::max(Scalar(0), -d / a), Scalar(1));
+			const Scalar d0 = u0 * (a * u0 + Scalar(2) * d) + f;
+			const Scalar u1 = std::min(std::max(Scalar(0), -e / c), Scalar(1));
+			const Scalar d1 = u1 * (c * u1 + Scalar(2) * e) + f;
+			const Scalar a2 = a - Scalar(2) * b + c;
+			const Scalar b2 = e - d + b - a;
+			const Scalar c2 = f + Scalar(2) * d + a;
+			const Scalar u2 = std::min(std::max(Scalar(0), -b2 / a2), Scalar(1));
+			const Scalar d2 = u2 * (a2 * u2 + Scalar(2) * b2) + c2;
+
+			dist[i] = std::max(Scalar(0), inside ? d_in : std::min(d0, std::min(d1, d2)));
+		}
+	}
+
+	// interleaves the 10 lower bits of x with 2 zero bits
+	static inline uint64 spread_bits(uint32 x)
+	{
+		uint64 r = x & 0x3ffu;
+		r = (r | (r << 16)) & 0x30000ffull;
+		r = (r | (r << 8)) & 0x300f00full;
+		r = (r | (r << 4)) & 0x30c30c3ull;
+		r = (r | (r << 2)) & 0x9249249ull;
+		return r;
+	}
+
+	// pseudo-normal of the feature of triangle t that contains the point of barycentric coordinates bc
+	inline Vec3 pseudo_normal(uint32 t, const Vec3& bc) const
+	{
+		const uint32 nb_zeros = uint32(bc[0] == Scalar(0)) + uint32(bc[1] == Scalar(0)) + uint32(bc[2] == Scalar(0));
+		if (nb_zeros == 0u)
+			return triangles_normal_[t];
+		if (nb_zeros == 1u)
+		{
+			// edge k links vertices k & k + 1
+			uint32 k = bc[0] == Scalar(0) ? 1u : (bc[1] == Scalar(0) ? 2u : 0u);
+			return edges_pseudo_normal_[3u * t + k];
+		}
+		uint32 k = bc[0] != Scalar(0) ? 0u : (bc[1] != Scalar(0) ? 1u : 2u);
+		return vertices_pseudo_normal_[triangles_[t].vertices_[k]];
+	}
+
+	void update_pseudo_normals() const
+	{
+		std::lock_guard<std::mutex> lock(pseudo_normals_mutex_);
+		if (pseudo_normals_valid_)
+			return;
+
+		ThreadPool* pool = thread_pool();
+		const uint32 nb_triangles = uint32(triangles_.size());
+
+		uint32 nb_vertices = 0u;
+		for (const Triangle& tri : triangles_)
+			nb_vertices = std::max(nb_vertices, 1u + *std::max_element(tri.vertices_, tri.vertices_ + 3));
+
+		triangles_normal_.resize(nb_triangles);
+		std::vector<std::array<Scalar, 3>> angles(nb_triangles);
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+			{
+				const Triangle& tri = triangles_[t];
+				Vec3 p[3] = {position(tri.vertices_[0]), position(tri.vertices_[1]), position(tri.vertices_[2])};
+				triangles_normal_[t] = (p[1] - p[0]).cross(p[2] - p[0]).normalized();
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					Vec3 u = p[(k + 1) % 3] - p[k];
+					Vec3 v = p[(k + 2) % 3] - p[k];
+					angles[t][k] = std::atan2(u.cross(v).norm(), u.dot(v));
+				}
+			}
+		});
+
+		vertices_pseudo_normal_.assign(nb_vertices, Vec3::Zero());
+		for (uint32 t = 0u; t < nb_triangles; ++t)
+		{
+			for (uint32 k = 0; k < 3; ++k)
+				vertices_pseudo_normal_[triangles_[t].vertices_[k]] += angles[t][k] * triangles_normal_[t];
+		}
+
+		// the (up to 2) triangles that share an edge are found by sorting the edges by their vertices
+		std::vector<uint64> keys(3u * nb_triangles);
+		std::vector<uint32> edges(3u * nb_triangles);
+		pool->parallel_for(0u, nb_triangles, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 t = b; t < e; ++t)
+			{
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					uint64 v0 = triangles_[t].vertices_[k];
+					uint64 v1 = triangles_[t].vertices_[(k + 1) % 3];
+					keys[3u * t + k] = (std::min(v0, v1) << 32) | std::max(v0, v1);
+					edges[3u * t + k] = 3u * t + k;
+				}
+			}
+		});
+		radix_sort(keys, edges, 32u + nb_bits(nb_vertices));
+
+		edges_pseudo_normal_.resize(3u * nb_triangles);
+		for (uint32 i = 0u, nb = uint32(keys.size()); i < nb;)
+		{
+			uint32 j = i + 1u;
+			while (j < nb && keys[j] == keys[i])
+				++j;
+			Vec3 n = Vec3::Zero();
+			for (uint32 k = i; k < j; ++k)
+				n += triangles_normal_[edges[k] / 3u];
+			for (uint32 k = i; k < j; ++k)
+				edges_pseudo_normal_[edges[k]] = n;
+			i = j;
+		}
+
+		pseudo_normals_valid_ = true;
+	}
+
+	inline void triangle_geometry(uint32 t)
+	{
+		const Vec3& a = position(triangles_[t].vertices_[0]);
+		const Vec3 e0 = position(triangles_[t].vertices_[1]) - a;
+		const Vec3 e1 = position(triangles_[t].vertices_[2]) - a;
+		for (uint32 k = 0; k < 3; ++k)
+		{
+			triangles_geometry_[k][t] = a[k];
+			triangles_geometry_[3 + k][t] = e0[k];
+			triangles_geometry_[6 + k][t] = e1[k];
+		}
+	}
+
+	// median splits keep the tree balanced: a depth-first traversal never holds more than depth + 1 nodes
+	struct TraversalStack
+	{
+		uint32 nodes_[64];
+		uint32 size_ = 0u;
+		inline void push(uint32 n)
+		{
+			nodes_[size_++] = n;
+		}
+		inline uint32 pop()
+		{
+			return nodes_[--size_];
+		}
+		inline bool empty() const
+		{
+			return size_ == 0u;
+		}
+	};
+
+	// a polygonal face is reported by the first triangle of its fan that matches the query
+	template <typename PRED>
+	inline bool first_matching_triangle_of_face(uint32 t, const PRED& pred) const
+	{
+		const uint32 face = triangles_[t].face_;
+		if (face_offsets_[face + 1] - face_offsets_[face] == 1u)
+			return true;
+		for (uint32 ft = face_offsets_[face]; triangle_position_[ft] != t; ++ft)
+		{
+			if (pred(triangle_position_[ft]))
+				return false;
+		}
+		return true;
+	}
+
+	static inline Scalar squared_distance_box_point(const Vec3& bb_min, const Vec3& bb_max, const Vec3& p)
+	{
+		return (bb_min - p).cwiseMax(p - bb_max).cwiseMax(Scalar(0)).squaredNorm();
+	}
+
+	// entry receives the ray parameter of the entry point in the box (0 if the origin is inside)
+	static inline bool intersection_ray_box(const Vec3& origin, const Vec3& inv_direction, const Vec3& bb_min,
+											const Vec3& bb_max, Scalar* entry = nullptr)
+	{
+		Scalar tmin = Scalar(0);
+		Scalar tmax = std::numeric_limits<Scalar>::max();
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			Scalar t1 = (bb_min[i] - origin[i]) * inv_direction[i];
+			Scalar t2 = (bb_max[i] - origin[i]) * inv_direction[i];
+			// NaN (origin on a slab plane with a null direction component) keeps the current bounds
+			tmin = std::max(tmin, std::min(t1, t2));
+			tmax = std::min(tmax, std::max(t1, t2));
+		}
+		if (entry)
+			*entry = tmin;
+		return tmin <= tmax;
+	}
+
+	inline void triangle_bounds(uint32 t, Vec3& bb_min, Vec3& bb_max) const
+	{
+		const Vec3& a = position(triangles_[t].vertices_[0]);
+		const Vec3& b = position(triangles_[t].vertices_[1]);
+		const Vec3& c = position(triangles_[t].vertices_[2]);
+		bb_min = a.cwiseMin(b).cwiseMin(c);
+		bb_max = a.cwiseMax(b).cwiseMax(c);
+	}
+
+	inline void leaf_bounds(Node& n) const
+	{
+		n.bb_min_ = triangles_bb_min_[n.first_];
+		n.bb_max_ = triangles_bb_max_[n.first_];
+		for (uint32 t = n.first_ + 1, end = n.first_ + n.nb_; t < end; ++t)
+		{
+			n.bb_min_ = n.bb_min_.cwiseMin(triangles_bb_min_[t]);
+			n.bb_max_ = n.bb_max_.cwiseMax(triangles_bb_max_[t]);
+		}
+	}
+
+	// computes the bounds of node n & splits its triangles range at the median of the largest centroid extent
+	uint32 split(std::vector<uint32>& order, const std::vector<Vec3>& centroids, Node& n, uint32 begin,
+				 uint32 end) const
+	{
+		Vec3 centroids_min = centroids[order[begin]];
+		Vec3 centroids_max = centroids_min;
+		n.bb_min_ = triangles_bb_min_[order[begin]];
+		n.bb_max_ = triangles_bb_max_[order[begin]];
+		for (uint32 i = begin + 1; i < end; ++i)
+		{
+			uint32 t = order[i];
+			n.bb_min_ = n.bb_min_.cwiseMin(triangles_bb_min_[t]);
+			n.bb_max_ = n.bb_max_.cwiseMax(triangles_bb_max_[t]);
+			centroids_min = centroids_min.cwiseMin(centroids[t]);
+			centroids_max = centroids_max.cwiseMax(centroids[t]);
+		}
+		Vec3 extent = centroids_max - centroids_min;
+		uint32 axis = 0u;
+		if (extent[1] > extent[axis])
+			axis = 1u;
+		if (extent[2] > extent[axis])
+			axis = 2u;
+
+		uint32 mid = begin + (end - begin) / 2u;
+		std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+						 [&](uint32 t1, uint32 t2) { return centroids[t1][axis] < centroids[t2][axis]; });
+		return mid;
+	}
+
+	void build_subtree(std::vector<uint32>& order, const std::vector<Vec3>& centroids, uint32 begin, uint32 end,
+					   std::vector<Node>& nodes) const
+	{
+		std::vector<Range> stack;
+		nodes.push_back(Node());
+		stack.push_back({0u, begin, end});
+		while (!stack.empty())
+		{
+			Range r = stack.back();
+			stack.pop_back();
+			if (r.end_ - r.begin_ <= LEAF_SIZE)
+			{
+				Node& n = nodes[r.node_];
+				n.first_ = r.begin_;
+				n.nb_ = r.end_ - r.begin_;
+				// triangles are not yet reordered: compute bounds from the order
+				n.bb_min_ = triangles_bb_min_[order[r.begin_]];
+				n.bb_max_ = triangles_bb_max_[order[r.begin_]];
+				for (uint32 i = r.begin_ + 1; i < r.end_; ++i)
+				{
+					n.bb_min_ = n.bb_min_.cwiseMin(triangles_bb_min_[order[i]]);
+					n.bb_max_ = n.bb_max_.cwiseMax(triangles_bb_max_[order[i]]);
+				}
+				continue;
+			}
+			uint32 mid = split(order, centroids, nodes[r.node_], r.begin_, r.end_);
+			nodes[r.node_].first_ = uint32(nodes.size());
+			nodes[r.node_].nb_ = 0u;
+			stack.push_back({uint32(nodes.size()), r.begin_, mid});
+			stack.push_back({uint32(nodes.size()) + 1u, mid, r.end_});
+			nodes.push_back(Node());
+			nodes.push_back(Node());
+		}
+	}
+
+	const MESH& mesh_;
+	std::shared_ptr<Attribute<Vec3>> vertex_position_;
+
+	std::vector<Face> faces_;
+	std::vector<uint32> face_offsets_; // face -> range of its triangles (before reordering)
+	std::vector<uint32> triangle_position_; // triangle (before reordering) -> position in triangles_
+	std::vector<Triangle> triangles_;
+	std::vector<Vec3> triangles_bb_min_;
+	std::vector<Vec3> triangles_bb_max_;
+	// vertex a & edges b - a, c - a of the triangles (x, y, z components in separate arrays)
+	std::array<std::vector<Scalar>, 9> triangles_geometry_;
+	std::vector<Node> nodes_;
+
+	// computed on demand for the signed distances
+	mutable std::mutex pseudo_normals_mutex_;
+	mutable bool pseudo_normals_valid_;
+	mutable std::vector<Vec3> triangles_normal_;
+	mutable std::vector<Vec3> edges_pseudo_normal_; // 3 per triangle, edge k links vertices k & k + 1
+	mutable std::vector<Vec3> vertices_pseudo_normal_;
+};
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_TYPES_BVH_H_
@@ -24,130 +24,630 @@
 #ifndef CGOGN_GEOMETRY_TYPES_GRID_H_
 #define CGOGN_GEOMETRY_TYPES_GRID_H_
 
-#include <cgogn/core/functions/traversals/face.h>
+#include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
 
-#include <cgogn/geometry/functions/bounding_box.h>
+#include <cgogn/geometry/functions/distance.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace cgogn
 {
 
 namespace geometry
 {
 
-template <uint32 I, uint32 J, uint32 K, typename MESH>
+/**
+ * Sparse uniform grid over the cells (vertices, edges, faces, ...) of a mesh.
+ * The resolution is chosen at runtime & only the non-empty grid cells are stored: the grid cells are hashed into a
+ * table whose buckets are stored contiguously (CSR layout). The buckets are filled in parallel in two passes
+ * (count, then scatter). A mesh cell is registered in all the grid cells overlapped by its bounding box.
+ * Mesh cells that move or are created after the build are handled incrementally (update, remove): they are stored in
+ * a small overflow table until it gets too large & the buckets are rebuilt.
+ * The queries are const & can be run concurrently.
+ * closest_point_on_surface has a Grid overload; within_sphere, picking & shrinking_ball_centers do not use the grid
+ * (see their documentation).
+ */
+template <typename MESH, typename CELL = typename mesh_traits<MESH>::Face>
 class Grid
 {
 	template <typename T>
 	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
 	using Vertex = typename mesh_traits<MESH>::Vertex;
-	using Face = typename mesh_traits<MESH>::Face;
+
+	using CellCoord = std::array<int32, 3>;
+
+	struct ElementCells
+	{
+		CellCoord min_;
+		CellCoord max_;
+	};
 
 public:
-	Grid(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_position)
-		: mesh_(m), vertex_position_(vertex_position), nb_registered_faces_(0)
-	{
-		std::tie(bb_min_, bb_max_) = bounding_box(*vertex_position_);
-		Vec3 center = (bb_min_ + bb_max_) / Scalar(2);
-		bb_min_ = ((bb_min_ - center) * 1.1) + center;
-		bb_max_ = ((bb_max_ - center) * 1.1) + center;
-		bb_size_ = bb_max_ - bb_min_;
-
-		foreach_cell(mesh_, [&](Face f) {
-			++nb_registered_faces_;
-			Vec3 face_bb_min, face_bb_max;
+	/**
+	 * @param m the mesh
+	 * @param vertex_position the position of the vertices
+	 * @param cell_size the size of the grid cells (automatically chosen from the size of the mesh cells if <= 0)
+	 */
+	Grid(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_position, Scalar cell_size = 0)
+		: mesh_(m), vertex_position_(vertex_position), cell_size_(cell_size), dart_keys_(!is_indexed<CELL>(m))
+	{
+		build();
+	}
+
+	inline Scalar cell_size() const
+	{
+		return cell_size_;
+	}
+
+	inline uint32 nb_elements() const
+	{
+		return nb_elements_;
+	}
+
+	/**
+	 * (re)build the grid from the current cells of the mesh
+	 */
+	void build()
+	{
+		elements_.clear();
+		foreach_cell(mesh_, [&](CELL c) -> bool {
+			elements_.push_back(c);
+			return true;
+		});
+		const uint32 nb = uint32(elements_.size());
+
+		elements_bb_min_.resize(nb);
+		elements_bb_max_.resize(nb);
+		thread_pool()->parallel_for(0u, nb, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+				element_bounds(elements_[i], elements_bb_min_[i], elements_bb_max_[i]);
+		});
+
+		if (cell_size_ <= 0 && nb > 0u)
+			cell_size_ = automatic_cell_size();
+		if (cell_size_ <= 0)
+			cell_size_ = 1;
+
+		element_id_.clear();
+		version_.assign(nb, 0u);
+		for (uint32 i = 0u; i < nb; ++i)
+			set_element_id(elements_[i], i);
+
+		fill_buckets();
+	}
+
+	/**
+	 * register c again after its geometry changed, or register it if it has been created after the build
+	 */
+	void update(CELL c)
+	{
+		uint32 id = registered_element_id(c);
+		if (id == INVALID_INDEX)
+		{
+			id = uint32(elements_.size());
+			elements_.push_back(c);
+			elements_bb_min_.push_back(Vec3());
+			elements_bb_max_.push_back(Vec3());
+			version_.push_back(0u);
+			++nb_elements_;
+		}
+		elements_[id] = c;
+		set_element_id(c, id);
+		// the entries that refer to a previous version of the element are ignored by the queries
+		++version_[id];
+		element_bounds(c, elements_bb_min_[id], elements_bb_max_[id]);
+		ElementCells ec = element_cells(id);
+		std::vector<uint32> buckets;
+		foreach_grid_cell(ec.min_, ec.max_, [&](const CellCoord& cc) { buckets.push_back(bucket(cc)); });
+		std::sort(buckets.begin(), buckets.end());
+		buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+		for (uint32 b : buckets)
+			overflow_[b].push_back({id, version_[id]});
+		nb_overflow_entries_ += uint32(buckets.size());
+		extend_bounds(id);
+
+		if (nb_overflow_entries_ > std::max(1024u, uint32(entries_.size()) / 4u))
+			compact();
+	}
+
+	/**
+	 * unregister c (to call before c is removed from the mesh)
+	 */
+	void remove(CELL c)
+	{
+		uint32 id = registered_element_id(c);
+		if (id == INVALID_INDEX)
+			return;
+		++version_[id];
+		removed_.push_back(id);
+		set_element_id(c, INVALID_INDEX);
+		--nb_elements_;
+	}
+
+	/**
+	 * call func(CELL, Scalar squared_distance) for each registered cell that has a point at a distance smaller than
+	 * radius from center (each cell is reported once)
+	 */
+	template <typename FUNC>
+	void foreach_in_sphere(const Vec3& center, Scalar radius, const FUNC& func) const
+	{
+		foreach_element_in_sphere(center, radius, [&](uint32 id, Scalar d2) { func(elements_[id], d2); });
+	}
+
+	/**
+	 * compute the k registered cells closest to p (sorted by increasing distance)
+	 * @return the cells & their squared distance to p (less than k if there are less than k registered cells)
+	 */
+	std::vector<std::pair<CELL, Scalar>> k_nearest(const Vec3& p, uint32 k) const
+	{
+		std::vector<std::pair<uint32, Scalar>> nearest = nearest_elements(p, k);
+		std::vector<std::pair<CELL, Scalar>> result;
+		result.reserve(nearest.size());
+		for (const std::pair<uint32, Scalar>& n : nearest)
+			result.push_back({elements_[n.first], n.second});
+		return result;
+	}
+
+	/**
+	 * compute the closest point to p on the registered cells
+	 * @param p the query point
+	 * @param closest the closest point
+	 * @param cell the cell that contains the closest point (optional)
+	 * @return false if no cell is registered
+	 */
+	bool closest_point(const Vec3& p, Vec3& closest, CELL* cell = nullptr) const
+	{
+		std::vector<std::pair<uint32, Scalar>> nearest = nearest_elements(p, 1u);
+		if (nearest.empty())
+			return false;
+		closest = closest_point(nearest[0].first, p);
+		if (cell)
+			*cell = elements_[nearest[0].first];
+		return true;
+	}
+
+	/**
+	 * rebuild the buckets from the registered cells (without traversing the mesh)
+	 */
+	void compact()
+	{
+		std::sort(removed_.begin(), removed_.end());
+		removed_.erase(std::unique(removed_.begin(), removed_.end()), removed_.end());
+		uint32 nb = 0u;
+		for (uint32 id = 0u, r = 0u, end = uint32(elements_.size()); id < end; ++id)
+		{
+			if (r < uint32(removed_.size()) && removed_[r] == id)
+			{
+				++r;
+				continue;
+			}
+			elements_[nb] = elements_[id];
+			elements_bb_min_[nb] = elements_bb_min_[id];
+			elements_bb_max_[nb] = elements_bb_max_[id];
+			set_element_id(elements_[nb], nb);
+			++nb;
+		}
+		elements_.resize(nb);
+		elements_bb_min_.resize(nb);
+		elements_bb_max_.resize(nb);
+		version_.assign(nb, 0u);
+		fill_buckets();
+	}
+
+private:
+	inline CellCoord cell_coord(const Vec3& p) const
+	{
+		return {int32(std::floor(p[0] / cell_size_)), int32(std::floor(p[1] / cell_size_)),
+				int32(std::floor(p[2] / cell_size_))};
+	}
+
+	inline ElementCells element_cells(uint32 id) const
+	{
+		return {cell_coord(elements_bb_min_[id]), cell_coord(elements_bb_max_[id])};
+	}
+
+	inline uint32 bucket(const CellCoord& cc) const
+	{
+		return ((uint32(cc[0]) * 73856093u) ^ (uint32(cc[1]) * 19349663u) ^ (uint32(cc[2]) * 83492791u)) &
+			   (nb_buckets_ - 1u);
+	}
+
+	template <typename FUNC>
+	static inline void foreach_grid_cell(const CellCoord& cmin, const CellCoord& cmax, const FUNC& func)
+	{
+		for (int32 i = cmin[0]; i <= cmax[0]; ++i)
+			for (int32 j = cmin[1]; j <= cmax[1]; ++j)
+				for (int32 k = cmin[2]; k <= cmax[2]; ++k)
+					func(CellCoord{i, j, k});
+	}
+
+	// calls func(id) once for each element registered in a grid cell of the box [qmin, qmax]
+	// an element is reported from the first grid cell of its intersection with the box, which also filters
+	// the elements that are in the same bucket because of a hash collision
+	template <typename FUNC>
+	void foreach_element_in_box(const CellCoord& qmin, const CellCoord& qmax, const FUNC& func) const
+	{
+		if (nb_buckets_ == 0u)
+			return;
+		// clamp the box to the cells that contain elements
+		const CellCoord gmin = cell_coord(bb_min_);
+		const CellCoord gmax = cell_coord(bb_max_);
+		CellCoord cmin, cmax;
+		uint64 nb_grid_cells = 1u;
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			cmin[i] = std::max(qmin[i], gmin[i]);
+			cmax[i] = std::min(qmax[i], gmax[i]);
+			if (cmin[i] > cmax[i])
+				return;
+			nb_grid_cells *= uint64(int64(cmax[i]) - cmin[i] + 1);
+		}
+
+		// the grid cells of the bounds are mostly empty when the elements lie on a surface or a curve:
+		// once the box has more grid cells than there are entries, the elements are scanned directly
+		if (nb_grid_cells > uint64(entries_.size()) + nb_overflow_entries_)
+		{
+			std::vector<bool> removed(elements_.size(), false);
+			for (uint32 id : removed_)
+				removed[id] = true;
+			for (uint32 id = 0u, end = uint32(elements_.size()); id < end; ++id)
+			{
+				if (removed[id])
+					continue;
+				ElementCells ec = element_cells(id);
+				bool overlaps = true;
+				for (uint32 i = 0; i < 3 && overlaps; ++i)
+					overlaps = ec.min_[i] <= cmax[i] && ec.max_[i] >= cmin[i];
+				if (overlaps)
+					func(id);
+			}
+			return;
+		}
+
+		auto visit = [&](uint32 id, const CellCoord& cc) {
+			ElementCells ec = element_cells(id);
 			for (uint32 i = 0; i < 3; ++i)
 			{
-				face_bb_min[i] = std::numeric_limits<float64>::max();
-				face_bb_max[i] = std::numeric_limits<float64>::lowest();
+				if (cc[i] < ec.min_[i] || cc[i] > ec.max_[i] || cc[i] != std::max(ec.min_[i], cmin[i]))
+					return;
 			}
-			foreach_incident_vertex(mesh_, f, [&](Vertex v) {
-				const Vec3& p = value<Vec3>(mesh_, vertex_position_, v);
-				for (uint32 i = 0; i < 3; ++i)
+			func(id);
+		};
+		foreach_grid_cell(cmin, cmax, [&](const CellCoord& cc) {
+			const uint32 b = bucket(cc);
+			for (uint32 e = bucket_offsets_[b], end = bucket_offsets_[b + 1]; e < end; ++e)
+			{
+				// the entries of an element that overlaps colliding grid cells are consecutive in the sorted bucket
+				if (version_[entries_[e]] == 0u && (e == bucket_offsets_[b] || entries_[e] != entries_[e - 1]))
+					visit(entries_[e], cc);
+			}
+			if (nb_overflow_entries_ > 0u)
+			{
+				auto it = overflow_.find(b);
+				if (it != overflow_.end())
 				{
-					if (p[i] < face_bb_min[i])
-						face_bb_min[i] = p[i];
-					if (p[i] > face_bb_max[i])
-						face_bb_max[i] = p[i];
+					for (const std::pair<uint32, uint32>& oe : it->second)
+					{
+						if (version_[oe.first] == oe.second)
+							visit(oe.first, cc);
+					}
+				}
+			}
+		});
+	}
+
+	template <typename FUNC>
+	void foreach_element_in_sphere(const Vec3& center, Scalar radius, const FUNC& func) const
+	{
+		const Scalar radius2 = radius * radius;
+		const CellCoord qmin = cell_coord(center - Vec3::Constant(radius));
+		const CellCoord qmax = cell_coord(center + Vec3::Constant(radius));
+		foreach_element_in_box(qmin, qmax, [&](uint32 id) {
+			if (squared_distance_box_point(elements_bb_min_[id], elements_bb_max_[id], center) > radius2)
+				return;
+			Scalar d2 = (closest_point(id, center) - center).squaredNorm();
+			if (d2 <= radius2)
+				func(id, d2);
+		});
+	}
+
+	std::vector<std::pair<uint32, Scalar>> nearest_elements(const Vec3& p, uint32 k) const
+	{
+		std::vector<std::pair<uint32, Scalar>> result;
+		if (k == 0u || nb_elements_ == 0u)
+			return result;
+
+		// the ties are broken by element id: the result does not depend on the order of the traversal
+		auto closer = [](const std::pair<uint32, Scalar>& a, const std::pair<uint32, Scalar>& b) {
+			return a.second < b.second || (a.second == b.second && a.first < b.first);
+		};
+
+		// the search radius is doubled until it contains k elements (or all the elements)
+		// the k closest elements found so far are kept in a heap (the farthest on top): the elements whose bounding
+		// box is farther than the top are skipped without computing their distance
+		const Scalar max_radius = (bb_min_ - p).cwiseAbs().cwiseMax((bb_max_ - p).cwiseAbs()).norm();
+		Scalar radius = cell_size_;
+		while (true)
+		{
+			result.clear();
+			const Scalar radius2 = radius * radius;
+			const CellCoord qmin = cell_coord(p - Vec3::Constant(radius));
+			const CellCoord qmax = cell_coord(p + Vec3::Constant(radius));
+			foreach_element_in_box(qmin, qmax, [&](uint32 id) {
+				const Scalar bd2 = squared_distance_box_point(elements_bb_min_[id], elements_bb_max_[id], p);
+				if (bd2 > radius2 || (uint32(result.size()) == k && bd2 > result.front().second))
+					return;
+				const std::pair<uint32, Scalar> n{id, (closest_point(id, p) - p).squaredNorm()};
+				if (n.second > radius2)
+					return;
+				if (uint32(result.size()) < k)
+				{
+					result.push_back(n);
+					std::push_heap(result.begin(), result.end(), closer);
+				}
+				else if (closer(n, result.front()))
+				{
+					std::pop_heap(result.begin(), result.end(), closer);
+					result.back() = n;
+					std::push_heap(result.begin(), result.end(), closer);
 				}
-				return true;
 			});
-			Vec3i fmin = point_cell_coord(face_bb_min);
-			Vec3i fmax = point_cell_coord(face_bb_max);
-			for (uint32 i = fmin[0]; i <= fmax[0]; ++i)
-				for (uint32 j = fmin[1]; j <= fmax[1]; ++j)
-					for (uint32 k = fmin[2]; k <= fmax[2]; ++k)
-						cells_[i][j][k].push_back(f);
-			return true;
+			if (uint32(result.size()) >= k || radius > max_radius)
+				break;
+			radius *= 2;
+		}
+		std::sort_heap(result.begin(), result.end(), closer);
+		return result;
+	}
+
+	// two passes parallel fill of the buckets from the registered elements
+	void fill_buckets()
+	{
+		ThreadPool* pool = thread_pool();
+		const uint32 nb = uint32(elements_.size());
+		nb_elements_ = nb;
+		overflow_.clear();
+		nb_overflow_entries_ = 0u;
+		removed_.clear();
+
+		bb_min_ = Vec3::Constant(std::numeric_limits<Scalar>::max());
+		bb_max_ = Vec3::Constant(std::numeric_limits<Scalar>::lowest());
+		for (uint32 id = 0u; id < nb; ++id)
+			extend_bounds(id);
+
+		std::vector<uint32> nb_element_cells(nb);
+		pool->parallel_for(0u, nb, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 id = b; id < e; ++id)
+			{
+				ElementCells ec = element_cells(id);
+				nb_element_cells[id] =
+					uint32(ec.max_[0] - ec.min_[0] + 1) * (ec.max_[1] - ec.min_[1] + 1) * (ec.max_[2] - ec.min_[2] + 1);
+			}
+		});
+		uint64 nb_entries = 0u;
+		for (uint32 n : nb_element_cells)
+			nb_entries += n;
+
+		nb_buckets_ = 16u;
+		while (nb_buckets_ < nb_entries)
+			nb_buckets_ *= 2u;
+
+		std::vector<std::atomic<uint32>> counts(nb_buckets_);
+		for (std::atomic<uint32>& c : counts)
+			c.store(0u, std::memory_order_relaxed);
+		pool->parallel_for(0u, nb, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 id = b; id < e; ++id)
+			{
+				ElementCells ec = element_cells(id);
+				foreach_grid_cell(ec.min_, ec.max_, [&](const CellCoord& cc) {
+					counts[bucket(cc)].fetch_add(1u, std::memory_order_relaxed);
+				});
+			}
+		});
+
+		bucket_offsets_.resize(nb_buckets_ + 1u);
+		bucket_offsets_[0] = 0u;
+		for (uint32 b = 0u; b < nb_buckets_; ++b)
+		{
+			bucket_offsets_[b + 1] = bucket_offsets_[b] + counts[b].load(std::memory_order_relaxed);
+			counts[b].store(bucket_offsets_[b], std::memory_order_relaxed);
+		}
+
+		entries_.resize(nb_entries);
+		pool->parallel_for(0u, nb, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 id = b; id < e; ++id)
+			{
+				ElementCells ec = element_cells(id);
+				foreach_grid_cell(ec.min_, ec.max_, [&](const CellCoord& cc) {
+					entries_[counts[bucket(cc)].fetch_add(1u, std::memory_order_relaxed)] = id;
+				});
+			}
+		});
+
+		// the scatter order depends on the scheduling: the buckets are sorted for reproducible traversals
+		pool->parallel_for(0u, nb_buckets_, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 bk = b; bk < e; ++bk)
+				std::sort(entries_.begin() + bucket_offsets_[bk], entries_.begin() + bucket_offsets_[bk + 1]);
 		});
 	}
 
-	Vec3i point_cell_coord(const Vec3& p) const
+	inline void extend_bounds(uint32 id)
 	{
-		Vec3 coord = ((p - bb_min_).array() / bb_size_.array());
-		return {int(coord[0] * I), int(coord[1] * J), int(coord[2] * K)};
+		bb_min_ = bb_min_.cwiseMin(elements_bb_min_[id]);
+		bb_max_ = bb_max_.cwiseMax(elements_bb_max_[id]);
 	}
 
-	template <typename FUNC>
-	void foreach_face_at(const Vec3& p, const FUNC& func) const
+	// cells whose mean extent is the size of the mesh cells (or holds a few vertices)
+	Scalar automatic_cell_size() const
 	{
-		static_assert(is_func_parameter_same<FUNC, Face>::value, "Wrong function parameter type");
-		Vec3i coord = point_cell_coord(p);
-		for (Face f : cells_[coord[0]][coord[1]][coord[2]])
-			func(f);
+		const uint32 nb = uint32(elements_.size());
+		Vec3 bb_min = Vec3::Constant(std::numeric_limits<Scalar>::max());
+		Vec3 bb_max = Vec3::Constant(std::numeric_limits<Scalar>::lowest());
+		Scalar mean_extent = 0;
+		for (uint32 id = 0u; id < nb; ++id)
+		{
+			bb_min = bb_min.cwiseMin(elements_bb_min_[id]);
+			bb_max = bb_max.cwiseMax(elements_bb_max_[id]);
+			mean_extent += (elements_bb_max_[id] - elements_bb_min_[id]).maxCoeff();
+		}
+		mean_extent /= Scalar(nb);
+		// for points: the size of the cells that would hold 2 points if they were evenly spread in the volume
+		Vec3 extent = (bb_max - bb_min).cwiseMax(Scalar(1e-3) * (bb_max - bb_min).maxCoeff());
+		Scalar point_size = std::cbrt(Scalar(2) * extent[0] * extent[1] * extent[2] / Scalar(nb));
+		return std::max(mean_extent, point_size);
 	}
 
-	template <typename FUNC>
-	void foreach_face_around(const Vec3& p, const FUNC& func) const
+	inline void element_bounds(CELL c, Vec3& bb_min, Vec3& bb_max) const
 	{
-		static_assert(is_func_parameter_same<FUNC, Face>::value, "Wrong function parameter type");
-		if (nb_registered_faces_ == 0)
-			return;
-		Vec3i coord = point_cell_coord(p);
-		bool all_empty = true;
-		std::array<int, 3> start{coord[0] > 0 ? coord[0] - 1 : 0, coord[1] > 0 ? coord[1] - 1 : 0,
-								 coord[2] > 0 ? coord[2] - 1 : 0};
-		std::array<int, 3> end{coord[0] < I - 1 ? coord[0] + 1 : int(I - 1),
-							   coord[1] < J - 1 ? coord[1] + 1 : int(J - 1),
-							   coord[2] < K - 1 ? coord[2] + 1 : int(K - 1)};
-		for (int i = start[0]; i <= end[0]; ++i)
-			for (int j = start[1]; j <= end[1]; ++j)
-				for (int k = start[2]; k <= end[2]; ++k)
+		if constexpr (std::is_same_v<CELL, Vertex>)
+		{
+			bb_min = value<Vec3>(mesh_, vertex_position_, c);
+			bb_max = bb_min;
+		}
+		else
+		{
+			bb_min = Vec3::Constant(std::numeric_limits<Scalar>::max());
+			bb_max = Vec3::Constant(std::numeric_limits<Scalar>::lowest());
+			foreach_incident_vertex(mesh_, c, [&](Vertex v) -> bool {
+				const Vec3& p = value<Vec3>(mesh_, vertex_position_, v);
+				bb_min = bb_min.cwiseMin(p);
+				bb_max = bb_max.cwiseMax(p);
+				return true;
+			});
+		}
+	}
+
+	// closest point to p on the element:
+	// vertices & edges are exact, faces are fan triangulated & other cells are approximated by their bounding box
+	Vec3 closest_point(uint32 id, const Vec3& p) const
+	{
+		CELL c = elements_[id];
+		if constexpr (std::is_same_v<CELL, Vertex>)
+			return value<Vec3>(mesh_, vertex_position_, c);
+		else if constexpr (std::is_same_v<CELL, typename mesh_traits<MESH>::Edge>)
+		{
+			auto vertices = incident_vertices(mesh_, c);
+			const Vec3& a = value<Vec3>(mesh_, vertex_position_, vertices[0]);
+			const Vec3 ab = value<Vec3>(mesh_, vertex_position_, vertices[1]) - a;
+			const Scalar ab2 = ab.squaredNorm();
+			const Scalar t = ab2 > 0 ? std::clamp((p - a).dot(ab) / ab2, Scalar(0), Scalar(1)) : Scalar(0);
+			return a + t * ab;
+		}
+		else if constexpr (std::is_same_v<CELL, typename mesh_traits<MESH>::Face>)
+		{
+			auto vertices = incident_vertices(mesh_, c);
+			const Vec3& a = value<Vec3>(mesh_, vertex_position_, vertices[0]);
+			Vec3 closest = a;
+			Scalar min_dist = std::numeric_limits<Scalar>::max();
+			for (uint32 i = 1, nb = uint32(vertices.size()); i + 1 < nb; ++i)
+			{
+				const Vec3& b = value<Vec3>(mesh_, vertex_position_, vertices[i]);
+				const Vec3& cp = value<Vec3>(mesh_, vertex_position_, vertices[i + 1]);
+				Scalar u, v, w;
+				closest_point_in_triangle(p, a, b, cp, u, v, w);
+				Vec3 q = u * a + v * b + w * cp;
+				Scalar d = (q - p).squaredNorm();
+				if (d < min_dist)
 				{
-					if (cells_[i][j][k].size() > 0)
-						all_empty = false;
-					for (Face f : cells_[i][j][k])
-						func(f);
+					min_dist = d;
+					closest = q;
 				}
+			}
+			return closest;
+		}
+		else
+			return p.cwiseMax(elements_bb_min_[id]).cwiseMin(elements_bb_max_[id]);
+	}
+
+	static inline Scalar squared_distance_box_point(const Vec3& bb_min, const Vec3& bb_max, const Vec3& p)
+	{
+		return (bb_min - p).cwiseMax(p - bb_max).cwiseMax(Scalar(0)).squaredNorm();
+	}
+
+	inline uint32 element_id(uint32 key) const
+	{
+		return key < uint32(element_id_.size()) ? element_id_[key] : INVALID_INDEX;
+	}
 
-		while (all_empty)
+	// the elements are identified by their cell index, or by their darts if the cells are not indexed
+	// with dart keys, the darts of a split cell still refer to the element of the cell they belonged to:
+	// the element of c is the one whose representative dart is in c
+	inline uint32 registered_element_id(CELL c) const
+	{
+		if constexpr (std::is_convertible_v<MESH&, CMapBase&>)
 		{
-			start = {start[0] > 0 ? start[0] - 1 : 0, start[1] > 0 ? start[1] - 1 : 0, start[2] > 0 ? start[2] - 1 : 0};
-			end = {end[0] < I - 1 ? end[0] + 1 : int(I - 1), end[1] < J - 1 ? end[1] + 1 : int(J - 1),
-				   end[2] < K - 1 ? end[2] + 1 : int(K - 1)};
-			for (int i = start[0]; i <= end[0]; ++i)
-				for (int j = start[1]; j <= end[1]; ++j)
-					for (int k = start[2]; k <= end[2]; ++k)
-					{
-						if (i == start[0] || i == end[0] || j == start[1] || j == end[1] || k == start[2] ||
-							k == end[2])
-						{
-							if (cells_[i][j][k].size() > 0)
-								all_empty = false;
-							for (Face f : cells_[i][j][k])
-								func(f);
-						}
-					}
+			if (dart_keys_)
+			{
+				uint32 id = INVALID_INDEX;
+				foreach_dart_of_orbit(mesh_, c, [&](Dart d) -> bool {
+					uint32 did = element_id(d.index);
+					if (did != INVALID_INDEX && elements_[did].dart == d)
+						id = did;
+					return id == INVALID_INDEX;
+				});
+				return id;
+			}
 		}
+		return element_id(index_of(mesh_, c));
+	}
+
+	inline void set_element_id(CELL c, uint32 id)
+	{
+		if constexpr (std::is_convertible_v<MESH&, CMapBase&>)
+		{
+			if (dart_keys_)
+			{
+				foreach_dart_of_orbit(mesh_, c, [&](Dart d) -> bool {
+					set_element_id(d.index, id);
+					return true;
+				});
+				return;
+			}
+		}
+		set_element_id(index_of(mesh_, c), id);
+	}
+
+	inline void set_element_id(uint32 key, uint32 id)
+	{
+		if (key >= uint32(element_id_.size()))
+			element_id_.resize(key + 1u, INVALID_INDEX);
+		element_id_[key] = id;
 	}
 
-private:
 	const MESH& mesh_;
 	std::shared_ptr<Attribute<Vec3>> vertex_position_;
-	Vec3 bb_min_, bb_max_, bb_size_;
-	std::vector<Face> cells_[I][J][K];
-	uint32 nb_registered_faces_;
+	Scalar cell_size_;
+	bool dart_keys_;
+
+	std::vector<CELL> elements_;
+	std::vector<Vec3> elements_bb_min_;
+	std::vector<Vec3> elements_bb_max_;
+	std::vector<uint32> element_id_; // cell (or dart) index -> element id
+	std::vector<uint32> version_;	 // 0 while the element is in the buckets it has been registered in by the build
+	std::vector<uint32> removed_;
+	uint32 nb_elements_ = 0u;
+	Vec3 bb_min_, bb_max_; // bounds of the elements
+
+	uint32 nb_buckets_ = 0u;
+	std::vector<uint32> bucket_offsets_;
+	std::vector<uint32> entries_;
+
+	// bucket -> (element id, version) of the elements updated since the last build
+	std::unordered_map<uint32, std::vector<std::pair<uint32, uint32>>> overflow_;
+	uint32 nb_overflow_entries_ = 0u;
 };
 
 } // namespace geometry
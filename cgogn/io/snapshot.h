@@ -0,0 +1,432 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+
+#ifndef CGOGN_IO_SNAPSHOT_H_
+#define CGOGN_IO_SNAPSHOT_H_
+
+#include <cgogn/io/utils.h>
+
+#include <cgogn/core/functions/cells.h>
+#include <cgogn/core/types/cmap/cmap_base.h>
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+/**
+ * Binary snapshots of maps: darts, relations, cells indexing and every attribute of a supported type are saved
+ * as raw arrays so that loading is a plain copy from the (memory-mapped) file without any topology
+ * reconstruction. The data is stored in the native byte order: a snapshot is meant to be reloaded on the
+ * same architecture.
+ *
+ * Layout: magic, version, byte order mark, mesh name, dart container, boundary marker, indexed orbits,
+ * then the container of each indexed orbit. A container is its reference counters followed by its attributes
+ * (name, type name, values of [0, maximum_index)).
+ */
+
+namespace internal
+{
+
+static const char SNAPSHOT_MAGIC[8] = {'C', 'G', 'O', 'G', 'N', 'M', 'A', 'P'};
+static const uint32 SNAPSHOT_VERSION = 1u;
+static const uint32 SNAPSHOT_BYTE_ORDER_MARK = 0x01020304u;
+
+// attribute types that can be saved in a snapshot
+using SnapshotTypes = std::tuple<bool, int8, uint8, int16, uint16, int32, uint32, int64, uint64, float32, float64, Dart,
+								 geometry::Vec2i, geometry::Vec3i, geometry::Vec4i, geometry::Vec2f, geometry::Vec3f,
+								 geometry::Vec4f, geometry::Vec2d, geometry::Vec3d, geometry::Vec4d>;
+static const char* const snapshot_type_names[] = {"bool",  "int8",  "uint8", "int16", "uint16", "int32", "uint32",
+												  "int64", "uint64", "float32", "float64", "Dart", "Vec2i", "Vec3i",
+												  "Vec4i", "Vec2f", "Vec3f", "Vec4f", "Vec2d", "Vec3d", "Vec4d"};
+static_assert(std::tuple_size_v<SnapshotTypes> == sizeof(snapshot_type_names) / sizeof(snapshot_type_names[0]),
+			  "Each snapshot type should have a name");
+
+// type in which the values of a snapshot type are stored in the file
+// (booleans are stored as uint8: the size & representation of bool are not fixed)
+template <typename T>
+using SnapshotStored = std::conditional_t<std::is_same_v<T, bool>, uint8, T>;
+
+template <std::size_t I = 0u, typename FUNC>
+void foreach_snapshot_type(const FUNC& f)
+{
+	if constexpr (I < std::tuple_size_v<SnapshotTypes>)
+	{
+		using T = std::tuple_element_t<I, SnapshotTypes>;
+		if (!f(static_cast<T*>(nullptr), snapshot_type_names[I]))
+			return;
+		foreach_snapshot_type<I + 1u>(f);
+	}
+}
+
+class SnapshotWriter
+{
+public:
+	inline SnapshotWriter(std::ofstream& out) : out_(out)
+	{
+	}
+
+	template <typename T>
+	inline void write(const T& value)
+	{
+		out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	inline void write(const std::string& str)
+	{
+		write(uint32(str.size()));
+		out_.write(str.data(), str.size());
+	}
+
+	// values of [0, nb) of the given attribute
+	template <typename T, typename ATTRIBUTE>
+	void write_values(const ATTRIBUTE& attribute, uint32 nb)
+	{
+		using S = SnapshotStored<T>;
+		static const uint32 BUFFER_SIZE = 1u << 16;
+		std::vector<S> buffer(std::min(nb, BUFFER_SIZE));
+		for (uint32 b = 0u; b < nb; b += BUFFER_SIZE)
+		{
+			const uint32 e = std::min(nb, b + BUFFER_SIZE);
+			for (uint32 i = b; i < e; ++i)
+				buffer[i - b] = S(attribute[i]);
+			out_.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(e - b) * sizeof(S));
+		}
+	}
+
+private:
+	std::ofstream& out_;
+};
+
+class SnapshotReader
+{
+public:
+	inline SnapshotReader(const char* begin, const char* end) : cur_(begin), end_(end)
+	{
+	}
+
+	inline bool valid() const
+	{
+		return cur_ != nullptr;
+	}
+
+	template <typename T>
+	inline bool read(T& value)
+	{
+		if (!available(sizeof(T)))
+			return false;
+		std::memcpy(&value, cur_, sizeof(T));
+		cur_ += sizeof(T);
+		return true;
+	}
+
+	inline bool read(std::string& str)
+	{
+		uint32 size;
+		if (!read(size) || !available(size))
+			return false;
+		str.assign(cur_, size);
+		cur_ += size;
+		return true;
+	}
+
+	// values of [0, nb) of the given attribute
+	template <typename T, typename ATTRIBUTE>
+	bool read_values(ATTRIBUTE& attribute, uint32 nb)
+	{
+		using S = SnapshotStored<T>;
+		if (!available(std::size_t(nb) * sizeof(S)))
+			return false;
+		const char* data = cur_;
+		thread_pool()->parallel_for(0u, nb, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				if constexpr (std::is_same_v<T, bool>)
+					attribute[i] = data[i] != 0;
+				else
+					std::memcpy(static_cast<void*>(&attribute[i]), data + std::size_t(i) * sizeof(T), sizeof(T));
+			}
+		});
+		cur_ += std::size_t(nb) * sizeof(S);
+		return true;
+	}
+
+	inline bool skip(std::size_t size)
+	{
+		if (!available(size))
+			return false;
+		cur_ += size;
+		return true;
+	}
+
+private:
+	inline bool available(std::size_t size)
+	{
+		if (cur_ == nullptr || std::size_t(end_ - cur_) < size)
+		{
+			cur_ = nullptr;
+			return false;
+		}
+		return true;
+	}
+
+	const char* cur_;
+	const char* end_;
+};
+
+inline void save_container(SnapshotWriter& w, const CMapBase::AttributeContainer& container)
+{
+	using AttributeGen = CMapBase::AttributeGen;
+
+	const uint32 nb = container.maximum_index();
+	std::vector<uint32> ref_counters = container.ref_counters();
+	w.write(nb);
+	w.write_values<uint32>(ref_counters, nb);
+
+	std::vector<std::pair<AttributeGen*, const char*>> attributes;
+	for (const std::shared_ptr<AttributeGen>& ag : container)
+	{
+		const char* type_name = nullptr;
+		foreach_snapshot_type([&](auto* t, const char* name) -> bool {
+			using T = std::remove_pointer_t<decltype(t)>;
+			if (dynamic_cast<CMapBase::Attribute<T>*>(ag.get()) != nullptr)
+			{
+				type_name = name;
+				return false;
+			}
+			return true;
+		});
+		if (type_name)
+			attributes.emplace_back(ag.get(), type_name);
+		else
+			std::cerr << "save_snapshot: attribute \"" << ag->name() << "\" has an unsupported type and is not saved"
+					  << std::endl;
+	}
+
+	w.write(uint32(attributes.size()));
+	for (auto& [ag, type_name] : attributes)
+	{
+		w.write(ag->name());
+		w.write(std::string(type_name));
+		foreach_snapshot_type([&](auto* t, const char* name) -> bool {
+			using T = std::remove_pointer_t<decltype(t)>;
+			if (name != type_name)
+				return true;
+			w.write_values<T>(*static_cast<CMapBase::Attribute<T>*>(ag), nb);
+			return false;
+		});
+	}
+}
+
+inline bool load_container(SnapshotReader& r, CMapBase::AttributeContainer& container)
+{
+	uint32 nb;
+	if (!r.read(nb))
+		return false;
+	std::vector<uint32> ref_counters(nb);
+	if (!r.read_values<uint32>(ref_counters, nb))
+		return false;
+	container.restore(ref_counters);
+
+	uint32 nb_attributes;
+	if (!r.read(nb_attributes))
+		return false;
+	for (uint32 a = 0u; a < nb_attributes; ++a)
+	{
+		std::string name, type_name;
+		if (!r.read(name) || !r.read(type_name))
+			return false;
+		bool known_type = false;
+		bool ok = true;
+		foreach_snapshot_type([&](auto* t, const char* tn) -> bool {
+			using T = std::remove_pointer_t<decltype(t)>;
+			if (type_name != tn)
+				return true;
+			known_type = true;
+			std::shared_ptr<CMapBase::Attribute<T>> attribute = container.get_attribute<T>(name);
+			if (!attribute && std::none_of(container.begin(), container.end(),
+										   [&](const auto& ag) { return ag->name() == name; }))
+				attribute = container.add_attribute<T>(name);
+			if (attribute)
+				ok = r.read_values<T>(*attribute, nb);
+			else
+			{
+				std::cerr << "load_snapshot: attribute \"" << name << "\" exists with another type, not loaded"
+						  << std::endl;
+				ok = r.skip(std::size_t(nb) * sizeof(SnapshotStored<T>));
+			}
+			return false;
+		});
+		if (!known_type)
+		{
+			std::cerr << "load_snapshot: attribute \"" << name << "\" has an unknown type " << type_name << std::endl;
+			return false;
+		}
+		if (!ok)
+			return false;
+	}
+	return true;
+}
+
+} // namespace internal
+
+/**
+ * @brief save the whole map (darts, relations, cells indexing and attributes) in a binary snapshot
+ * Attributes whose type is not one of the snapshot types are skipped (with a warning).
+ * @return false if the file could not be written
+ */
+template <typename MESH>
+auto save_snapshot(const MESH& m, const std::string& filename)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, CMapBase&>, bool>
+{
+	const CMapBase& mb = static_cast<const CMapBase&>(m);
+
+	std::ofstream out(filename, std::ios::out | std::ios::binary);
+	if (!out.good())
+	{
+		std::cerr << "save_snapshot: could not open \"" << filename << "\"" << std::endl;
+		return false;
+	}
+	internal::SnapshotWriter w(out);
+
+	out.write(internal::SNAPSHOT_MAGIC, sizeof(internal::SNAPSHOT_MAGIC));
+	w.write(internal::SNAPSHOT_VERSION);
+	w.write(internal::SNAPSHOT_BYTE_ORDER_MARK);
+	w.write(std::string(mesh_traits<MESH>::name));
+
+	internal::save_container(w, mb.darts_);
+	w.write_values<uint8>(*mb.boundary_marker_, mb.darts_.maximum_index());
+
+	uint32 indexed_orbits = 0u;
+	for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+	{
+		if (mb.cells_indices_[orbit] != nullptr)
+			indexed_orbits |= 1u << orbit;
+	}
+	w.write(indexed_orbits);
+	for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+	{
+		if (indexed_orbits & (1u << orbit))
+			internal::save_container(w, mb.attribute_containers_[orbit]);
+	}
+
+	return out.good();
+}
+
+/**
+ * @brief load a map saved with save_snapshot in the given (empty) map
+ * Attributes of the snapshot are created if they do not exist in the map (existing attributes with the same name
+ * and type are filled, attributes of the map absent from the snapshot are left with default values).
+ * @return false if the file is not a valid snapshot of a map of this type
+ */
+template <typename MESH>
+auto load_snapshot(MESH& m, const std::string& filename)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, CMapBase&>, bool>
+{
+	CMapBase& mb = static_cast<CMapBase&>(m);
+
+	if (mb.darts_.nb_elements() > 0u)
+	{
+		std::cerr << "load_snapshot: the map should be empty" << std::endl;
+		return false;
+	}
+
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "load_snapshot: could not open \"" << filename << "\"" << std::endl;
+		return false;
+	}
+	internal::SnapshotReader r(file.begin(), file.end());
+
+	char magic[sizeof(internal::SNAPSHOT_MAGIC)];
+	uint32 version = 0u, byte_order_mark = 0u;
+	std::string mesh_name;
+	for (char& c : magic)
+		r.read(c);
+	r.read(version);
+	r.read(byte_order_mark);
+	r.read(mesh_name);
+	if (!r.valid() || std::memcmp(magic, internal::SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+		version != internal::SNAPSHOT_VERSION || byte_order_mark != internal::SNAPSHOT_BYTE_ORDER_MARK)
+	{
+		std::cerr << "load_snapshot: \"" << filename << "\" is not a valid snapshot" << std::endl;
+		return false;
+	}
+	if (mesh_name != mesh_traits<MESH>::name)
+	{
+		std::cerr << "load_snapshot: \"" << filename << "\" is a snapshot of a " << mesh_name << std::endl;
+		return false;
+	}
+
+	// cells indices attributes are loaded with the dart container
+	uint32 indexed_orbits = 0u;
+	if (!internal::load_container(r, mb.darts_))
+	{
+		std::cerr << "load_snapshot: \"" << filename << "\" is truncated" << std::endl;
+		return false;
+	}
+	r.read_values<uint8>(*mb.boundary_marker_, mb.darts_.maximum_index());
+	r.read(indexed_orbits);
+	if (!r.valid())
+	{
+		std::cerr << "load_snapshot: \"" << filename << "\" is truncated" << std::endl;
+		return false;
+	}
+
+	for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+	{
+		if (!(indexed_orbits & (1u << orbit)))
+			continue;
+		std::ostringstream oss;
+		oss << "__index_" << orbit_name(Orbit(orbit));
+		mb.cells_indices_[orbit] = mb.darts_.get_attribute<uint32>(oss.str());
+		if (!mb.cells_indices_[orbit] || !internal::load_container(r, mb.attribute_containers_[orbit]))
+		{
+			std::cerr << "load_snapshot: \"" << filename << "\" is truncated" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // namespace io
+
+} // namespace cgogn
+
+#endif // CGOGN_IO_SNAPSHOT_H_
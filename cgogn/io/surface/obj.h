@@ -33,6 +33,8 @@
 
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <atomic>
+#include <charconv>
 #include <fstream>
 #include <vector>
 
@@ -47,77 +49,115 @@ bool import_OBJ(MESH& m, const std::string& filename)
 {
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	using Vertex = typename MESH::Vertex;
+	SurfaceImportData surface_data;
 
-	Scoped_C_Locale loc;
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "File \"" << filename << "\" could not be opened." << std::endl;
+		return false;
+	}
 
-	SurfaceImportData surface_data;
+	std::vector<const char*> lines = data_lines(file.begin(), file.end());
+	const uint32 nb_lines = uint32(lines.size());
 
-	std::ifstream fp(filename.c_str(), std::ios::in);
+	ThreadPool* pool = thread_pool();
 
-	std::string line, tag;
-	line.reserve(512u);
+	// classify lines: vertex, face (with its number of vertices) or other
+	static const uint32 OTHER_LINE = 0u;
+	static const uint32 VERTEX_LINE = UINT32_MAX;
+	std::vector<uint32> line_type(nb_lines);
+	pool->parallel_for(0u, nb_lines, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			TextCursor c(lines[i], file.end());
+			std::string_view tag = c.token();
+			uint32 type = OTHER_LINE;
+			if (tag == "v")
+				type = VERTEX_LINE;
+			else if (tag == "f")
+			{
+				while (!c.token().empty())
+					++type;
+			}
+			line_type[i] = type;
+		}
+	});
 
-	// read vertices position
-	do
+	// index of the first vertex and face of each line
+	std::vector<uint32> line_vertex(nb_lines);
+	std::vector<uint32> line_face(nb_lines);
+	std::vector<uint32> face_offsets(1u, 0u);
+	for (uint32 i = 0u; i < nb_lines; ++i)
 	{
-		fp >> tag;
-		if (tag == std::string("v"))
+		line_vertex[i] = surface_data.nb_vertices_;
+		line_face[i] = surface_data.nb_faces_;
+		if (line_type[i] == VERTEX_LINE)
+			++surface_data.nb_vertices_;
+		else if (line_type[i] != OTHER_LINE)
 		{
-			surface_data.nb_vertices_++;
-			float64 x = read_double(fp, line);
-			float64 y = read_double(fp, line);
-			float64 z = read_double(fp, line);
-			surface_data.vertex_position_.push_back({x, y, z});
+			++surface_data.nb_faces_;
+			face_offsets.push_back(face_offsets.back() + line_type[i]);
 		}
-		getline_safe(fp, line); // flush line
-	} while (!fp.eof());
+	}
 
 	if (surface_data.nb_vertices_ == 0u)
 	{
 		std::cerr << "File \"" << filename << " has no vertices." << std::endl;
 		return false;
 	}
+	if (surface_data.nb_faces_ == 0u)
+	{
+		std::cerr << "File \"" << filename << " has no faces." << std::endl;
+		return false;
+	}
 
-	// rewind
-	fp.clear();
-	fp.seekg(0, std::ios::beg);
+	surface_data.vertex_position_.resize(surface_data.nb_vertices_);
+	surface_data.faces_nb_vertices_.resize(surface_data.nb_faces_);
+	surface_data.faces_vertex_indices_.resize(face_offsets.back());
+	surface_data.vertex_id_after_import_.reserve(surface_data.nb_vertices_);
 
-	// read faces (vertex indices)
-	uint32 nb_faces = 0;
-	do
-	{
-		fp >> tag;
-		getline_safe(fp, line);
-		if (tag == std::string("f"))
+	std::atomic<bool> valid = true;
+	pool->parallel_for(0u, nb_lines, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
 		{
-			surface_data.nb_faces_++;
-			std::vector<uint32> indices;
-			std::istringstream iss(line);
-			std::string str;
-			while (!iss.eof())
+			if (line_type[i] == OTHER_LINE)
+				continue;
+			TextCursor c(lines[i], file.end());
+			c.token();
+			if (line_type[i] == VERTEX_LINE)
+			{
+				float64 x, y, z;
+				if (!c.read(x) || !c.read(y) || !c.read(z))
+					valid = false;
+				else
+					surface_data.vertex_position_[line_vertex[i]] = {x, y, z};
+			}
+			else
 			{
-				iss >> str;
-				uint32 ind = 0;
-				while ((ind < str.length()) && (str[ind] != '/'))
-					ind++;
-				if (ind > 0)
+				const uint32 f = line_face[i];
+				surface_data.faces_nb_vertices_[f] = line_type[i];
+				for (uint32 j = face_offsets[f]; j < face_offsets[f + 1]; ++j)
 				{
-					uint32 index;
-					std::stringstream iss(str.substr(0, ind));
-					iss >> index;
-					indices.push_back(index - 1);
+					// v, v/vt, v//vn or v/vt/vn: only v is used, negative indices are relative to the current vertex
+					std::string_view t = c.token();
+					int64 index = 0;
+					std::from_chars(t.data(), t.data() + t.size(), index);
+					index = index < 0 ? int64(line_vertex[i]) + index : index - 1;
+					if (index < 0 || index >= int64(surface_data.nb_vertices_))
+					{
+						valid = false;
+						index = 0;
+					}
+					surface_data.faces_vertex_indices_[j] = uint32(index);
 				}
 			}
-			surface_data.faces_nb_vertices_.push_back(indices.size());
-			surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), indices.begin(),
-													  indices.end());
 		}
-	} while (!fp.eof());
+	});
 
-	if (surface_data.nb_faces_ == 0u)
+	if (!valid)
 	{
-		std::cerr << "File \"" << filename << " has no faces." << std::endl;
+		std::cerr << "File \"" << filename << "\" is not a valid obj file." << std::endl;
 		return false;
 	}
 
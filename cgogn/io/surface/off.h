@@ -33,7 +33,11 @@
 
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace cgogn
@@ -42,34 +46,206 @@ namespace cgogn
 namespace io
 {
 
-template <typename MESH>
-bool import_OFF(MESH& m, const std::string& filename)
+namespace internal
 {
-	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	using Vertex = typename MESH::Vertex;
+/**
+ * @brief read the vertices & faces of an OFF file batch by batch and hand them to the given sink
+ * (SurfaceImportStream or SurfaceImportData)
+ * The records of a batch are parsed concurrently, one per line; the batches where a record does not end with its line
+ * (wrapped records, several records on a line) are parsed again token by token.
+ * @return false if the file is not valid (the elements read so far have been handed to the sink, that has to be
+ * cancelled)
+ */
+template <typename SINK>
+bool read_OFF_elements(const MappedFile& file, DataLineReader& reader, uint32 nb_vertices, uint32 nb_faces,
+					   SINK& sink, const std::string& filename)
+{
+	ThreadPool* pool = thread_pool();
+	std::atomic<bool> one_per_line = true;
+	std::vector<const char*> lines;
+	lines.reserve(IMPORT_BATCH_SIZE);
+
+	auto invalid = [&]() -> bool {
+		std::cerr << "File \"" << filename << "\" is not a valid off file." << std::endl;
+		return false;
+	};
+	auto truncated = [&]() -> bool {
+		std::cerr << "File \"" << filename << "\" is truncated." << std::endl;
+		return false;
+	};
+
+	// read vertices position
+	std::vector<Vec3> positions;
+	for (uint32 nb_read = 0u; nb_read < nb_vertices;)
+	{
+		const uint32 n = reader.next_batch(std::min(IMPORT_BATCH_SIZE, nb_vertices - nb_read), lines);
+		if (n == 0u)
+			return truncated();
+		positions.resize(n);
+		one_per_line = true;
+		pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				TextCursor c(lines[i], file.end());
+				float64 x, y, z;
+				if (!c.read(x) || !c.read(y) || !c.read(z) || !c.end_of_line())
+					one_per_line = false;
+				else
+					positions[i] = {x, y, z};
+			}
+		});
+		if (!one_per_line)
+		{
+			TextCursor c(lines[0], file.end());
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				float64 x, y, z;
+				if (!c.next(x) || !c.next(y) || !c.next(z))
+					return c.at_end() ? truncated() : invalid();
+				positions[i] = {x, y, z};
+			}
+			reader.seek(c.position());
+		}
+		sink.add_vertices(positions.data(), n);
+		file.release_until(reader.position());
+		nb_read += n;
+	}
+
+	// read faces: number of vertices then vertex indices, stored at their offset
+	std::vector<uint32> faces_nb_vertices;
+	std::vector<uint32> face_offsets;
+	std::vector<uint32> faces_vertex_indices;
+	std::atomic<bool> valid = true;
+	for (uint32 nb_read = 0u; nb_read < nb_faces;)
+	{
+		const uint32 n = reader.next_batch(std::min(IMPORT_BATCH_SIZE, nb_faces - nb_read), lines);
+		if (n == 0u)
+			return truncated();
+		faces_nb_vertices.resize(n);
+		one_per_line = true;
+		// the number of vertices of a face is bounded by the size of its line
+		pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				TextCursor c(lines[i], file.end());
+				uint32& nbv = faces_nb_vertices[i];
+				if (!c.read(nbv))
+				{
+					one_per_line = false;
+					continue;
+				}
+				const void* eol = std::memchr(c.position(), '\n', std::size_t(file.end() - c.position()));
+				if (nbv > max_nb_numbers(c.position(), eol ? static_cast<const char*>(eol) : file.end()))
+					one_per_line = false;
+			}
+		});
+
+		if (one_per_line)
+		{
+			face_offsets.resize(n + 1u);
+			face_offsets[0] = 0u;
+			uint64 nb_indices = 0u;
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				nb_indices += faces_nb_vertices[i];
+				if (nb_indices > std::numeric_limits<uint32>::max())
+					return invalid();
+				face_offsets[i + 1] = uint32(nb_indices);
+			}
+			faces_vertex_indices.resize(face_offsets[n]);
+
+			pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 i = b; i < e; ++i)
+				{
+					TextCursor c(lines[i], file.end());
+					uint32 nbv;
+					bool ok = c.read(nbv);
+					for (uint32 j = face_offsets[i]; ok && j < face_offsets[i + 1]; ++j)
+					{
+						uint32& index = faces_vertex_indices[j];
+						ok = c.read(index);
+						if (ok && index >= nb_vertices)
+							valid = false;
+					}
+					if (!ok || !c.end_of_line())
+						one_per_line = false;
+				}
+			});
+		}
+
+		if (!one_per_line)
+		{
+			valid = true;
+			faces_vertex_indices.clear();
+			TextCursor c(lines[0], file.end());
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				uint32& nbv = faces_nb_vertices[i];
+				if (!c.next(nbv))
+					return c.at_end() ? truncated() : invalid();
+				c.skip_blanks();
+				if (nbv > max_nb_numbers(c.position(), file.end()) ||
+					faces_vertex_indices.size() + nbv > std::numeric_limits<uint32>::max())
+					return invalid();
+				for (uint32 j = 0u; j < nbv; ++j)
+				{
+					uint32 index;
+					if (!c.next(index))
+						return c.at_end() ? truncated() : invalid();
+					if (index >= nb_vertices)
+						return invalid();
+					faces_vertex_indices.push_back(index);
+				}
+			}
+			reader.seek(c.position());
+		}
+
+		if (!valid)
+			return invalid();
+		sink.add_faces(faces_nb_vertices.data(), n, faces_vertex_indices.data());
+		file.release_until(reader.position());
+		nb_read += n;
+	}
+
+	return true;
+}
 
-	Scoped_C_Locale loc;
+} // namespace internal
 
-	SurfaceImportData surface_data;
+/**
+ * @brief import an OFF file
+ * CMap2 are built while the file is read, by batches of IMPORT_BATCH_SIZE elements (see SurfaceImportStream).
+ * If the file turns out to be invalid, the elements added so far are removed and the mesh is left untouched.
+ */
+template <typename MESH>
+bool import_OFF(MESH& m, const std::string& filename)
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	std::ifstream fp(filename.c_str(), std::ios::in);
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "File \"" << filename << "\" could not be opened." << std::endl;
+		return false;
+	}
 
-	std::string line;
-	line.reserve(512u);
+	TextCursor header(file.begin(), file.end());
 
 	// read OFF header
-	getline_safe(fp, line);
-	if (line.rfind("OFF") == std::string::npos)
+	if (header.line().find("OFF") == std::string_view::npos)
 	{
 		std::cerr << "File \"" << filename << "\" is not a valid off file." << std::endl;
 		return false;
 	}
 
-	// read number of vertices, edges, faces
-	const uint32 nb_vertices = read_uint(fp, line);
-	const uint32 nb_faces = read_uint(fp, line);
-	/*const uint32 nb_edges_ =*/read_uint(fp, line);
+	// read number of vertices, faces, edges
+	uint32 nb_vertices = 0u, nb_faces = 0u, nb_edges = 0u;
+	if (!header.next(nb_vertices) || !header.next(nb_faces) || !header.next(nb_edges))
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid off file." << std::endl;
+		return false;
+	}
 
 	if (nb_vertices == 0u)
 	{
@@ -82,34 +258,27 @@ bool import_OFF(MESH& m, const std::string& filename)
 		return false;
 	}
 
-	surface_data.reserve(nb_vertices, nb_faces);
+	DataLineReader reader(header.position(), file.end());
 
-	// read vertices position
-	for (uint32 i = 0u; i < nb_vertices; ++i)
+	if constexpr (std::is_convertible_v<MESH&, CMap2&>)
 	{
-		float64 x = read_double(fp, line);
-		float64 y = read_double(fp, line);
-		float64 z = read_double(fp, line);
-		surface_data.vertex_position_.push_back({x, y, z});
+		SurfaceImportStream stream(m);
+		if (!internal::read_OFF_elements(file, reader, nb_vertices, nb_faces, stream, filename))
+		{
+			stream.cancel();
+			return false;
+		}
+		stream.finish();
+		return true;
 	}
-
-	// read faces (vertex indices)
-	for (uint32 i = 0u; i < nb_faces; ++i)
+	else
 	{
-		uint32 n = read_uint(fp, line);
-
-		std::vector<uint32> indices(n);
-		for (uint32 j = 0u; j < n; ++j)
-			indices[j] = read_uint(fp, line);
-
-		surface_data.faces_nb_vertices_.push_back(n);
-		surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), indices.begin(),
-												  indices.end());
+		SurfaceImportData surface_data;
+		if (!internal::read_OFF_elements(file, reader, nb_vertices, nb_faces, surface_data, filename))
+			return false;
+		import_surface_data(m, surface_data);
+		return true;
 	}
-
-	import_surface_data(m, surface_data);
-
-	return true;
 }
 
 template <typename MESH>
@@ -35,6 +35,16 @@
 
 #include <thirdparty/happly/happly.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace cgogn
@@ -43,13 +53,442 @@ namespace cgogn
 namespace io
 {
 
-template <typename MESH>
-bool import_PLY(MESH& m, const std::string& filename)
+/**
+ * Binary little endian PLY files are read & written directly: the records are addressed in the (memory-mapped)
+ * file and parsed in parallel, by batches, into the map construction (see SurfaceImportStream) and into the
+ * attributes. Other formats are read with happly (positions & faces only).
+ *
+ * Besides the positions (x, y, z) and the faces vertex indices, the scalar properties of the vertices and faces
+ * are imported as attributes of the same name and type; properties are grouped into Vec3 attributes:
+ * nx, ny, nz -> "normal", red, green, blue -> "color" (in [0, 1]), name_x, name_y, name_z -> "name".
+ * export_PLY writes the attributes of supported types (Vec3 and PLY scalar types) the same way. Scalar attributes
+ * keep their type, but Vec3 attributes do not keep the type of the properties they were read from: positions and
+ * Vec3 attributes are written as double and colors as uchar, so that exporting an imported file may change (and for
+ * float colors round) these properties.
+ */
+
+namespace internal
 {
-	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	using Vertex = typename MESH::Vertex;
+enum class PLYScalarType : uint8
+{
+	Int8,
+	UInt8,
+	Int16,
+	UInt16,
+	Int32,
+	UInt32,
+	Float32,
+	Float64,
+	Invalid
+};
+
+// attribute types that can be stored as PLY scalar properties (in the order of PLYScalarType)
+using PLYScalarTypes = std::tuple<int8, uint8, int16, uint16, int32, uint32, float32, float64>;
+static const char* const ply_scalar_type_names[] = {"char", "uchar", "short", "ushort",
+													"int",	"uint",	 "float", "double"};
+static const char* const ply_sized_scalar_type_names[] = {"int8",  "uint8",	 "int16",	"uint16",
+														  "int32", "uint32", "float32", "float64"};
+static const uint32 ply_scalar_type_sizes[] = {1u, 1u, 2u, 2u, 4u, 4u, 4u, 8u};
+
+inline PLYScalarType ply_scalar_type(std::string_view name)
+{
+	for (uint32 i = 0u; i < std::tuple_size_v<PLYScalarTypes>; ++i)
+	{
+		if (name == ply_scalar_type_names[i] || name == ply_sized_scalar_type_names[i])
+			return PLYScalarType(i);
+	}
+	return PLYScalarType::Invalid;
+}
+
+inline uint32 ply_scalar_size(PLYScalarType type)
+{
+	return ply_scalar_type_sizes[uint32(type)];
+}
+
+template <std::size_t I = 0u, typename FUNC>
+void foreach_ply_scalar_type(const FUNC& f)
+{
+	if constexpr (I < std::tuple_size_v<PLYScalarTypes>)
+	{
+		using T = std::tuple_element_t<I, PLYScalarTypes>;
+		if (!f(static_cast<T*>(nullptr), PLYScalarType(I)))
+			return;
+		foreach_ply_scalar_type<I + 1u>(f);
+	}
+}
+
+template <typename S>
+inline S load_ply_scalar(const char* p)
+{
+	S value;
+	std::memcpy(&value, p, sizeof(S));
+	return value;
+}
+
+// value of the given type stored at p converted to T
+template <typename T>
+inline T read_ply_scalar(const char* p, PLYScalarType type)
+{
+	switch (type)
+	{
+	case PLYScalarType::Int8:
+		return T(load_ply_scalar<int8>(p));
+	case PLYScalarType::UInt8:
+		return T(load_ply_scalar<uint8>(p));
+	case PLYScalarType::Int16:
+		return T(load_ply_scalar<int16>(p));
+	case PLYScalarType::UInt16:
+		return T(load_ply_scalar<uint16>(p));
+	case PLYScalarType::Int32:
+		return T(load_ply_scalar<int32>(p));
+	case PLYScalarType::UInt32:
+		return T(load_ply_scalar<uint32>(p));
+	case PLYScalarType::Float32:
+		return T(load_ply_scalar<float32>(p));
+	case PLYScalarType::Float64:
+		return T(load_ply_scalar<float64>(p));
+	default:
+		return T();
+	}
+}
+
+struct PLYProperty
+{
+	std::string name_;
+	PLYScalarType type_;
+	PLYScalarType count_type_; // Invalid if the property is not a list
+
+	inline bool is_list() const
+	{
+		return count_type_ != PLYScalarType::Invalid;
+	}
+	// size of the property at p
+	inline std::size_t size(const char* p) const
+	{
+		if (!is_list())
+			return ply_scalar_size(type_);
+		return ply_scalar_size(count_type_) +
+			   std::size_t(read_ply_scalar<uint32>(p, count_type_)) * ply_scalar_size(type_);
+	}
+};
+
+struct PLYElement
+{
+	std::string name_;
+	uint32 count_ = 0u;
+	std::vector<PLYProperty> properties_;
+
+	// binary layout
+	const char* data_ = nullptr;
+	std::size_t stride_ = 0u;				// size of the records if they all have the same size, 0 otherwise
+	std::vector<std::size_t> record_offsets_; // offsets of the records (from data_) if stride_ is 0
+
+	inline int32 property_index(std::string_view name) const
+	{
+		for (uint32 i = 0u; i < uint32(properties_.size()); ++i)
+		{
+			if (properties_[i].name_ == name)
+				return int32(i);
+		}
+		return -1;
+	}
+
+	inline const char* record(uint32 i) const
+	{
+		return stride_ > 0u ? data_ + std::size_t(i) * stride_ : data_ + record_offsets_[i];
+	}
+
+	// beginning of the given property in the given record
+	inline const char* property(const char* record, uint32 property_index) const
+	{
+		for (uint32 i = 0u; i < property_index; ++i)
+			record += properties_[i].size(record);
+		return record;
+	}
+};
+
+struct PLYHeader
+{
+	std::string format_;
+	std::vector<PLYElement> elements_;
+	const char* data_ = nullptr;
+
+	inline PLYElement* element(std::string_view name)
+	{
+		for (PLYElement& e : elements_)
+		{
+			if (e.name_ == name)
+				return &e;
+		}
+		return nullptr;
+	}
+};
+
+inline bool read_PLY_header(const char* begin, const char* end, PLYHeader& header)
+{
+	TextCursor cursor(begin, end);
+	if (cursor.line() != "ply")
+		return false;
+	while (!cursor.at_end())
+	{
+		std::string_view line = cursor.line();
+		TextCursor tokens(line.data(), line.data() + line.size());
+		std::string_view keyword = tokens.token();
+		if (keyword == "format")
+			header.format_ = tokens.token();
+		else if (keyword == "element")
+		{
+			PLYElement& e = header.elements_.emplace_back();
+			e.name_ = tokens.token();
+			if (!tokens.read(e.count_))
+				return false;
+		}
+		else if (keyword == "property")
+		{
+			if (header.elements_.empty())
+				return false;
+			PLYProperty p;
+			std::string_view type = tokens.token();
+			p.count_type_ = PLYScalarType::Invalid;
+			if (type == "list")
+			{
+				p.count_type_ = ply_scalar_type(tokens.token());
+				if (p.count_type_ == PLYScalarType::Invalid)
+					return false;
+				type = tokens.token();
+			}
+			p.type_ = ply_scalar_type(type);
+			p.name_ = tokens.token();
+			if (p.type_ == PLYScalarType::Invalid || p.name_.empty())
+				return false;
+			header.elements_.back().properties_.push_back(p);
+		}
+		else if (keyword == "end_header")
+		{
+			header.data_ = cursor.position();
+			return true;
+		}
+		// comment, obj_info: ignored
+	}
+	return false;
+}
+
+// locate the records of the elements of a binary file
+inline bool layout_PLY_elements(PLYHeader& header, const char* end)
+{
+	const char* data = header.data_;
+	for (PLYElement& e : header.elements_)
+	{
+		e.data_ = data;
+		if (e.count_ == 0u)
+			continue;
+
+		// records size from the first record: if the records have no list or the same list sizes as the first one,
+		// they all have this size (checked in parallel)
+		std::size_t first_size = 0u;
+		bool has_list = false;
+		for (const PLYProperty& p : e.properties_)
+		{
+			if (data + first_size + ply_scalar_size(p.is_list() ? p.count_type_ : p.type_) > end)
+				return false;
+			first_size += p.size(data + first_size);
+			has_list |= p.is_list();
+		}
+		if (first_size == 0u)
+			return false;
+
+		bool same_size = std::size_t(end - data) / first_size >= e.count_;
+		if (same_size && has_list)
+		{
+			std::vector<std::size_t> list_offsets; // offsets of the lists in the first record
+			std::vector<uint32> list_sizes;
+			std::size_t offset = 0u;
+			for (const PLYProperty& p : e.properties_)
+			{
+				if (p.is_list())
+				{
+					list_offsets.push_back(offset);
+					list_sizes.push_back(read_ply_scalar<uint32>(data + offset, p.count_type_));
+				}
+				offset += p.size(data + offset);
+			}
+			std::atomic<bool> same = true;
+			thread_pool()->parallel_for(0u, e.count_, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 en) {
+				for (uint32 i = b; i < en && same; ++i)
+				{
+					const char* r = data + std::size_t(i) * first_size;
+					uint32 l = 0u;
+					for (const PLYProperty& p : e.properties_)
+					{
+						if (!p.is_list())
+							continue;
+						if (read_ply_scalar<uint32>(r + list_offsets[l], p.count_type_) != list_sizes[l])
+						{
+							same = false;
+							break;
+						}
+						++l;
+					}
+				}
+			});
+			same_size = same;
+		}
+
+		if (same_size)
+		{
+			e.stride_ = first_size;
+			data += std::size_t(e.count_) * first_size;
+			continue;
+		}
+
+		// records of different sizes
+		e.record_offsets_.resize(e.count_);
+		std::size_t offset = 0u;
+		for (uint32 i = 0u; i < e.count_; ++i)
+		{
+			e.record_offsets_[i] = offset;
+			for (const PLYProperty& p : e.properties_)
+			{
+				if (data + offset + ply_scalar_size(p.is_list() ? p.count_type_ : p.type_) > end)
+					return false;
+				offset += p.size(data + offset);
+			}
+		}
+		if (data + offset > end)
+			return false;
+		data += offset;
+	}
+	return true;
+}
+
+// vertex or face properties imported as an attribute
+struct PLYAttributeReader
+{
+	std::string name_;
+	std::vector<uint32> properties_; // 1 (scalar attribute) or 3 (Vec3 attribute) properties
+	float64 divisor_ = 1.0;
+};
+
+// group the properties of the given element that are not ignored into attributes
+inline std::vector<PLYAttributeReader> ply_attribute_readers(const PLYElement& e,
+															 const std::vector<std::string>& ignored)
+{
+	std::vector<PLYAttributeReader> readers;
+	std::vector<bool> used(e.properties_.size(), false);
+	for (uint32 i = 0u; i < uint32(e.properties_.size()); ++i)
+	{
+		const PLYProperty& p = e.properties_[i];
+		if (std::find(ignored.begin(), ignored.end(), p.name_) != ignored.end())
+			used[i] = true;
+		else if (p.is_list())
+		{
+			std::cout << "import_PLY: list property " << e.name_ << "::" << p.name_ << " is ignored" << std::endl;
+			used[i] = true;
+		}
+	}
+
+	auto add_vec3 = [&](const std::string& name, std::string_view x, std::string_view y, std::string_view z,
+						bool color) {
+		int32 ix = e.property_index(x), iy = e.property_index(y), iz = e.property_index(z);
+		if (ix < 0 || iy < 0 || iz < 0 || used[ix] || used[iy] || used[iz])
+			return;
+		PLYAttributeReader r;
+		r.name_ = name;
+		r.properties_ = {uint32(ix), uint32(iy), uint32(iz)};
+		if (color && e.properties_[ix].type_ == PLYScalarType::UInt8)
+			r.divisor_ = 255.0;
+		used[ix] = used[iy] = used[iz] = true;
+		readers.push_back(std::move(r));
+	};
+
+	add_vec3("normal", "nx", "ny", "nz", false);
+	add_vec3("color", "red", "green", "blue", true);
+	for (uint32 i = 0u; i < uint32(e.properties_.size()); ++i)
+	{
+		const std::string& name = e.properties_[i].name_;
+		if (!used[i] && name.size() > 2u && name.compare(name.size() - 2u, 2u, "_x") == 0)
+		{
+			const std::string base = name.substr(0u, name.size() - 2u);
+			add_vec3(base, name, base + "_y", base + "_z", false);
+		}
+	}
+	for (uint32 i = 0u; i < uint32(e.properties_.size()); ++i)
+	{
+		if (!used[i])
+			readers.push_back({e.properties_[i].name_, {i}, 1.0});
+	}
+	// attributes are created in the order of the properties
+	std::sort(readers.begin(), readers.end(), [](const PLYAttributeReader& r1, const PLYAttributeReader& r2) {
+		return r1.properties_[0] < r2.properties_[0];
+	});
+
+	return readers;
+}
 
+// read the properties of the records of e into attributes of the given cells: cell_index(i) is the index of the cell
+// of the i-th record (INVALID_INDEX if there is none)
+template <typename CELL, typename MESH, typename FUNC>
+void read_ply_attributes(MESH& m, const PLYElement& e, const std::vector<PLYAttributeReader>& readers,
+						 const FUNC& cell_index)
+{
+	ThreadPool* pool = thread_pool();
+	for (const PLYAttributeReader& r : readers)
+	{
+		if (r.properties_.size() == 3u)
+		{
+			auto attribute = get_or_add_attribute<geometry::Vec3, CELL>(m, r.name_);
+			if (!attribute)
+			{
+				std::cout << "import_PLY: attribute " << r.name_ << " could not be created" << std::endl;
+				continue;
+			}
+			pool->parallel_for(0u, e.count_, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 en) {
+				for (uint32 i = b; i < en; ++i)
+				{
+					const uint32 index = cell_index(i);
+					if (index == INVALID_INDEX)
+						continue;
+					const char* record = e.record(i);
+					geometry::Vec3& v = (*attribute)[index];
+					for (uint32 k = 0u; k < 3u; ++k)
+					{
+						const PLYProperty& p = e.properties_[r.properties_[k]];
+						v[k] = read_ply_scalar<float64>(e.property(record, r.properties_[k]), p.type_) / r.divisor_;
+					}
+				}
+			});
+		}
+		else
+		{
+			const PLYProperty& p = e.properties_[r.properties_[0]];
+			foreach_ply_scalar_type([&](auto* t, PLYScalarType type) -> bool {
+				using T = std::remove_pointer_t<decltype(t)>;
+				if (type != p.type_)
+					return true;
+				auto attribute = get_or_add_attribute<T, CELL>(m, r.name_);
+				if (!attribute)
+				{
+					std::cout << "import_PLY: attribute " << r.name_ << " could not be created" << std::endl;
+					return false;
+				}
+				pool->parallel_for(0u, e.count_, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 en) {
+					for (uint32 i = b; i < en; ++i)
+					{
+						const uint32 index = cell_index(i);
+						if (index != INVALID_INDEX)
+							(*attribute)[index] = load_ply_scalar<T>(e.property(e.record(i), r.properties_[0]));
+					}
+				});
+				return false;
+			});
+		}
+	}
+}
+
+template <typename MESH>
+bool import_PLY_happly(MESH& m, const std::string& filename)
+{
 	Scoped_C_Locale loc;
 
 	SurfaceImportData surface_data;
@@ -81,13 +520,369 @@ bool import_PLY(MESH& m, const std::string& filename)
 	return true;
 }
 
+inline bool is_little_endian()
+{
+	const uint16 one = 1u;
+	uint8 first_byte;
+	std::memcpy(&first_byte, &one, 1u);
+	return first_byte == 1u;
+}
+
+// properties of the attributes written in a PLY element
+struct PLYAttributeWriter
+{
+	std::vector<std::string> properties_;
+	PLYScalarType type_;
+	std::function<void(char*, uint32)> write_; // write the value of the given index
+};
+
+// writers of the attributes of the given cells (except excluded & the ones whose name starts with "__")
+template <typename CELL, typename MESH>
+std::vector<PLYAttributeWriter> ply_attribute_writers(const MESH& m, const void* excluded)
+{
+	using AttributeGen = typename mesh_traits<MESH>::AttributeGen;
+	using Vec3Attribute = typename mesh_traits<MESH>::template Attribute<geometry::Vec3>;
+
+	std::vector<PLYAttributeWriter> writers;
+	foreach_attribute<CELL>(m, [&](const std::shared_ptr<AttributeGen>& a) {
+		const std::string& name = a->name();
+		if (a.get() == excluded || name.compare(0u, 2u, "__") == 0)
+			return;
+
+		if (std::shared_ptr<Vec3Attribute> v = std::dynamic_pointer_cast<Vec3Attribute>(a))
+		{
+			if (name == "color")
+			{
+				writers.push_back({{"red", "green", "blue"}, PLYScalarType::UInt8, [v](char* p, uint32 index) {
+									   const geometry::Vec3& c = (*v)[index];
+									   for (uint32 k = 0u; k < 3u; ++k)
+										   p[k] = char(uint8(std::lround(std::clamp(c[k], 0.0, 1.0) * 255.0)));
+								   }});
+				return;
+			}
+			std::vector<std::string> properties = {"nx", "ny", "nz"};
+			if (name != "normal")
+				properties = {name + "_x", name + "_y", name + "_z"};
+			writers.push_back({properties, PLYScalarType::Float64, [v](char* p, uint32 index) {
+								   std::memcpy(p, (*v)[index].data(), 3u * sizeof(float64));
+							   }});
+			return;
+		}
+
+		foreach_ply_scalar_type([&](auto* t, PLYScalarType type) -> bool {
+			using T = std::remove_pointer_t<decltype(t)>;
+			using AttributeT = typename mesh_traits<MESH>::template Attribute<T>;
+			std::shared_ptr<AttributeT> at = std::dynamic_pointer_cast<AttributeT>(a);
+			if (!at)
+				return true;
+			writers.push_back(
+				{{name}, type, [at](char* p, uint32 index) { std::memcpy(p, &(*at)[index], sizeof(T)); }});
+			return false;
+		});
+	});
+	return writers;
+}
+
+inline std::size_t ply_record_size(const std::vector<PLYAttributeWriter>& writers)
+{
+	std::size_t size = 0u;
+	for (const PLYAttributeWriter& w : writers)
+		size += w.properties_.size() * ply_scalar_size(w.type_);
+	return size;
+}
+
+inline void write_ply_properties(std::ofstream& out, const std::vector<PLYAttributeWriter>& writers)
+{
+	for (const PLYAttributeWriter& w : writers)
+	{
+		for (const std::string& property : w.properties_)
+			out << "property " << ply_scalar_type_names[uint32(w.type_)] << " " << property << "\n";
+	}
+}
+
+inline char* write_ply_values(char* p, const std::vector<PLYAttributeWriter>& writers, uint32 index)
+{
+	for (const PLYAttributeWriter& w : writers)
+	{
+		w.write_(p, index);
+		p += w.properties_.size() * ply_scalar_size(w.type_);
+	}
+	return p;
+}
+
+} // namespace internal
+
+/**
+ * @brief import a PLY file (with its vertex & face attributes if it is binary little endian)
+ * The face vertex indices are all checked before any attribute is read: if the file is not valid, the mesh is left
+ * untouched.
+ */
+template <typename MESH>
+bool import_PLY(MESH& m, const std::string& filename)
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
+
+	using Vertex = typename MESH::Vertex;
+	using Face = typename MESH::Face;
+
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "File \"" << filename << "\" could not be opened." << std::endl;
+		return false;
+	}
+
+	internal::PLYHeader header;
+	if (!internal::read_PLY_header(file.begin(), file.end(), header))
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid ply file." << std::endl;
+		return false;
+	}
+	if (header.format_ != "binary_little_endian" || !internal::is_little_endian())
+		return internal::import_PLY_happly(m, filename);
+	if (!internal::layout_PLY_elements(header, file.end()))
+	{
+		std::cerr << "File \"" << filename << "\" is truncated." << std::endl;
+		return false;
+	}
+
+	const internal::PLYElement* vertices = header.element("vertex");
+	const internal::PLYElement* faces = header.element("face");
+	if (!vertices || !faces)
+	{
+		std::cerr << "File \"" << filename << "\" has no vertices or no faces." << std::endl;
+		return false;
+	}
+	const int32 ix = vertices->property_index("x");
+	const int32 iy = vertices->property_index("y");
+	const int32 iz = vertices->property_index("z");
+	int32 il = faces->property_index("vertex_indices");
+	if (il < 0)
+		il = faces->property_index("vertex_index");
+	if (ix < 0 || iy < 0 || iz < 0 || vertices->properties_[ix].is_list() || vertices->properties_[iy].is_list() ||
+		vertices->properties_[iz].is_list() || il < 0 || !faces->properties_[il].is_list())
+	{
+		std::cerr << "File \"" << filename << "\" has no vertex positions or no face vertex indices." << std::endl;
+		return false;
+	}
+
+	const std::vector<internal::PLYAttributeReader> vertex_readers =
+		internal::ply_attribute_readers(*vertices, {"x", "y", "z"});
+	const std::vector<internal::PLYAttributeReader> face_readers =
+		internal::ply_attribute_readers(*faces, {faces->properties_[il].name_});
+
+	const uint32 nb_vertices = vertices->count_;
+	const uint32 nb_faces = faces->count_;
+
+	ThreadPool* pool = thread_pool();
+	std::atomic<bool> valid = true;
+
+	// positions & faces are read by batches and handed to the sink (SurfaceImportStream or SurfaceImportData)
+	auto read_elements = [&](auto& sink, Dart* faces_dart) {
+		const internal::PLYProperty& px = vertices->properties_[ix];
+		const internal::PLYProperty& py = vertices->properties_[iy];
+		const internal::PLYProperty& pz = vertices->properties_[iz];
+		std::vector<Vec3> positions;
+		for (uint32 first = 0u; first < nb_vertices; first += IMPORT_BATCH_SIZE)
+		{
+			const uint32 n = std::min(IMPORT_BATCH_SIZE, nb_vertices - first);
+			positions.resize(n);
+			pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 i = b; i < e; ++i)
+				{
+					const char* r = vertices->record(first + i);
+					positions[i] = {internal::read_ply_scalar<float64>(vertices->property(r, ix), px.type_),
+									internal::read_ply_scalar<float64>(vertices->property(r, iy), py.type_),
+									internal::read_ply_scalar<float64>(vertices->property(r, iz), pz.type_)};
+				}
+			});
+			sink.add_vertices(positions.data(), n);
+		}
+
+		const internal::PLYProperty& pl = faces->properties_[il];
+		const uint32 count_size = internal::ply_scalar_size(pl.count_type_);
+		const uint32 index_size = internal::ply_scalar_size(pl.type_);
+		std::vector<uint32> faces_nb_vertices;
+		std::vector<uint32> face_offsets;
+		std::vector<uint32> faces_vertex_indices;
+		for (uint32 first = 0u; first < nb_faces && valid; first += IMPORT_BATCH_SIZE)
+		{
+			const uint32 n = std::min(IMPORT_BATCH_SIZE, nb_faces - first);
+			faces_nb_vertices.resize(n);
+			pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 i = b; i < e; ++i)
+					faces_nb_vertices[i] = internal::read_ply_scalar<uint32>(
+						faces->property(faces->record(first + i), il), pl.count_type_);
+			});
+			face_offsets.resize(n + 1u);
+			face_offsets[0] = 0u;
+			for (uint32 i = 0u; i < n; ++i)
+				face_offsets[i + 1] = face_offsets[i] + faces_nb_vertices[i];
+			faces_vertex_indices.resize(face_offsets[n]);
+
+			pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 i = b; i < e; ++i)
+				{
+					const char* list = faces->property(faces->record(first + i), il) + count_size;
+					for (uint32 j = face_offsets[i]; j < face_offsets[i + 1]; ++j, list += index_size)
+					{
+						const int64 index = internal::read_ply_scalar<int64>(list, pl.type_);
+						if (index < 0 || index >= int64(nb_vertices))
+						{
+							valid = false;
+							faces_vertex_indices[j] = 0u;
+						}
+						else
+							faces_vertex_indices[j] = uint32(index);
+					}
+				}
+			});
+			if (!valid)
+				break;
+
+			if constexpr (std::is_same_v<std::decay_t<decltype(sink)>, SurfaceImportStream>)
+				sink.add_faces(faces_nb_vertices.data(), n, faces_vertex_indices.data(),
+							   faces_dart ? faces_dart + first : nullptr);
+			else
+				sink.add_faces(faces_nb_vertices.data(), n, faces_vertex_indices.data());
+		}
+	};
+
+	if constexpr (std::is_convertible_v<MESH&, CMap2&>)
+	{
+		SurfaceImportStream stream(m);
+		std::vector<Dart> faces_dart(face_readers.empty() ? 0u : nb_faces);
+		read_elements(stream, faces_dart.empty() ? nullptr : faces_dart.data());
+		if (!valid)
+		{
+			std::cerr << "File \"" << filename << "\" is not a valid ply file." << std::endl;
+			stream.cancel();
+			return false;
+		}
+		stream.finish();
+
+		const std::vector<uint32>& vertex_ids = stream.vertex_id_after_import();
+		internal::read_ply_attributes<Vertex>(m, *vertices, vertex_readers,
+											  [&](uint32 i) -> uint32 { return vertex_ids[i]; });
+		internal::read_ply_attributes<Face>(m, *faces, face_readers, [&](uint32 i) -> uint32 {
+			return faces_dart[i].is_nil() ? INVALID_INDEX : index_of(m, Face(faces_dart[i]));
+		});
+	}
+	else
+	{
+		SurfaceImportData surface_data;
+		read_elements(surface_data, nullptr);
+		if (!valid)
+		{
+			std::cerr << "File \"" << filename << "\" is not a valid ply file." << std::endl;
+			return false;
+		}
+		import_surface_data(m, surface_data);
+
+		internal::read_ply_attributes<Vertex>(m, *vertices, vertex_readers, [&](uint32 i) -> uint32 {
+			return surface_data.vertex_id_after_import_[i];
+		});
+		internal::read_ply_attributes<Face>(m, *faces, face_readers, [&](uint32 i) -> uint32 {
+			return surface_data.face_id_after_import_[i];
+		});
+	}
+
+	return true;
+}
+
+/**
+ * @brief export a binary PLY file, with the vertex & face attributes of supported types
+ */
 template <typename MESH>
 void export_PLY(MESH& m, const typename mesh_traits<MESH>::template Attribute<geometry::Vec3>* vertex_position,
 				const std::string& filename)
 {
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	// TODO
+	using Vertex = typename MESH::Vertex;
+	using Face = typename MESH::Face;
+
+	static const std::size_t BUFFER_SIZE = 1u << 20;
+
+	const std::vector<internal::PLYAttributeWriter> vertex_writers =
+		internal::ply_attribute_writers<Vertex>(m, vertex_position);
+	const std::vector<internal::PLYAttributeWriter> face_writers = internal::ply_attribute_writers<Face>(m, nullptr);
+
+	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
+
+	uint32 nb_vertices = nb_cells<Vertex>(m);
+	uint32 nb_faces = nb_cells<Face>(m);
+	uint32 max_degree = 0u;
+	foreach_cell(m, [&](Face f) -> bool {
+		max_degree = std::max(max_degree, codegree(m, f));
+		return true;
+	});
+
+	std::ofstream out_file;
+	out_file.open(filename, std::ios::out | std::ios::binary);
+	out_file << "ply\n";
+	out_file << "format " << (internal::is_little_endian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n";
+	out_file << "element vertex " << nb_vertices << "\n";
+	out_file << "property double x\nproperty double y\nproperty double z\n";
+	internal::write_ply_properties(out_file, vertex_writers);
+	out_file << "element face " << nb_faces << "\n";
+	out_file << "property list " << (max_degree < 256u ? "uchar" : "uint") << " uint vertex_indices\n";
+	internal::write_ply_properties(out_file, face_writers);
+	out_file << "end_header\n";
+
+	std::vector<char> buffer;
+	buffer.reserve(BUFFER_SIZE);
+	auto append = [&](std::size_t size) -> char* {
+		if (buffer.size() + size > BUFFER_SIZE)
+		{
+			out_file.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+		const std::size_t s = buffer.size();
+		buffer.resize(s + size);
+		return buffer.data() + s;
+	};
+
+	const std::size_t vertex_record_size = 3u * sizeof(float64) + internal::ply_record_size(vertex_writers);
+	uint32 id = 0u;
+	foreach_cell(m, [&](Vertex v) -> bool {
+		const uint32 index = index_of(m, v);
+		value<uint32>(m, vertex_id, v) = id++;
+		char* p = append(vertex_record_size);
+		std::memcpy(p, value<geometry::Vec3>(m, vertex_position, v).data(), 3u * sizeof(float64));
+		internal::write_ply_values(p + 3u * sizeof(float64), vertex_writers, index);
+		return true;
+	});
+
+	const std::size_t face_values_size = internal::ply_record_size(face_writers);
+	foreach_cell(m, [&](Face f) -> bool {
+		const uint32 degree = codegree(m, f);
+		char* p;
+		if (max_degree < 256u)
+		{
+			p = append(1u + degree * sizeof(uint32) + face_values_size);
+			*p++ = char(uint8(degree));
+		}
+		else
+		{
+			p = append(sizeof(uint32) + degree * sizeof(uint32) + face_values_size);
+			std::memcpy(p, &degree, sizeof(uint32));
+			p += sizeof(uint32);
+		}
+		foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
+			std::memcpy(p, &value<uint32>(m, vertex_id, v), sizeof(uint32));
+			p += sizeof(uint32);
+			return true;
+		});
+		if (!face_writers.empty())
+			internal::write_ply_values(p, face_writers, index_of(m, f));
+		return true;
+	});
+	out_file.write(buffer.data(), buffer.size());
+
+	remove_attribute<Vertex>(m, vertex_id);
+
+	out_file.close();
 }
 
 } // namespace io
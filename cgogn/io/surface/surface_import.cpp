@@ -31,7 +31,13 @@
 #include <cgogn/core/types/cmap/cmap_ops.h>
 #include <cgogn/core/types/incidence_graph/incidence_graph_ops.h>
 
+#include <cgogn/core/utils/radix_sort.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <set>
 #include <vector>
 
@@ -41,109 +47,271 @@ namespace cgogn
 namespace io
 {
 
-void import_surface_data(CMap2& m, SurfaceImportData& surface_data)
-{
-	using Vertex = CMap2::Vertex;
+using Clock = std::chrono::high_resolution_clock;
 
-	auto position = get_or_add_attribute<geometry::Vec3, Vertex>(m, surface_data.vertex_position_attribute_name_);
+SurfaceImportStream::SurfaceImportStream(CMap2& m, const std::string& vertex_position_attribute_name)
+	: m_(m), position_added_(false)
+{
+	position_ = get_attribute<Vec3, CMap2::Vertex>(m, vertex_position_attribute_name);
+	if (!position_)
+	{
+		position_ = add_attribute<Vec3, CMap2::Vertex>(m, vertex_position_attribute_name);
+		position_added_ = true;
+	}
+}
 
-	for (uint32 i = 0u; i < surface_data.nb_vertices_; ++i)
+void SurfaceImportStream::add_phase_timing(const std::string& name, float64 duration)
+{
+	for (auto& [phase, time] : phase_timings_)
 	{
-		uint32 vertex_id = new_index<Vertex>(m);
-		(*position)[vertex_id] = surface_data.vertex_position_[i];
-		surface_data.vertex_id_after_import_.push_back(vertex_id);
+		if (phase == name)
+		{
+			time += duration;
+			return;
+		}
 	}
+	phase_timings_.emplace_back(name, duration);
+}
 
-	auto darts_per_vertex = add_attribute<std::vector<Dart>, Vertex>(m, "__darts_per_vertex");
+void SurfaceImportStream::add_vertices(const Vec3* positions, uint32 nb_vertices)
+{
+	using Vertex = CMap2::Vertex;
 
-	uint32 faces_vertex_index = 0u;
-	std::vector<uint32> vertices_buffer;
-	vertices_buffer.reserve(16u);
+	auto start = Clock::now();
 
-	for (uint32 i = 0u; i < surface_data.nb_faces_; ++i)
-	{
-		uint32 nbv = surface_data.faces_nb_vertices_[i];
+	const uint32 first = uint32(vertex_id_after_import_.size());
+	for (uint32 i = 0u; i < nb_vertices; ++i)
+		vertex_id_after_import_.push_back(new_index<Vertex>(m_));
 
-		vertices_buffer.clear();
-		uint32 prev = std::numeric_limits<uint32>::max();
+	thread_pool()->parallel_for(0u, nb_vertices, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+			(*position_)[vertex_id_after_import_[first + i]] = positions[i];
+	});
 
-		for (uint32 j = 0u; j < nbv; ++j)
+	add_phase_timing("vertices", std::chrono::duration<float64>(Clock::now() - start).count());
+}
+
+void SurfaceImportStream::add_faces(const uint32* faces_nb_vertices, uint32 nb_faces,
+									const uint32* faces_vertex_indices, Dart* faces_dart)
+{
+	using Vertex = CMap2::Vertex;
+
+	ThreadPool* pool = thread_pool();
+	auto start = Clock::now();
+
+	// faces: consecutive duplicated vertices are removed & degenerated faces are skipped
+	// the cleaned faces of the batch are stored in CSR form (face_offsets, face_vertices)
+
+	std::vector<uint32> input_offsets(nb_faces + 1u);
+	input_offsets[0] = 0u;
+	for (uint32 i = 0u; i < nb_faces; ++i)
+		input_offsets[i + 1] = input_offsets[i] + faces_nb_vertices[i];
+
+	// returns the number of vertices of the cleaned face (0 if degenerated), writes at most capacity of them in out
+	auto clean_face = [&](uint32 f, uint32* out, uint32 capacity) -> uint32 {
+		uint32 nbv = 0u;
+		uint32 first = INVALID_INDEX;
+		uint32 prev = INVALID_INDEX;
+		for (uint32 j = input_offsets[f]; j < input_offsets[f + 1]; ++j)
 		{
-			uint32 idx = surface_data.vertex_id_after_import_[surface_data.faces_vertex_indices_[faces_vertex_index++]];
+			cgogn_message_assert(faces_vertex_indices[j] < vertex_id_after_import_.size(),
+								 "add_faces: face references a vertex that was not added");
+			uint32 idx = vertex_id_after_import_[faces_vertex_indices[j]];
 			if (idx != prev)
 			{
 				prev = idx;
-				vertices_buffer.push_back(idx);
+				if (nbv == 0u)
+					first = idx;
+				if (nbv < capacity)
+					out[nbv] = idx;
+				++nbv;
 			}
 		}
-		if (vertices_buffer.front() == vertices_buffer.back())
-			vertices_buffer.pop_back();
-
-		nbv = uint32(vertices_buffer.size());
-		if (nbv > 2u)
+		if (nbv > 0u && first == prev)
+			--nbv;
+		return nbv > 2u ? nbv : 0u;
+	};
+
+	std::vector<uint32> face_offsets(nb_faces + 1u);
+	face_offsets[0] = 0u;
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 f = b; f < e; ++f)
+			face_offsets[f + 1] = clean_face(f, nullptr, 0u);
+	});
+	for (uint32 f = 0u; f < nb_faces; ++f)
+		face_offsets[f + 1] += face_offsets[f];
+
+	const uint32 nb_halfedges = face_offsets[nb_faces];
+	std::vector<uint32> face_vertices(nb_halfedges);
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 f = b; f < e; ++f)
 		{
-			CMap1::Face f = add_face(static_cast<CMap1&>(m), nbv, false);
-			Dart d = f.dart;
-			for (uint32 j = 0u; j < nbv; ++j)
-			{
-				const uint32 vertex_index = vertices_buffer[j];
-				set_index<Vertex>(m, d, vertex_index);
-				(*darts_per_vertex)[vertex_index].push_back(d);
-				d = phi1(m, d);
-			}
+			if (face_offsets[f + 1] > face_offsets[f])
+				clean_face(f, &face_vertices[face_offsets[f]], face_offsets[f + 1] - face_offsets[f]);
 		}
-	}
+	});
 
-	bool need_vertex_unicity_check = false;
-	uint32 nb_boundary_edges = 0u;
+	auto darts_start = Clock::now();
+	add_phase_timing("faces", std::chrono::duration<float64>(darts_start - start).count());
 
-	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	// darts
+
+	for (uint32 f = 0u; f < nb_faces; ++f)
 	{
-		if (phi2(m, d) == d)
+		const uint32 nbv = face_offsets[f + 1] - face_offsets[f];
+		if (nbv == 0u)
+		{
+			if (faces_dart)
+				faces_dart[f] = Dart();
+			continue;
+		}
+		CMap1::Face face = add_face(static_cast<CMap1&>(m_), nbv, false);
+		if (faces_dart)
+			faces_dart[f] = face.dart;
+		Dart d = face.dart;
+		for (uint32 j = face_offsets[f]; j < face_offsets[f + 1]; ++j)
 		{
-			uint32 vertex_index = index_of(m, Vertex(d));
+			set_index<Vertex>(m_, d, face_vertices[j]);
+			d = phi1(m_, d);
+		}
+	}
+
+	add_phase_timing("darts", std::chrono::duration<float64>(Clock::now() - darts_start).count());
+}
 
-			const std::vector<Dart>& next_vertex_darts =
-				value<std::vector<Dart>>(m, darts_per_vertex, Vertex(phi1(m, d)));
-			bool phi2_found = false;
-			bool first_OK = true;
+void SurfaceImportStream::finish()
+{
+	using Vertex = CMap2::Vertex;
+
+	ThreadPool* pool = thread_pool();
+	auto start = Clock::now();
+
+	// the not yet sewn darts (i.e. the darts of the added faces) are sorted by (min vertex, max vertex) key of their
+	// edge: opposite half-edges become adjacent
+
+	std::vector<Dart> halfedges;
+	for (Dart d = m_.begin(), end = m_.end(); d != end; d = m_.next(d))
+	{
+		if (phi2(m_, d) == d)
+			halfedges.push_back(d);
+	}
+	const uint32 nb_halfedges = uint32(halfedges.size());
 
-			for (auto it = next_vertex_darts.begin(); it != next_vertex_darts.end() && !phi2_found; ++it)
+	const uint32 vertex_bits = nb_bits(m_.attribute_containers_[Vertex::ORBIT].maximum_index());
+	std::vector<uint64> keys(nb_halfedges);
+	pool->parallel_for(0u, nb_halfedges, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint64 v1 = index_of(m_, Vertex(halfedges[i]));
+			uint64 v2 = index_of(m_, Vertex(phi1(m_, halfedges[i])));
+			keys[i] = v1 < v2 ? (v1 << vertex_bits) | v2 : (v2 << vertex_bits) | v1;
+		}
+	});
+	radix_sort(keys, halfedges, 2u * vertex_bits);
+
+	auto sew_start = Clock::now();
+	add_phase_timing("sort", std::chrono::duration<float64>(sew_start - start).count());
+
+	// phi2 sewing of opposite half-edges within each run of equal keys
+
+	std::atomic<uint32> nb_boundary_edges = 0u;
+	pool->parallel_for(0u, nb_halfedges, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		uint32 i = b;
+		// the run that started before b is handled by the previous range
+		while (i > 0u && i < nb_halfedges && keys[i] == keys[i - 1])
+			++i;
+		uint32 nb_boundary = 0u;
+		while (i < e)
+		{
+			uint32 j = i + 1u;
+			while (j < nb_halfedges && keys[j] == keys[i])
+				++j;
+			const uint64 min_vertex = keys[i] >> vertex_bits;
+			for (uint32 p = i; p < j; ++p)
 			{
-				if (index_of(m, Vertex(phi1(m, *it))) == vertex_index)
+				Dart d = halfedges[p];
+				if (index_of(m_, Vertex(d)) != min_vertex || phi2(m_, d) != d)
+					continue;
+				for (uint32 q = i; q < j; ++q)
 				{
-					if (phi2(m, *it) == *it)
+					Dart dd = halfedges[q];
+					if (index_of(m_, Vertex(dd)) != min_vertex && phi2(m_, dd) == dd)
 					{
-						phi2_sew(m, d, *it);
-						phi2_found = true;
+						phi2_sew(m_, d, dd);
+						break;
 					}
-					else
-						first_OK = false;
 				}
 			}
+			for (uint32 p = i; p < j; ++p)
+			{
+				if (phi2(m_, halfedges[p]) == halfedges[p])
+					++nb_boundary;
+			}
+			i = j;
+		}
+		nb_boundary_edges += nb_boundary;
+	});
 
-			if (!phi2_found)
-				++nb_boundary_edges;
+	std::vector<uint64>().swap(keys);
+	std::vector<Dart>().swap(halfedges);
 
-			if (!first_OK)
-				need_vertex_unicity_check = true;
-		}
-	}
+	auto close_start = Clock::now();
+	add_phase_timing("sew", std::chrono::duration<float64>(close_start - sew_start).count());
 
 	if (nb_boundary_edges > 0u)
 	{
-		uint32 nb_holes = close(m);
+		uint32 nb_holes = close(m_);
 		std::cout << nb_holes << " hole(s) have been closed" << std::endl;
 		std::cout << nb_boundary_edges << " boundary edges" << std::endl;
 	}
 
-	// if (need_vertex_unicity_check)
-	// {
-	// 	map_.template enforce_unique_orbit_embedding<Vertex::ORBIT>();
-	// 	cgogn_log_warning("create_map") << "Import Surface: non manifold vertices detected and corrected";
-	// }
+	add_phase_timing("close", std::chrono::duration<float64>(Clock::now() - close_start).count());
+}
+
+void SurfaceImportStream::cancel()
+{
+	using Vertex = CMap2::Vertex;
+
+	// the darts of the added faces are the only ones that are not phi2-sewn (the map was closed before the import)
+	std::vector<Dart> darts;
+	for (Dart d = m_.begin(), end = m_.end(); d != end; d = m_.next(d))
+	{
+		if (phi2(m_, d) == d)
+			darts.push_back(d);
+	}
+
+	// the added vertices are referenced once more during the removal of the darts, so that the vertices that are not
+	// used by any face are released as well
+	auto& vertices = m_.attribute_containers_[Vertex::ORBIT];
+	for (uint32 v : vertex_id_after_import_)
+		vertices.ref_index(v);
+	for (Dart d : darts)
+		remove_dart(m_, d);
+	for (uint32 v : vertex_id_after_import_)
+		vertices.unref_index(v);
+	vertex_id_after_import_.clear();
+
+	if (position_added_)
+	{
+		remove_attribute<Vertex>(m_, position_);
+		position_added_ = false;
+	}
+	position_.reset();
+}
+
+void import_surface_data(CMap2& m, SurfaceImportData& surface_data)
+{
+	SurfaceImportStream stream(m, surface_data.vertex_position_attribute_name_);
+	stream.vertex_id_after_import().swap(surface_data.vertex_id_after_import_);
+	stream.vertex_id_after_import().clear();
+
+	stream.add_vertices(surface_data.vertex_position_.data(), surface_data.nb_vertices_);
+	stream.add_faces(surface_data.faces_nb_vertices_.data(), surface_data.nb_faces_,
+					 surface_data.faces_vertex_indices_.data());
+	stream.finish();
 
-	remove_attribute<Vertex>(m, darts_per_vertex);
+	stream.vertex_id_after_import().swap(surface_data.vertex_id_after_import_);
+	surface_data.phase_timings_ = stream.phase_timings();
 }
 
 void import_surface_data(IncidenceGraph& ig, SurfaceImportData& surface_data)
@@ -211,8 +379,11 @@ void import_surface_data(IncidenceGraph& ig, SurfaceImportData& surface_data)
 				}
 			}
 
-			add_face(ig, face_edges);
+			Face f = add_face(ig, face_edges);
+			surface_data.face_id_after_import_.push_back(f.index_);
 		}
+		else
+			surface_data.face_id_after_import_.push_back(INVALID_INDEX);
 	}
 }
 
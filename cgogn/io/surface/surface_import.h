@@ -31,6 +31,9 @@
 
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace cgogn
@@ -53,6 +56,11 @@ struct SurfaceImportData
 	std::vector<uint32> faces_vertex_indices_;
 
 	std::vector<uint32> vertex_id_after_import_;
+	// index of the face created for each input face (INVALID_INDEX for the skipped faces), IncidenceGraph only
+	std::vector<uint32> face_id_after_import_;
+
+	// duration (in seconds) of each phase of the last import
+	std::vector<std::pair<std::string, float64>> phase_timings_;
 
 	inline void reserve(uint32 nb_vertices, uint32 nb_faces)
 	{
@@ -63,6 +71,86 @@ struct SurfaceImportData
 		faces_vertex_indices_.reserve(nb_faces * 4u);
 		vertex_id_after_import_.reserve(nb_vertices);
 	}
+
+	// same interface as SurfaceImportStream: the added elements are appended to the data
+	inline void add_vertices(const Vec3* positions, uint32 nb_vertices)
+	{
+		vertex_position_.insert(vertex_position_.end(), positions, positions + nb_vertices);
+		nb_vertices_ = uint32(vertex_position_.size());
+	}
+	inline void add_faces(const uint32* faces_nb_vertices, uint32 nb_faces, const uint32* faces_vertex_indices)
+	{
+		uint32 nb_indices = 0u;
+		for (uint32 i = 0u; i < nb_faces; ++i)
+			nb_indices += faces_nb_vertices[i];
+		faces_nb_vertices_.insert(faces_nb_vertices_.end(), faces_nb_vertices, faces_nb_vertices + nb_faces);
+		faces_vertex_indices_.insert(faces_vertex_indices_.end(), faces_vertex_indices,
+									 faces_vertex_indices + nb_indices);
+		nb_faces_ = uint32(faces_nb_vertices_.size());
+	}
+};
+
+/**
+ * @brief incremental construction of a CMap2 from batches of vertices and faces
+ * The faces are turned into darts as soon as they are added, so that the whole input never has to be held in
+ * memory: finish() radix sorts the darts that are not sewn yet by the (min, max) vertex key of their edge, sews the
+ * opposite half-edges that end up adjacent and closes the holes.
+ * All the vertices must be added before the faces that reference them.
+ */
+class CGOGN_IO_EXPORT SurfaceImportStream
+{
+public:
+	SurfaceImportStream(CMap2& m, const std::string& vertex_position_attribute_name = "position");
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(SurfaceImportStream);
+
+	/**
+	 * @brief add the given vertices (their file ids follow the ones of the previously added vertices)
+	 */
+	void add_vertices(const Vec3* positions, uint32 nb_vertices);
+
+	/**
+	 * @brief add the given faces: consecutive duplicated vertices are removed & degenerated faces are skipped
+	 * @param faces_nb_vertices number of vertices of each face
+	 * @param faces_vertex_indices file ids of the vertices of the faces, concatenated
+	 * @param faces_dart if given, receives a dart of each created face (nil for the skipped faces)
+	 */
+	void add_faces(const uint32* faces_nb_vertices, uint32 nb_faces, const uint32* faces_vertex_indices,
+				   Dart* faces_dart = nullptr);
+
+	/**
+	 * @brief phi2-sew the added faces and close the remaining holes
+	 */
+	void finish();
+
+	/**
+	 * @brief remove the vertices & faces added so far (instead of finish(), e.g. when the input turns out to be
+	 * invalid): the map is left as it was before the construction of the stream
+	 */
+	void cancel();
+
+	inline uint32 nb_vertices() const
+	{
+		return uint32(vertex_id_after_import_.size());
+	}
+	inline std::vector<uint32>& vertex_id_after_import()
+	{
+		return vertex_id_after_import_;
+	}
+	// cumulated duration (in seconds) of each phase
+	inline const std::vector<std::pair<std::string, float64>>& phase_timings() const
+	{
+		return phase_timings_;
+	}
+
+private:
+	void add_phase_timing(const std::string& name, float64 duration);
+
+	CMap2& m_;
+	std::shared_ptr<CMap2::Attribute<Vec3>> position_;
+	bool position_added_;
+	std::vector<uint32> vertex_id_after_import_;
+	std::vector<std::pair<std::string, float64>> phase_timings_;
 };
 
 void CGOGN_IO_EXPORT import_surface_data(CMap2& m, SurfaceImportData& surface_data);
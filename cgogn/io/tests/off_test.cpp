@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cmap/cmap2.h>
+#include <cgogn/io/surface/off.h>
+
+#include <fstream>
+
+namespace cgogn
+{
+
+class OFFImportTest : public ::testing::Test
+{
+protected:
+	using Vertex = CMap2::Vertex;
+	using Edge = CMap2::Edge;
+	using Face = CMap2::Face;
+
+	CMap2 map_;
+	std::string filename_;
+
+	void SetUp() override
+	{
+		filename_ = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".off";
+	}
+
+	void TearDown() override
+	{
+		std::remove(filename_.c_str());
+	}
+
+	bool import(const std::string& content)
+	{
+		{
+			std::ofstream out(filename_, std::ios::binary);
+			out << content;
+		}
+		return io::import_OFF(map_, filename_);
+	}
+
+	void expect_square()
+	{
+		EXPECT_EQ(nb_cells<Vertex>(map_), 4u);
+		EXPECT_EQ(nb_cells<Edge>(map_), 5u);
+		EXPECT_EQ(nb_cells<Face>(map_), 2u);
+		EXPECT_TRUE(check_indexing<Vertex>(map_));
+	}
+
+	void expect_empty()
+	{
+		EXPECT_EQ(nb_darts(map_), 0u);
+		EXPECT_EQ(nb_cells<Vertex>(map_), 0u);
+		EXPECT_EQ((get_attribute<geometry::Vec3, Vertex>(map_, "position")), nullptr);
+	}
+};
+
+TEST_F(OFFImportTest, OneRecordPerLine)
+{
+	EXPECT_TRUE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 2 3\n"));
+	expect_square();
+}
+
+TEST_F(OFFImportTest, CommentsAndBlankLines)
+{
+	EXPECT_TRUE(import("OFF\n# square\n4 2 0\n\n0 0 0\n1 0 0 # x\n1 1 0\n\r\n0 1 0\n3 0 1 2\n# face\n3 0 2 3\r\n"));
+	expect_square();
+}
+
+TEST_F(OFFImportTest, WrappedRecords)
+{
+	EXPECT_TRUE(import("OFF\n4 2 0\n0 0\n0 1 0\n0 1 1 0\n0 1 0\n3\n0 1\n2\n3 0 2 3\n"));
+	expect_square();
+}
+
+TEST_F(OFFImportTest, SeveralRecordsPerLine)
+{
+	EXPECT_TRUE(import("OFF\n4 2 0 0 0 0 1 0 0 1 1 0 0 1 0 3 0 1 2 3 0 2 3"));
+	expect_square();
+}
+
+TEST_F(OFFImportTest, VertexIndexOutOfRange)
+{
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 2 4\n"));
+	expect_empty();
+}
+
+TEST_F(OFFImportTest, InvalidNumber)
+{
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 x\n0 1 0\n3 0 1 2\n3 0 2 3\n"));
+	expect_empty();
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 -2 3\n"));
+	expect_empty();
+}
+
+TEST_F(OFFImportTest, Truncated)
+{
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n"));
+	expect_empty();
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 2"));
+	expect_empty();
+}
+
+TEST_F(OFFImportTest, OversizedFace)
+{
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n4294967295 0 2 3\n"));
+	expect_empty();
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n2147483648 0 1 2\n2147483648 0 2 3\n"));
+	expect_empty();
+}
+
+TEST_F(OFFImportTest, InvalidInputLeavesMapUntouched)
+{
+	EXPECT_TRUE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 2 3\n"));
+	EXPECT_FALSE(import("OFF\n4 2 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 2 4\n"));
+	expect_square();
+	EXPECT_EQ(nb_darts(map_), 10u);
+}
+
+} // namespace cgogn
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cmap/cmap2.h>
+#include <cgogn/io/surface/ply.h>
+
+#include <fstream>
+
+namespace cgogn
+{
+
+class PLYImportTest : public ::testing::Test
+{
+protected:
+	using Vertex = CMap2::Vertex;
+
+	CMap2 map_;
+	std::string filename_;
+
+	void SetUp() override
+	{
+		filename_ = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".ply";
+	}
+
+	void TearDown() override
+	{
+		std::remove(filename_.c_str());
+	}
+
+	// binary square made of the faces 0 1 2 & 0 2 last, with a float32 "quality" vertex property
+	bool import_square(uint32 last)
+	{
+		{
+			std::ofstream out(filename_, std::ios::binary);
+			out << "ply\nformat binary_little_endian 1.0\n"
+				<< "element vertex 4\nproperty float x\nproperty float y\nproperty float z\nproperty float quality\n"
+				<< "element face 2\nproperty list uchar int vertex_indices\nend_header\n";
+			const float32 vertices[4][4] = {{0, 0, 0, 1}, {1, 0, 0, 2}, {1, 1, 0, 3}, {0, 1, 0, 4}};
+			out.write(reinterpret_cast<const char*>(vertices), sizeof(vertices));
+			const uint32 faces[2][3] = {{0, 1, 2}, {0, 2, last}};
+			for (const auto& f : faces)
+			{
+				const char nbv = 3;
+				out.write(&nbv, 1);
+				out.write(reinterpret_cast<const char*>(f), sizeof(f));
+			}
+		}
+		return io::import_PLY(map_, filename_);
+	}
+};
+
+TEST_F(PLYImportTest, VertexProperties)
+{
+	EXPECT_TRUE(import_square(3u));
+	EXPECT_EQ(nb_cells<Vertex>(map_), 4u);
+	auto quality = get_attribute<float32, Vertex>(map_, "quality");
+	ASSERT_NE(quality, nullptr);
+	float32 sum = 0.0f;
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		sum += value<float32>(map_, quality, v);
+		return true;
+	});
+	EXPECT_EQ(sum, 10.0f);
+}
+
+TEST_F(PLYImportTest, InvalidInputLeavesMapUntouched)
+{
+	EXPECT_FALSE(import_square(4u));
+	EXPECT_EQ(nb_darts(map_), 0u);
+	EXPECT_EQ((get_attribute<float32, Vertex>(map_, "quality")), nullptr);
+	EXPECT_EQ((get_attribute<geometry::Vec3, Vertex>(map_, "position")), nullptr);
+}
+
+} // namespace cgogn
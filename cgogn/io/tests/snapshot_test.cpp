@@ -0,0 +1,143 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cmap/cmap2.h>
+#include <cgogn/io/snapshot.h>
+#include <cgogn/io/surface/off.h>
+
+#include <fstream>
+
+namespace cgogn
+{
+
+class SnapshotTest : public ::testing::Test
+{
+protected:
+	using Vertex = CMap2::Vertex;
+	using Edge = CMap2::Edge;
+	using Face = CMap2::Face;
+
+	CMap2 map_;
+	CMap2 loaded_;
+	std::string filename_;
+
+	void SetUp() override
+	{
+		filename_ = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".snapshot";
+
+		const std::string off_filename = filename_ + ".off";
+		{
+			std::ofstream out(off_filename, std::ios::binary);
+			out << "OFF\n5 3 0\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n2 0 0\n3 0 1 2\n3 0 2 3\n3 1 4 2\n";
+		}
+		io::import_OFF(map_, off_filename);
+		std::remove(off_filename.c_str());
+	}
+
+	void TearDown() override
+	{
+		std::remove(filename_.c_str());
+	}
+};
+
+TEST_F(SnapshotTest, RoundTrip)
+{
+	auto vertex_position = get_attribute<geometry::Vec3, Vertex>(map_, "position");
+	auto vertex_flag = add_attribute<bool, Vertex>(map_, "flag");
+	auto face_id = add_attribute<uint32, Face>(map_, "id");
+	index_cells<Edge>(map_);
+
+	uint32 i = 0u;
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		value<bool>(map_, vertex_flag, v) = i++ % 2u == 0u;
+		return true;
+	});
+	i = 0u;
+	foreach_cell(map_, [&](Face f) -> bool {
+		value<uint32>(map_, face_id, f) = 10u * i++;
+		return true;
+	});
+
+	ASSERT_TRUE(io::save_snapshot(map_, filename_));
+	ASSERT_TRUE(io::load_snapshot(loaded_, filename_));
+
+	EXPECT_EQ(nb_darts(loaded_), nb_darts(map_));
+	EXPECT_EQ(nb_cells<Vertex>(loaded_), nb_cells<Vertex>(map_));
+	EXPECT_EQ(nb_cells<Edge>(loaded_), nb_cells<Edge>(map_));
+	EXPECT_EQ(nb_cells<Face>(loaded_), nb_cells<Face>(map_));
+	EXPECT_TRUE(check_indexing<Vertex>(loaded_));
+	EXPECT_TRUE(check_indexing<Edge>(loaded_));
+	EXPECT_TRUE(check_indexing<Face>(loaded_));
+
+	// the darts are restored with their indices: the cells can be compared dart by dart
+	for (Dart d = map_.begin(), end = map_.end(); d != end; d = map_.next(d))
+	{
+		EXPECT_EQ(phi1(loaded_, d), phi1(map_, d));
+		EXPECT_EQ(phi2(loaded_, d), phi2(map_, d));
+		EXPECT_EQ(is_boundary(loaded_, d), is_boundary(map_, d));
+	}
+
+	auto loaded_position = get_attribute<geometry::Vec3, Vertex>(loaded_, "position");
+	auto loaded_flag = get_attribute<bool, Vertex>(loaded_, "flag");
+	auto loaded_id = get_attribute<uint32, Face>(loaded_, "id");
+	ASSERT_NE(loaded_position, nullptr);
+	ASSERT_NE(loaded_flag, nullptr);
+	ASSERT_NE(loaded_id, nullptr);
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		EXPECT_EQ(value<geometry::Vec3>(loaded_, loaded_position, v), value<geometry::Vec3>(map_, vertex_position, v));
+		EXPECT_EQ(value<bool>(loaded_, loaded_flag, v), value<bool>(map_, vertex_flag, v));
+		return true;
+	});
+	foreach_cell(map_, [&](Face f) -> bool {
+		EXPECT_EQ(value<uint32>(loaded_, loaded_id, f), value<uint32>(map_, face_id, f));
+		return true;
+	});
+}
+
+TEST_F(SnapshotTest, NonEmptyMap)
+{
+	ASSERT_TRUE(io::save_snapshot(map_, filename_));
+	EXPECT_FALSE(io::load_snapshot(map_, filename_));
+}
+
+TEST_F(SnapshotTest, Truncated)
+{
+	ASSERT_TRUE(io::save_snapshot(map_, filename_));
+	std::string content;
+	{
+		std::ifstream in(filename_, std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	{
+		std::ofstream out(filename_, std::ios::binary | std::ios::trunc);
+		out.write(content.data(), content.size() / 2u);
+	}
+	EXPECT_FALSE(io::load_snapshot(loaded_, filename_));
+}
+
+} // namespace cgogn
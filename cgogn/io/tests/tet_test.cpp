@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cmap/cmap3.h>
+#include <cgogn/io/volume/tet.h>
+
+#include <fstream>
+
+namespace cgogn
+{
+
+class TETImportTest : public ::testing::Test
+{
+protected:
+	using Vertex = CMap3::Vertex;
+	using Face = CMap3::Face;
+	using Volume = CMap3::Volume;
+
+	CMap3 map_;
+	std::string filename_;
+
+	void SetUp() override
+	{
+		filename_ = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".tet";
+	}
+
+	void TearDown() override
+	{
+		std::remove(filename_.c_str());
+	}
+
+	bool import(const std::string& content)
+	{
+		{
+			std::ofstream out(filename_, std::ios::binary);
+			out << content;
+		}
+		return io::import_TET(map_, filename_);
+	}
+
+	// two tetrahedra sharing the face 0 1 2
+	void expect_two_tetras()
+	{
+		EXPECT_EQ(nb_cells<Vertex>(map_), 5u);
+		EXPECT_EQ(nb_cells<Face>(map_), 7u);
+		EXPECT_EQ(nb_darts(map_), 42u);
+		EXPECT_TRUE(check_indexing<Vertex>(map_));
+	}
+
+	void expect_empty()
+	{
+		EXPECT_EQ(nb_darts(map_), 0u);
+		EXPECT_EQ(nb_cells<Vertex>(map_), 0u);
+		EXPECT_EQ((get_attribute<geometry::Vec3, Vertex>(map_, "position")), nullptr);
+	}
+};
+
+TEST_F(TETImportTest, OneRecordPerLine)
+{
+	EXPECT_TRUE(import("5 vertices\n2 tets\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n0 0 -1\n4 0 1 2 3\n4 0 1 2 4\n"));
+	expect_two_tetras();
+}
+
+TEST_F(TETImportTest, WrappedRecords)
+{
+	EXPECT_TRUE(import("5 vertices\n2 tets\n0 0\n0 1 0 0 0 1 0\n0 0 1\n0 0 -1\n4\n0 1 2\n3\n4 0 1\n2 4\n"));
+	expect_two_tetras();
+}
+
+TEST_F(TETImportTest, SeveralRecordsPerLine)
+{
+	EXPECT_TRUE(import("5\n2\n0 0 0 1 0 0 0 1 0 0 0 1 0 0 -1\n4 0 1 2 3 4 0 1 2 4\n"));
+	expect_two_tetras();
+}
+
+TEST_F(TETImportTest, UnhandledVolumesAreSkipped)
+{
+	EXPECT_TRUE(import("5\n4\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n0 0 -1\n4 0 1 2 3\n3 0 1\n2\n7 0 1 2 3 4 0 1\n4 0 1 2 4\n"));
+	expect_two_tetras();
+}
+
+TEST_F(TETImportTest, VertexIndexOutOfRange)
+{
+	EXPECT_FALSE(import("5\n2\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n0 0 -1\n4 0 1 2 3\n4 0 1 2 5\n"));
+	expect_empty();
+}
+
+TEST_F(TETImportTest, Truncated)
+{
+	EXPECT_FALSE(import("5\n2\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n0 0 -1\n4 0 1 2 3\n"));
+	expect_empty();
+	EXPECT_FALSE(import("5\n2\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n"));
+	expect_empty();
+}
+
+TEST_F(TETImportTest, OversizedVolume)
+{
+	EXPECT_FALSE(import("5\n2\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n0 0 -1\n4 0 1 2 3\n4294967295 0 1 2 4\n"));
+	expect_empty();
+}
+
+TEST_F(TETImportTest, InvalidHeader)
+{
+	EXPECT_FALSE(import("vertices\n2\n"));
+	expect_empty();
+}
+
+} // namespace cgogn
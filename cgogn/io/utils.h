@@ -25,9 +25,23 @@
 #define CGOGN_IO_UTILS_H_
 
 #include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
 
+#include <charconv>
 #include <clocale>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace cgogn
 {
@@ -104,6 +118,335 @@ inline uint32 read_uint(std::istream& fp, std::string& line)
 	return uint32((std::stoul(line)));
 }
 
+/**
+ * @brief read-only view over the whole content of a file
+ * (memory-mapped when available, read in memory otherwise)
+ */
+class MappedFile
+{
+public:
+	inline MappedFile(const std::string& filename) : data_(nullptr), size_(0u)
+	{
+#ifdef _WIN32
+		std::ifstream fp(filename, std::ios::in | std::ios::binary);
+		if (!fp.good())
+			return;
+		fp.seekg(0, std::ios::end);
+		buffer_.resize(std::size_t(fp.tellg()));
+		fp.seekg(0, std::ios::beg);
+		fp.read(buffer_.data(), buffer_.size());
+		data_ = buffer_.data();
+		size_ = buffer_.size();
+		open_ = true;
+#else
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			return;
+		struct stat st;
+		if (::fstat(fd, &st) == 0)
+		{
+			open_ = true;
+			size_ = std::size_t(st.st_size);
+			if (size_ > 0u)
+			{
+				void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED)
+				{
+					data_ = static_cast<const char*>(p);
+					::madvise(p, size_, MADV_WILLNEED);
+				}
+				else
+				{
+					open_ = false;
+					size_ = 0u;
+				}
+			}
+		}
+		::close(fd);
+#endif
+	}
+
+	inline ~MappedFile()
+	{
+#ifndef _WIN32
+		if (data_ != nullptr)
+			::munmap(const_cast<char*>(data_), size_);
+#endif
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(MappedFile);
+
+	inline bool is_open() const
+	{
+		return open_;
+	}
+	inline const char* begin() const
+	{
+		return data_;
+	}
+	inline const char* end() const
+	{
+		return data_ + size_;
+	}
+	inline std::size_t size() const
+	{
+		return size_;
+	}
+
+	/**
+	 * @brief let the system reclaim the memory of the (whole) pages of the file that precede the given position
+	 * (they are read again from the file if they are accessed afterwards)
+	 */
+	inline void release_until(const char* position) const
+	{
+#ifndef _WIN32
+		if (data_ == nullptr || position <= data_)
+			return;
+		const std::size_t page_size = std::size_t(::sysconf(_SC_PAGESIZE));
+		const std::size_t length = std::size_t(position - data_) / page_size * page_size;
+		if (length > 0u)
+			::madvise(const_cast<char*>(data_), length, MADV_DONTNEED);
+#else
+		unused_parameters(position);
+#endif
+	}
+
+private:
+	const char* data_;
+	std::size_t size_;
+	bool open_ = false;
+#ifdef _WIN32
+	std::vector<char> buffer_;
+#endif
+};
+
+/**
+ * @brief zero-copy tokenizer over a character range.
+ * Numbers are parsed with std::from_chars: parsing does not depend on the current locale.
+ * Comments start with '#' and end with the line.
+ */
+class TextCursor
+{
+public:
+	inline TextCursor(const char* begin, const char* end) : cur_(begin), end_(end)
+	{
+	}
+
+	inline const char* position() const
+	{
+		return cur_;
+	}
+	inline bool at_end() const
+	{
+		return cur_ >= end_;
+	}
+
+	// skip white spaces, line breaks and comments
+	inline void skip_blanks()
+	{
+		while (cur_ < end_)
+		{
+			if (*cur_ == '#')
+				skip_line();
+			else if (is_space(*cur_) || *cur_ == '\n' || *cur_ == '\r')
+				++cur_;
+			else
+				break;
+		}
+	}
+
+	// go to the beginning of the next line
+	inline void skip_line()
+	{
+		const void* eol = std::memchr(cur_, '\n', std::size_t(end_ - cur_));
+		cur_ = eol ? static_cast<const char*>(eol) + 1 : end_;
+	}
+
+	// true if the current line has no more token (the cursor is left on the line)
+	inline bool end_of_line()
+	{
+		while (cur_ < end_ && is_space(*cur_))
+			++cur_;
+		return cur_ >= end_ || *cur_ == '\n' || *cur_ == '\r' || *cur_ == '#';
+	}
+
+	// next token of the current line (empty at the end of the line)
+	inline std::string_view token()
+	{
+		if (end_of_line())
+			return std::string_view();
+		const char* b = cur_;
+		while (cur_ < end_ && !is_space(*cur_) && *cur_ != '\n' && *cur_ != '\r')
+			++cur_;
+		return std::string_view(b, std::size_t(cur_ - b));
+	}
+
+	// rest of the current line, the cursor goes to the beginning of the next line
+	inline std::string_view line()
+	{
+		const char* b = cur_;
+		skip_line();
+		const char* e = cur_;
+		while (e > b && (e[-1] == '\n' || e[-1] == '\r'))
+			--e;
+		return std::string_view(b, std::size_t(e - b));
+	}
+
+	// read a number of the current line
+	template <typename T>
+	inline bool read(T& value)
+	{
+		if (end_of_line())
+			return false;
+		if (*cur_ == '+')
+			++cur_;
+		auto [ptr, ec] = std::from_chars(cur_, end_, value);
+		if (ec != std::errc())
+			return false;
+		cur_ = ptr;
+		return true;
+	}
+
+	// read a number possibly preceded by line breaks or comments
+	template <typename T>
+	inline bool next(T& value)
+	{
+		skip_blanks();
+		return read(value);
+	}
+
+private:
+	static inline bool is_space(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+	}
+
+	const char* cur_;
+	const char* end_;
+};
+
+/**
+ * @brief true if the line starting at l is neither blank nor a comment
+ */
+inline bool is_data_line(const char* l, const char* end)
+{
+	while (l < end && (*l == ' ' || *l == '\t' || *l == '\r'))
+		++l;
+	return l < end && *l != '\n' && *l != '#';
+}
+
+/**
+ * @brief beginnings of the lines of [begin, end) that are neither blank nor comments, in order.
+ * The range is scanned in parallel.
+ */
+inline std::vector<const char*> data_lines(const char* begin, const char* end)
+{
+	static const std::size_t MIN_PART_SIZE = 1u << 20;
+
+	const std::size_t size = std::size_t(end - begin);
+	ThreadPool* pool = thread_pool();
+	const uint32 nb_parts =
+		uint32(std::max<std::size_t>(1u, std::min<std::size_t>(pool->nb_workers() * 4u, size / MIN_PART_SIZE)));
+	std::vector<std::vector<const char*>> part_lines(nb_parts);
+
+	pool->parallel_for(0u, nb_parts, 1u, [&](uint32 b, uint32 e) {
+		for (uint32 p = b; p < e; ++p)
+		{
+			const char* part_begin = begin + size * p / nb_parts;
+			const char* part_end = begin + size * (p + 1u) / nb_parts;
+			// a line belongs to the part where it starts
+			const char* l = part_begin;
+			if (l > begin && l[-1] != '\n')
+			{
+				const void* eol = std::memchr(l, '\n', std::size_t(end - l));
+				l = eol ? static_cast<const char*>(eol) + 1 : end;
+			}
+			std::vector<const char*>& lines = part_lines[p];
+			lines.reserve(std::size_t(part_end - part_begin) / 32u);
+			while (l < part_end)
+			{
+				if (is_data_line(l, end))
+					lines.push_back(l);
+				const void* eol = std::memchr(l, '\n', std::size_t(end - l));
+				l = eol ? static_cast<const char*>(eol) + 1 : end;
+			}
+		}
+	});
+
+	std::size_t nb_lines = 0u;
+	for (const auto& lines : part_lines)
+		nb_lines += lines.size();
+	std::vector<const char*> result;
+	result.reserve(nb_lines);
+	for (const auto& lines : part_lines)
+		result.insert(result.end(), lines.begin(), lines.end());
+	return result;
+}
+
+// number of elements parsed & handed to the map construction at once by the streaming importers
+const uint32 IMPORT_BATCH_SIZE = 1u << 16;
+
+/**
+ * @brief sequential reader of the data lines (see data_lines) of [begin, end), batch by batch
+ * Only the beginnings of the lines of the current batch are stored.
+ * Records are usually written one per line, so that the lines of a batch can be parsed concurrently; the importers
+ * check that each record ends with its line and parse the batch again token by token (with a TextCursor started at
+ * its first line) otherwise.
+ */
+class DataLineReader
+{
+public:
+	inline DataLineReader(const char* begin, const char* end) : current_(begin), end_(end)
+	{
+	}
+
+	/**
+	 * @brief replace the content of lines by the beginnings of the (at most) max_lines next data lines
+	 * @return the number of lines read
+	 */
+	inline uint32 next_batch(uint32 max_lines, std::vector<const char*>& lines)
+	{
+		lines.clear();
+		while (current_ < end_ && lines.size() < max_lines)
+		{
+			if (is_data_line(current_, end_))
+				lines.push_back(current_);
+			const void* eol = std::memchr(current_, '\n', std::size_t(end_ - current_));
+			current_ = eol ? static_cast<const char*>(eol) + 1 : end_;
+		}
+		return uint32(lines.size());
+	}
+
+	inline bool at_end() const
+	{
+		return current_ >= end_;
+	}
+	inline const char* position() const
+	{
+		return current_;
+	}
+
+	// continue the reading from the given position (e.g. after some records have been read token by token)
+	inline void seek(const char* position)
+	{
+		current_ = position;
+	}
+
+private:
+	const char* current_;
+	const char* end_;
+};
+
+/**
+ * @brief upper bound of the number of numbers written in [begin, end): each one takes at least a character and is
+ * followed by a separator (except the last one)
+ * Used to reject the element sizes read in a file before allocating anything for them.
+ */
+inline uint64 max_nb_numbers(const char* begin, const char* end)
+{
+	return begin < end ? (uint64(end - begin) + 1u) / 2u : 0u;
+}
+
 } // namespace io
 
 } // namespace cgogn
@@ -33,6 +33,10 @@
 #include <cgogn/geometry/functions/orientation.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <vector>
 
@@ -42,115 +46,271 @@ namespace cgogn
 namespace io
 {
 
-template <typename MESH>
-bool import_TET(MESH& m, const std::string& filename)
+namespace internal
 {
-	static_assert(mesh_traits<MESH>::dimension == 3, "MESH dimension should be 3");
-
-	using Vertex = typename MESH::Vertex;
-
-	Scoped_C_Locale loc;
-
-	VolumeImportData volume_data;
-
-	std::ifstream fp(filename, std::ios::in);
-
-	std::string line;
-	line.reserve(512u);
-
-	// read number of vertices
-	uint32 nb_vertices = read_uint(fp, line);
-	getline_safe(fp, line);
 
-	uint32 nb_volumes = read_uint(fp, line);
-	getline_safe(fp, line);
+/**
+ * @brief read the vertices & volumes of a TET file batch by batch and hand them to the given stream
+ * The records of a batch are parsed concurrently, one per line; the batches where a record does not end with its line
+ * (wrapped records, several records on a line) are parsed again token by token.
+ * @return false if the file is not valid (the elements read so far have been handed to the stream, that has to be
+ * cancelled)
+ */
+inline bool read_TET_elements(const MappedFile& file, DataLineReader& reader, uint32 nb_vertices, uint32 nb_volumes,
+							  VolumeImportStream& stream, const std::string& filename)
+{
+	ThreadPool* pool = thread_pool();
+	std::atomic<bool> one_per_line = true;
+	std::vector<const char*> lines;
+	lines.reserve(IMPORT_BATCH_SIZE);
 
-	if (nb_vertices == 0u)
-	{
-		std::cerr << "File \"" << filename << " has no vertices." << std::endl;
+	auto invalid = [&]() -> bool {
+		std::cerr << "File \"" << filename << "\" is not a valid tet file." << std::endl;
 		return false;
-	}
-
-	volume_data.reserve(nb_vertices, nb_volumes);
+	};
+	auto truncated = [&]() -> bool {
+		std::cerr << "File \"" << filename << "\" is truncated." << std::endl;
+		return false;
+	};
 
 	// read vertices position
-	for (uint32 i = 0u; i < nb_vertices; ++i)
+	std::vector<Vec3> positions;
+	for (uint32 nb_read = 0u; nb_read < nb_vertices;)
 	{
-		float64 x = read_double(fp, line);
-		float64 y = read_double(fp, line);
-		float64 z = read_double(fp, line);
-		volume_data.vertex_position_.push_back({x, y, z});
+		const uint32 n = reader.next_batch(std::min(IMPORT_BATCH_SIZE, nb_vertices - nb_read), lines);
+		if (n == 0u)
+			return truncated();
+		positions.resize(n);
+		one_per_line = true;
+		pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				TextCursor c(lines[i], file.end());
+				float64 x, y, z;
+				if (!c.read(x) || !c.read(y) || !c.read(z) || !c.end_of_line())
+					one_per_line = false;
+				else
+					positions[i] = {x, y, z};
+			}
+		});
+		if (!one_per_line)
+		{
+			TextCursor c(lines[0], file.end());
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				float64 x, y, z;
+				if (!c.next(x) || !c.next(y) || !c.next(z))
+					return c.at_end() ? truncated() : invalid();
+				positions[i] = {x, y, z};
+			}
+			reader.seek(c.position());
+		}
+		stream.add_vertices(positions.data(), n);
+		file.release_until(reader.position());
+		nb_read += n;
 	}
 
-	// read volumes
-	for (uint32 i = 0u; i < nb_volumes; ++i)
-	{
-		uint32 n = read_uint(fp, line);
-		std::vector<uint32> ids(n);
-		for (uint32 j = 0u; j < n; ++j)
-			ids[j] = read_uint(fp, line);
+	// read volumes: number of vertices then vertex indices (the ones of unhandled volumes are skipped)
+	std::vector<std::array<uint32, 8>> volumes_ids;
+	std::vector<uint32> volumes_nb_vertices;
 
-		switch (n)
+	// within_line: the volume has to end with the line of c, otherwise it may span several lines
+	auto read_volume = [&](TextCursor& c, uint32 i, bool within_line) -> bool {
+		auto read = [&](uint32& value) -> bool { return within_line ? c.read(value) : c.next(value); };
+		uint32& nbv = volumes_nb_vertices[i];
+		if (!read(nbv))
+			return false;
+		const void* eol = nullptr;
+		if (within_line)
+			eol = std::memchr(c.position(), '\n', std::size_t(file.end() - c.position()));
+		else
+			c.skip_blanks();
+		if (nbv > max_nb_numbers(c.position(), eol ? static_cast<const char*>(eol) : file.end()))
+			return false;
+		for (uint32 j = 0u; j < nbv; ++j)
 		{
-		case 4: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]],
-											  volume_data.vertex_position_[ids[3]]) == geometry::Orientation3D::UNDER)
-				std::swap(ids[1], ids[2]);
-			volume_data.volumes_types_.push_back(VolumeType::Tetra);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
-			break;
-		}
-		case 5: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[4]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
-				std::swap(ids[1], ids[3]);
-			volume_data.volumes_types_.push_back(VolumeType::Pyramid);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
-			break;
+			uint32 index;
+			if (!read(index))
+				return false;
+			if (j < 8u)
+				volumes_ids[i][j] = index;
 		}
-		case 6: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[3]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+		if (nbv != 4u && nbv != 5u && nbv != 6u && nbv != 8u)
+			nbv = 0u;
+		return !within_line || c.end_of_line();
+	};
+
+	std::vector<VolumeType> volumes_types;
+	std::vector<uint32> volumes_vertex_indices;
+	std::atomic<bool> valid = true;
+	uint32 nb_ignored = 0u;
+	for (uint32 nb_read = 0u; nb_read < nb_volumes;)
+	{
+		const uint32 n = reader.next_batch(std::min(IMPORT_BATCH_SIZE, nb_volumes - nb_read), lines);
+		if (n == 0u)
+			return truncated();
+		volumes_ids.resize(n);
+		volumes_nb_vertices.resize(n);
+		one_per_line = true;
+		pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
 			{
-				std::swap(ids[1], ids[2]);
-				std::swap(ids[4], ids[5]);
+				TextCursor c(lines[i], file.end());
+				if (!read_volume(c, i, true))
+					one_per_line = false;
 			}
-			volume_data.volumes_types_.push_back(VolumeType::TriangularPrism);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
-			break;
-		}
-		case 8: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[4]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+		});
+		if (!one_per_line)
+		{
+			TextCursor c(lines[0], file.end());
+			for (uint32 i = 0u; i < n; ++i)
 			{
-				std::swap(ids[0], ids[3]);
-				std::swap(ids[1], ids[2]);
-				std::swap(ids[4], ids[7]);
-				std::swap(ids[5], ids[6]);
+				if (!read_volume(c, i, false))
+					return c.at_end() ? truncated() : invalid();
 			}
-			volume_data.volumes_types_.push_back(VolumeType::Hexa);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
-			break;
+			reader.seek(c.position());
 		}
-		default:
-			std::cout << "import_TET: Elements with " << n << " vertices are not handled. Ignoring.";
-			break;
+
+		// check the indices & fix the orientation of the volumes
+		pool->parallel_for(0u, n, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				const uint32 nbv = volumes_nb_vertices[i];
+				std::array<uint32, 8>& ids = volumes_ids[i];
+				if (std::any_of(ids.begin(), ids.begin() + nbv, [&](uint32 id) { return id >= nb_vertices; }))
+				{
+					valid = false;
+					continue;
+				}
+
+				auto position = [&](uint32 j) -> const Vec3& { return stream.vertex_position(ids[j]); };
+				switch (nbv)
+				{
+				case 4: {
+					if (geometry::test_orientation_3D(position(0), position(1), position(2), position(3)) ==
+						geometry::Orientation3D::UNDER)
+						std::swap(ids[1], ids[2]);
+					break;
+				}
+				case 5: {
+					if (geometry::test_orientation_3D(position(4), position(0), position(1), position(2)) ==
+						geometry::Orientation3D::OVER)
+						std::swap(ids[1], ids[3]);
+					break;
+				}
+				case 6: {
+					if (geometry::test_orientation_3D(position(3), position(0), position(1), position(2)) ==
+						geometry::Orientation3D::OVER)
+					{
+						std::swap(ids[1], ids[2]);
+						std::swap(ids[4], ids[5]);
+					}
+					break;
+				}
+				case 8: {
+					if (geometry::test_orientation_3D(position(4), position(0), position(1), position(2)) ==
+						geometry::Orientation3D::OVER)
+					{
+						std::swap(ids[0], ids[3]);
+						std::swap(ids[1], ids[2]);
+						std::swap(ids[4], ids[7]);
+						std::swap(ids[5], ids[6]);
+					}
+					break;
+				}
+				}
+			}
+		});
+		if (!valid)
+			return invalid();
+
+		volumes_types.clear();
+		volumes_vertex_indices.clear();
+		for (uint32 i = 0u; i < n; ++i)
+		{
+			switch (volumes_nb_vertices[i])
+			{
+			case 4:
+				volumes_types.push_back(VolumeType::Tetra);
+				break;
+			case 5:
+				volumes_types.push_back(VolumeType::Pyramid);
+				break;
+			case 6:
+				volumes_types.push_back(VolumeType::TriangularPrism);
+				break;
+			case 8:
+				volumes_types.push_back(VolumeType::Hexa);
+				break;
+			default:
+				++nb_ignored;
+				continue;
+			}
+			volumes_vertex_indices.insert(volumes_vertex_indices.end(), volumes_ids[i].begin(),
+										  volumes_ids[i].begin() + volumes_nb_vertices[i]);
 		}
+		stream.add_volumes(volumes_types.data(), uint32(volumes_types.size()), volumes_vertex_indices.data());
+		file.release_until(reader.position());
+		nb_read += n;
 	}
 
-	import_volume_data(m, volume_data);
+	if (nb_ignored > 0u)
+		std::cout << "import_TET: " << nb_ignored << " elements with unhandled number of vertices. Ignoring."
+				  << std::endl;
+
+	return true;
+}
+
+} // namespace internal
+
+/**
+ * @brief import a TET file
+ * The map is built while the file is read, by batches of IMPORT_BATCH_SIZE elements (see VolumeImportStream).
+ * If the file turns out to be invalid, the elements added so far are removed and the mesh is left untouched.
+ */
+template <typename MESH>
+bool import_TET(MESH& m, const std::string& filename)
+{
+	static_assert(mesh_traits<MESH>::dimension == 3, "MESH dimension should be 3");
+
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "File \"" << filename << "\" could not be opened." << std::endl;
+		return false;
+	}
+
+	TextCursor header(file.begin(), file.end());
+
+	// read number of vertices & volumes (each one on its own line)
+	uint32 nb_vertices = 0u, nb_volumes = 0u;
+	if (!header.next(nb_vertices))
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid tet file." << std::endl;
+		return false;
+	}
+	header.skip_line();
+	if (!header.next(nb_volumes))
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid tet file." << std::endl;
+		return false;
+	}
+	header.skip_line();
+
+	if (nb_vertices == 0u)
+	{
+		std::cerr << "File \"" << filename << " has no vertices." << std::endl;
+		return false;
+	}
+
+	DataLineReader reader(header.position(), file.end());
+	VolumeImportStream stream(m);
+	if (!internal::read_TET_elements(file, reader, nb_vertices, nb_volumes, stream, filename))
+	{
+		stream.cancel();
+		return false;
+	}
+	stream.finish();
 
 	return true;
 }
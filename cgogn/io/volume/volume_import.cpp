@@ -29,6 +29,13 @@
 
 #include <cgogn/core/types/cmap/cmap_ops.h>
 
+#include <cgogn/core/utils/radix_sort.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <vector>
 
 namespace cgogn
@@ -37,223 +44,386 @@ namespace cgogn
 namespace io
 {
 
-void import_volume_data(CMap3& m, VolumeImportData& volume_data)
+namespace
+{
+
+/**
+ * topology of a volume type, expressed with local dart indices (0 .. nb_darts - 1):
+ * the volumes of the imported maps are copies of these templates
+ */
+struct VolumeTemplate
+{
+	uint32 nb_darts_ = 0u;
+	uint32 nb_vertices_ = 0u;
+	std::vector<uint32> phi1_;
+	std::vector<uint32> phi_1_;
+	std::vector<uint32> phi2_;
+	std::vector<uint32> vertex_slot_; // index of the vertex of each dart in the vertex list of the volume
+	std::vector<uint32> faces_;		  // a dart of each face
+};
+
+VolumeTemplate build_volume_template(VolumeType vol_type)
 {
-	using Vertex = CMap3::Vertex;
 	using Volume = CMap3::Volume;
 
-	auto position = get_attribute<geometry::Vec3, Vertex>(m, volume_data.vertex_position_attribute_name_);
-	if (!position)
-		position = add_attribute<geometry::Vec3, Vertex>(m, volume_data.vertex_position_attribute_name_);
+	CMap3 m;
+	Volume vol;
+	std::vector<Dart> vertices;
 
-	for (uint32 i = 0u; i < volume_data.nb_vertices_; ++i)
+	if (vol_type == VolumeType::Tetra)
+	{
+		vol = add_pyramid(static_cast<CMap2&>(m), 3u, false);
+		vertices = {vol.dart, phi1(m, vol.dart), phi_1(m, vol.dart), phi_1(m, phi2(m, phi_1(m, vol.dart)))};
+	}
+	else if (vol_type == VolumeType::Pyramid)
+	{
+		vol = add_pyramid(static_cast<CMap2&>(m), 4u, false);
+		vertices = {vol.dart, phi1(m, vol.dart), phi1(m, phi1(m, vol.dart)), phi_1(m, vol.dart),
+					phi_1(m, phi2(m, phi_1(m, vol.dart)))};
+	}
+	else if (vol_type == VolumeType::TriangularPrism)
+	{
+		vol = add_prism(static_cast<CMap2&>(m), 3u, false);
+		vertices = {vol.dart,
+					phi1(m, vol.dart),
+					phi_1(m, vol.dart),
+					phi2(m, phi1(m, phi1(m, phi2(m, phi_1(m, vol.dart))))),
+					phi2(m, phi1(m, phi1(m, phi2(m, vol.dart)))),
+					phi2(m, phi1(m, phi1(m, phi2(m, phi1(m, vol.dart)))))};
+	}
+	else if (vol_type == VolumeType::Hexa)
 	{
-		uint32 vertex_id = new_index<Vertex>(m);
-		(*position)[vertex_id] = volume_data.vertex_position_[i];
-		volume_data.vertex_id_after_import_.push_back(vertex_id);
+		vol = add_prism(static_cast<CMap2&>(m), 4u, false);
+		vertices = {vol.dart,
+					phi1(m, vol.dart),
+					phi1(m, phi1(m, vol.dart)),
+					phi_1(m, vol.dart),
+					phi2(m, phi1(m, phi1(m, phi2(m, phi_1(m, vol.dart))))),
+					phi2(m, phi1(m, phi1(m, phi2(m, vol.dart)))),
+					phi2(m, phi1(m, phi1(m, phi2(m, phi1(m, vol.dart))))),
+					phi2(m, phi1(m, phi1(m, phi2(m, phi1(m, phi1(m, vol.dart))))))};
 	}
+	else
+		return VolumeTemplate();
+
+	// the darts of a new map are indexed from 0
+	VolumeTemplate t;
+	t.nb_darts_ = m.darts_.maximum_index();
+	t.nb_vertices_ = uint32(vertices.size());
+	t.phi1_.resize(t.nb_darts_);
+	t.phi_1_.resize(t.nb_darts_);
+	t.phi2_.resize(t.nb_darts_);
+	t.vertex_slot_.resize(t.nb_darts_);
+	std::vector<bool> in_face(t.nb_darts_, false);
+	for (uint32 d = 0u; d < t.nb_darts_; ++d)
+	{
+		t.phi1_[d] = phi1(m, Dart(d)).index;
+		t.phi_1_[d] = phi_1(m, Dart(d)).index;
+		t.phi2_[d] = phi2(m, Dart(d)).index;
+		if (!in_face[d])
+		{
+			t.faces_.push_back(d);
+			Dart it(d);
+			do
+			{
+				in_face[it.index] = true;
+				it = phi1(m, it);
+			} while (it.index != d);
+		}
+	}
+	for (uint32 slot = 0u; slot < t.nb_vertices_; ++slot)
+	{
+		foreach_dart_of_orbit(m, CMap3::Vertex2(vertices[slot]), [&](Dart d) -> bool {
+			t.vertex_slot_[d.index] = slot;
+			return true;
+		});
+	}
+
+	return t;
+}
+
+// template of the given volume type (nullptr for connectors, which are not built)
+const VolumeTemplate* volume_template(VolumeType vol_type)
+{
+	static const std::array<VolumeTemplate, 4> templates = {
+		build_volume_template(VolumeType::Tetra), build_volume_template(VolumeType::Pyramid),
+		build_volume_template(VolumeType::TriangularPrism), build_volume_template(VolumeType::Hexa)};
+	return vol_type < VolumeType::Connector ? &templates[vol_type] : nullptr;
+}
 
-	auto darts_per_vertex = add_attribute<std::vector<Dart>, Vertex>(m, "__darts_per_vertex");
+inline uint64 mix_hash(uint64 h)
+{
+	h ^= h >> 33u;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33u;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33u;
+	return h;
+}
 
-	uint32 index = 0u;
-	DartMarker dart_marker(m);
-	uint32 vol_emb = 0u;
+} // namespace
 
-	// for each volume of table
-	for (uint32 i = 0u; i < volume_data.nb_volumes_; ++i)
+VolumeImportStream::VolumeImportStream(CMap3& m, const std::string& vertex_position_attribute_name)
+	: m_(m), position_added_(false), nb_boundary_faces_(0u), nb_non_manifold_faces_(0u)
+{
+	position_ = get_attribute<Vec3, CMap3::Vertex>(m, vertex_position_attribute_name);
+	if (!position_)
 	{
-		Volume vol;
-		const VolumeType vol_type = volume_data.volumes_types_[i];
+		position_ = add_attribute<Vec3, CMap3::Vertex>(m, vertex_position_attribute_name);
+		position_added_ = true;
+	}
+}
 
-		if (vol_type == VolumeType::Tetra) // tetrahedral case
-		{
-			vol = add_pyramid(static_cast<CMap2&>(m), 3u, false);
+void VolumeImportStream::add_vertices(const Vec3* positions, uint32 nb_vertices)
+{
+	using Vertex = CMap3::Vertex;
 
-			const std::array<Dart, 4> vertices_of_tetra = {vol.dart, phi1(m, vol.dart), phi_1(m, vol.dart),
-														   phi_1(m, phi2(m, phi_1(m, vol.dart)))};
+	const uint32 first = uint32(vertex_id_after_import_.size());
+	for (uint32 i = 0u; i < nb_vertices; ++i)
+		vertex_id_after_import_.push_back(new_index<Vertex>(m_));
 
-			for (Dart dv : vertices_of_tetra)
-			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, CMap3::Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-
-				Dart dd = dv;
-				do
-				{
-					dart_marker.mark(dd);
-					(*darts_per_vertex)[vertex_index].push_back(dd);
-					dd = phi1(m, phi2(m, dd));
-				} while (dd != dv);
-			}
-		}
-		else if (vol_type == VolumeType::Pyramid) // pyramidal case
-		{
-			vol = add_pyramid(static_cast<CMap2&>(m), 4u, false);
+	thread_pool()->parallel_for(0u, nb_vertices, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+			(*position_)[vertex_id_after_import_[first + i]] = positions[i];
+	});
+}
 
-			const std::array<Dart, 5> vertices_of_pyramid = {vol.dart, phi1(m, vol.dart), phi1(m, phi1(m, vol.dart)),
-															 phi_1(m, vol.dart), phi_1(m, phi2(m, phi_1(m, vol.dart)))};
+void VolumeImportStream::add_volumes(const VolumeType* volumes_types, uint32 nb_volumes,
+									 const uint32* volumes_vertex_indices)
+{
+	using Vertex = CMap3::Vertex;
+	using Volume = CMap3::Volume;
 
-			for (Dart dv : vertices_of_pyramid)
-			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, CMap3::Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-
-				Dart dd = dv;
-				do
-				{
-					dart_marker.mark(dd);
-					(*darts_per_vertex)[vertex_index].push_back(dd);
-					dd = phi1(m, phi2(m, dd));
-				} while (dd != dv);
-			}
-		}
-		else if (vol_type == VolumeType::TriangularPrism) // prism case
-		{
-			vol = add_prism(static_cast<CMap2&>(m), 3u, false);
+	ThreadPool* pool = thread_pool();
 
-			const std::array<Dart, 6> vertices_of_prism = {vol.dart,
-														   phi1(m, vol.dart),
-														   phi_1(m, vol.dart),
-														   phi2(m, phi1(m, phi1(m, phi2(m, phi_1(m, vol.dart))))),
-														   phi2(m, phi1(m, phi1(m, phi2(m, vol.dart)))),
-														   phi2(m, phi1(m, phi1(m, phi2(m, phi1(m, vol.dart)))))};
+	// offsets of the darts, vertices & faces of each volume of the batch
 
-			for (Dart dv : vertices_of_prism)
-			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, CMap3::Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-
-				Dart dd = dv;
-				do
-				{
-					dart_marker.mark(dd);
-					(*darts_per_vertex)[vertex_index].push_back(dd);
-					dd = phi1(m, phi2(m, dd));
-				} while (dd != dv);
-			}
-		}
-		else if (vol_type == VolumeType::Hexa) // hexahedral case
+	std::vector<uint32> dart_offsets(nb_volumes + 1u);
+	std::vector<uint32> vertex_offsets(nb_volumes + 1u);
+	std::vector<uint32> face_offsets(nb_volumes + 1u);
+	dart_offsets[0] = vertex_offsets[0] = 0u;
+	face_offsets[0] = uint32(face_darts_.size());
+	for (uint32 i = 0u; i < nb_volumes; ++i)
+	{
+		const VolumeTemplate* t = volume_template(volumes_types[i]);
+		dart_offsets[i + 1] = dart_offsets[i] + (t ? t->nb_darts_ : 0u);
+		// connectors are not built but their 4 vertices are in the list
+		vertex_offsets[i + 1] = vertex_offsets[i] + (t ? t->nb_vertices_ : 4u);
+		face_offsets[i + 1] = face_offsets[i] + (t ? uint32(t->faces_.size()) : 0u);
+	}
+
+	// the darts are allocated serially (containers are not thread-safe), then each volume is built by copying its
+	// template, concurrently
+
+	std::vector<uint32> darts(dart_offsets[nb_volumes]);
+	m_.darts_.new_indices(uint32(darts.size()), darts.data());
+	face_darts_.resize(face_offsets[nb_volumes]);
+
+	auto& vertex_indices = *m_.cells_indices_[Vertex::ORBIT];
+	pool->parallel_for(0u, nb_volumes, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
 		{
-			vol = add_prism(static_cast<CMap2&>(m), 4u, false);
-
-			const std::array<Dart, 8> vertices_of_hexa = {
-				vol.dart,
-				phi1(m, vol.dart),
-				phi1(m, phi1(m, vol.dart)),
-				phi_1(m, vol.dart),
-				phi2(m, phi1(m, phi1(m, phi2(m, phi_1(m, vol.dart))))),
-				phi2(m, phi1(m, phi1(m, phi2(m, vol.dart)))),
-				phi2(m, phi1(m, phi1(m, phi2(m, phi1(m, vol.dart))))),
-				phi2(m, phi1(m, phi1(m, phi2(m, phi1(m, phi1(m, vol.dart))))))};
-
-			for (Dart dv : vertices_of_hexa)
+			const VolumeTemplate* t = volume_template(volumes_types[i]);
+			if (!t)
+				continue;
+			const uint32* vol_darts = &darts[dart_offsets[i]];
+			const uint32* vol_vertices = &volumes_vertex_indices[vertex_offsets[i]];
+			for (uint32 l = 0u; l < t->nb_darts_; ++l)
 			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(static_cast<CMap2&>(m), CMap3::Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-
-				Dart dd = dv;
-				do
-				{
-					dart_marker.mark(dd);
-					(*darts_per_vertex)[vertex_index].push_back(dd);
-					dd = phi1(m, phi2(m, dd));
-				} while (dd != dv);
+				const uint32 d = vol_darts[l];
+				(*m_.phi1_)[d] = Dart(vol_darts[t->phi1_[l]]);
+				(*m_.phi_1_)[d] = Dart(vol_darts[t->phi_1_[l]]);
+				(*m_.phi2_)[d] = Dart(vol_darts[t->phi2_[l]]);
+				(*m_.phi3_)[d] = Dart(d);
+				for (auto& emb : m_.cells_indices_)
+					if (emb)
+						(*emb)[d] = INVALID_INDEX;
+				vertex_indices[d] = vertex_id_after_import_[vol_vertices[t->vertex_slot_[l]]];
 			}
+			for (uint32 f = 0u, nbf = uint32(t->faces_.size()); f < nbf; ++f)
+				face_darts_[face_offsets[i] + f] = Dart(vol_darts[t->faces_[f]]);
 		}
-		else // end of hexa
+	});
+
+	// reference counters are not atomic
+	for (uint32 d : darts)
+		m_.attribute_containers_[Vertex::ORBIT].ref_index(vertex_indices[d]);
+
+	if (is_indexed<Volume>(m_))
+	{
+		for (uint32 i = 0u; i < nb_volumes; ++i)
 		{
-			if (vol_type == VolumeType::Connector)
-			{
-				index += 4u;
-				// The second part of the code generates connectors automatically. We don't have to do anything here.
-			}
+			if (dart_offsets[i + 1] > dart_offsets[i])
+				set_index(m_, Volume(Dart(darts[dart_offsets[i]])), new_index<Volume>(m_));
 		}
-
-		if (is_indexed<Volume>(m))
-			set_index(m, vol, vol_emb++);
 	}
+}
 
-	// reconstruct neighbourhood
-	uint32 nb_boundary_faces = 0u;
-	DartMarkerStore marker(m);
+void VolumeImportStream::finish()
+{
+	using Vertex = CMap3::Vertex;
 
-	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
-	{
-		if (phi3(m, d) == d && !marker.is_marked(d))
-		{
-			foreach_dart_of_orbit(m, CMap3::Face2(d), [&](Dart fd) -> bool {
-				marker.mark(fd);
-				return true;
-			});
+	ThreadPool* pool = thread_pool();
 
-			Dart good_dart;
+	// the faces of the added volumes are sorted by the hash of their sorted vertices: opposite faces become adjacent
 
-			// 1st step : for every dart of the face we try to find a valid phi3 candidate. If we can't it's a boundary
-			// face.
-			Dart d_it = d;
-			do
-			{
-				uint32 vindex1 = index_of(m, Vertex(d_it));
-				uint32 vindex2 = index_of(m, Vertex(phi1(m, phi1(m, d_it))));
-				const std::vector<Dart>& vec = value<std::vector<Dart>>(m, darts_per_vertex, Vertex(phi1(m, d_it)));
-				for (auto it = vec.begin(); it != vec.end() && good_dart.is_nil(); ++it)
-					if (index_of(m, Vertex(phi1(m, *it))) == vindex1 && index_of(m, Vertex(phi_1(m, *it))) == vindex2)
-						good_dart = *it;
-				d_it = phi1(m, d_it);
-			} while (good_dart.is_nil() && (d_it != d));
-			d = phi_1(m, d_it);
-
-			if (!good_dart.is_nil())
+	using FaceVertices = std::array<uint32, 4>;
+	auto face_vertices = [&](Dart d) -> FaceVertices {
+		FaceVertices v = {INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX};
+		uint32 n = 0u;
+		Dart it = d;
+		do
+		{
+			v[n++] = index_of(m_, Vertex(it));
+			it = phi1(m_, it);
+		} while (it != d && n < 4u);
+		std::sort(v.begin(), v.begin() + n);
+		return v;
+	};
+
+	const uint32 nb_faces = uint32(face_darts_.size());
+	std::vector<uint64> keys(nb_faces);
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			const FaceVertices v = face_vertices(face_darts_[i]);
+			uint64 h = 0u;
+			for (uint32 k = 0u; k < 4u; ++k)
+				h = mix_hash(h ^ (uint64(v[k]) + 0x9e3779b97f4a7c15ull));
+			keys[i] = h;
+		}
+	});
+	radix_sort(keys, face_darts_);
+
+	// phi3 sewing of the faces that have the same vertices & opposite orientations within each run of equal keys
+
+	std::atomic<uint32> nb_boundary_faces = 0u;
+	std::atomic<uint32> nb_non_manifold_faces = 0u;
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		uint32 i = b;
+		// the run that started before b is handled by the previous range
+		while (i > 0u && i < nb_faces && keys[i] == keys[i - 1])
+			++i;
+		uint32 nb_boundary = 0u;
+		uint32 nb_non_manifold = 0u;
+		std::vector<FaceVertices> run_vertices;
+		while (i < e)
+		{
+			uint32 j = i + 1u;
+			while (j < nb_faces && keys[j] == keys[i])
+				++j;
+			run_vertices.clear();
+			for (uint32 p = i; p < j; ++p)
+				run_vertices.push_back(face_vertices(face_darts_[p]));
+			for (uint32 p = i; p < j; ++p)
 			{
-				const uint32 degD = codegree(m, CMap3::Face(d));
-				const uint32 degGD = codegree(m, CMap3::Face(good_dart));
-
-				if (degD == degGD) // normal case : the two opposite faces have the same degree
+				const Dart d = face_darts_[p];
+				const FaceVertices& vp = run_vertices[p - i];
+				if (j - i > 2u && std::count(run_vertices.begin(), run_vertices.end(), vp) > 2)
+					++nb_non_manifold;
+				if (phi3(m_, d) != d)
+					continue;
+
+				const uint32 v0 = index_of(m_, Vertex(d));
+				const uint32 v1 = index_of(m_, Vertex(phi1(m_, d)));
+				for (uint32 q = p + 1u; q < j; ++q)
 				{
+					const Dart dd = face_darts_[q];
+					if (run_vertices[q - i] != vp || phi3(m_, dd) != dd)
+						continue;
+					// dart of the opposite face that goes from v1 to v0
+					Dart it = dd;
+					Dart good_dart;
+					do
+					{
+						if (index_of(m_, Vertex(it)) == v1 && index_of(m_, Vertex(phi1(m_, it))) == v0)
+							good_dart = it;
+						it = phi1(m_, it);
+					} while (good_dart.is_nil() && it != dd);
+					if (good_dart.is_nil())
+						continue; // same orientation
 					Dart it1 = d;
 					Dart it2 = good_dart;
 					do
 					{
-						phi3_sew(m, it1, it2);
-						it1 = phi1(m, it1);
-						it2 = phi_1(m, it2);
+						phi3_sew(m_, it1, it2);
+						it1 = phi1(m_, it1);
+						it2 = phi_1(m_, it2);
 					} while (it1 != d);
+					break;
 				}
-				else
-				{
-					// there is one face of degree 4 and one face of degree 3
-					// -> stamp volume
-				}
+				if (phi3(m_, d) == d)
+					++nb_boundary;
 			}
-			else
-				++nb_boundary_faces;
+			i = j;
 		}
-	}
+		nb_boundary_faces += nb_boundary;
+		nb_non_manifold_faces += nb_non_manifold;
+	});
+
+	std::vector<uint64>().swap(keys);
+	std::vector<Dart>().swap(face_darts_);
 
-	if (nb_boundary_faces > 0u)
+	nb_boundary_faces_ = nb_boundary_faces;
+	nb_non_manifold_faces_ = nb_non_manifold_faces;
+
+	if (nb_non_manifold_faces_ > 0u)
+		std::cout << nb_non_manifold_faces_ << " non-manifold faces (shared by more than two volumes)" << std::endl;
+
+	if (nb_boundary_faces_ > 0u)
 	{
-		uint32 nb_holes = close(m);
+		uint32 nb_holes = close(m_);
 		std::cout << nb_holes << " hole(s) have been closed" << std::endl;
-		std::cout << nb_boundary_faces << " boundary faces" << std::endl;
+		std::cout << nb_boundary_faces_ << " boundary faces" << std::endl;
+	}
+}
+
+void VolumeImportStream::cancel()
+{
+	using Vertex = CMap3::Vertex;
+
+	// the darts of the added volumes are the only ones that are not phi3-sewn (the map was closed before the import)
+	std::vector<Dart> darts;
+	for (Dart d = m_.begin(), end = m_.end(); d != end; d = m_.next(d))
+	{
+		if (phi3(m_, d) == d)
+			darts.push_back(d);
 	}
 
-	remove_attribute<Vertex>(m, darts_per_vertex);
+	// the added vertices are referenced once more during the removal of the darts, so that the vertices that are not
+	// used by any volume are released as well
+	auto& vertices = m_.attribute_containers_[Vertex::ORBIT];
+	for (uint32 v : vertex_id_after_import_)
+		vertices.ref_index(v);
+	for (Dart d : darts)
+		remove_dart(m_, d);
+	for (uint32 v : vertex_id_after_import_)
+		vertices.unref_index(v);
+	vertex_id_after_import_.clear();
+	face_darts_.clear();
+
+	if (position_added_)
+	{
+		remove_attribute<Vertex>(m_, position_);
+		position_added_ = false;
+	}
+	position_.reset();
+}
+
+void import_volume_data(CMap3& m, VolumeImportData& volume_data)
+{
+	VolumeImportStream stream(m, volume_data.vertex_position_attribute_name_);
+	stream.vertex_id_after_import().swap(volume_data.vertex_id_after_import_);
+	stream.vertex_id_after_import().clear();
+
+	stream.add_vertices(volume_data.vertex_position_.data(), volume_data.nb_vertices_);
+	stream.add_volumes(volume_data.volumes_types_.data(), volume_data.nb_volumes_,
+					   volume_data.volumes_vertex_indices_.data());
+	stream.finish();
+
+	stream.vertex_id_after_import().swap(volume_data.vertex_id_after_import_);
+	volume_data.nb_boundary_faces_ = stream.nb_boundary_faces();
+	volume_data.nb_non_manifold_faces_ = stream.nb_non_manifold_faces();
 }
 
 } // namespace io
@@ -30,6 +30,8 @@
 
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace cgogn
@@ -62,6 +64,10 @@ struct VolumeImportData
 
 	std::vector<uint32> vertex_id_after_import_;
 
+	// report of the last import
+	uint32 nb_boundary_faces_ = 0u;		// faces without opposite face (before closing)
+	uint32 nb_non_manifold_faces_ = 0u; // faces whose vertices are the vertices of more than two faces
+
 	inline void reserve(uint32 nb_vertices, uint32 nb_volumes)
 	{
 		nb_vertices_ = nb_vertices;
@@ -73,6 +79,76 @@ struct VolumeImportData
 	}
 };
 
+/**
+ * @brief incremental construction of a CMap3 from batches of vertices and volumes
+ * The volumes are turned into darts as soon as they are added (each batch is built in parallel from per-type
+ * templates), so that the whole input never has to be held in memory: only one dart per face is kept until
+ * finish() matches the opposite faces through a sorted table of face keys (hash of the sorted face vertices),
+ * phi3-sews them and closes the remaining holes.
+ * All the vertices must be added before the volumes that reference them.
+ */
+class CGOGN_IO_EXPORT VolumeImportStream
+{
+public:
+	VolumeImportStream(CMap3& m, const std::string& vertex_position_attribute_name = "position");
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(VolumeImportStream);
+
+	/**
+	 * @brief add the given vertices (their file ids follow the ones of the previously added vertices)
+	 */
+	void add_vertices(const Vec3* positions, uint32 nb_vertices);
+
+	/**
+	 * @brief add the given (correctly oriented) volumes
+	 * @param volumes_vertex_indices file ids of the vertices of the volumes, concatenated
+	 */
+	void add_volumes(const VolumeType* volumes_types, uint32 nb_volumes, const uint32* volumes_vertex_indices);
+
+	/**
+	 * @brief phi3-sew the added volumes and close the remaining holes
+	 */
+	void finish();
+
+	/**
+	 * @brief remove the vertices & volumes added so far (instead of finish(), e.g. when the input turns out to be
+	 * invalid): the map is left as it was before the construction of the stream
+	 */
+	void cancel();
+
+	// boundary & non-manifold faces found by the last call to finish()
+	inline uint32 nb_boundary_faces() const
+	{
+		return nb_boundary_faces_;
+	}
+	inline uint32 nb_non_manifold_faces() const
+	{
+		return nb_non_manifold_faces_;
+	}
+
+	inline uint32 nb_vertices() const
+	{
+		return uint32(vertex_id_after_import_.size());
+	}
+	inline std::vector<uint32>& vertex_id_after_import()
+	{
+		return vertex_id_after_import_;
+	}
+	inline const Vec3& vertex_position(uint32 vertex_file_id) const
+	{
+		return (*position_)[vertex_id_after_import_[vertex_file_id]];
+	}
+
+private:
+	CMap3& m_;
+	std::shared_ptr<CMap3::Attribute<Vec3>> position_;
+	bool position_added_;
+	std::vector<uint32> vertex_id_after_import_;
+	std::vector<Dart> face_darts_; // a dart of each face of the added volumes
+	uint32 nb_boundary_faces_;
+	uint32 nb_non_manifold_faces_;
+};
+
 void CGOGN_IO_EXPORT import_volume_data(CMap3& m, VolumeImportData& volume_data);
 
 } // namespace io
@@ -75,7 +75,7 @@ std::pair<std::vector<CMap2::HalfEdge>, std::vector<CMap2::Face>> build_horizon(
 		foreach_adjacent_face_through_edge(m, f, [&](CMap2::Face af) -> bool {
 			if (visible.is_marked(af))
 				return true;
-			std::vector<CMap2::Vertex> vertices = incident_vertices(m, af);
+			auto vertices = incident_vertices(m, af);
 			Vec3 N = geometry::normal(value<Vec3>(m, vertex_position, vertices[0]),
 									  value<Vec3>(m, vertex_position, vertices[1]),
 									  value<Vec3>(m, vertex_position, vertices[2]));
@@ -319,7 +319,7 @@ void convex_hull(const std::vector<Vec3>& points, MESH& m,
 	for (uint32 i = 0; i < points.size(); ++i)
 	{
 		foreach_cell(m, [&](Face f) -> bool {
-			std::vector<Vertex> vertices = incident_vertices(m, f);
+			auto vertices = incident_vertices(m, f);
 			Vec3 N = geometry::normal(value<Vec3>(m, vertex_position, vertices[0]),
 									  value<Vec3>(m, vertex_position, vertices[1]),
 									  value<Vec3>(m, vertex_position, vertices[2]));
@@ -384,7 +384,7 @@ void convex_hull(const std::vector<Vec3>& points, MESH& m,
 			if (i == active_point_index)
 				continue;
 			foreach_incident_face(m, v, [&](Face iface) -> bool {
-				std::vector<Vertex> vertices = incident_vertices(m, iface);
+				auto vertices = incident_vertices(m, iface);
 				Vec3 N = geometry::normal(value<Vec3>(m, vertex_position, vertices[0]),
 										  value<Vec3>(m, vertex_position, vertices[1]),
 										  value<Vec3>(m, vertex_position, vertices[2]));
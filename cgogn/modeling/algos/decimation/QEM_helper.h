@@ -25,6 +25,7 @@
 #define CGOGN_MODELING_DECIMATION_EDGE_QUEUE_QEM_H_
 
 #include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/face.h>
 #include <cgogn/core/functions/traversals/global.h>
 #include <cgogn/core/functions/traversals/vertex.h>
 
@@ -54,17 +55,16 @@ struct DecimationQEM_Helper
 	DecimationQEM_Helper(MESH& m, const Attribute<Vec3>* vertex_position) : m_(m), vertex_position_(vertex_position)
 	{
 		vertex_quadric_ = add_attribute<Quadric, Vertex>(m, "__vertex_quadric");
+		// each vertex gathers the quadrics of its incident faces (no concurrent write on a vertex)
 		parallel_foreach_cell(m_, [&](Vertex v) -> bool {
-			value<Quadric>(m_, vertex_quadric_, v).zero();
-			return true;
-		});
-		parallel_foreach_cell(m_, [&](Face f) -> bool {
-			std::vector<Vertex> iv = incident_vertices(m_, f);
-			Quadric q(value<Vec3>(m_, vertex_position_, iv[0]), value<Vec3>(m_, vertex_position_, iv[1]),
-					  value<Vec3>(m_, vertex_position_, iv[2]));
-			value<Quadric>(m_, vertex_quadric_, iv[0]) += q;
-			value<Quadric>(m_, vertex_quadric_, iv[1]) += q;
-			value<Quadric>(m_, vertex_quadric_, iv[2]) += q;
+			Quadric& q = value<Quadric>(m_, vertex_quadric_, v);
+			q.zero();
+			foreach_incident_face(m_, v, [&](Face f) -> bool {
+				auto iv = incident_vertices(m_, f);
+				q += Quadric(value<Vec3>(m_, vertex_position_, iv[0]), value<Vec3>(m_, vertex_position_, iv[1]),
+							 value<Vec3>(m_, vertex_position_, iv[2]));
+				return true;
+			});
 			return true;
 		});
 	}
@@ -75,7 +75,7 @@ struct DecimationQEM_Helper
 
 	Scalar edge_cost(Edge e, const Vec3& p)
 	{
-		std::vector<Vertex> iv = incident_vertices(m_, e);
+		auto iv = incident_vertices(m_, e);
 		Quadric q;
 		q += value<Quadric>(m_, vertex_quadric_, iv[0]);
 		q += value<Quadric>(m_, vertex_quadric_, iv[1]);
@@ -84,7 +84,7 @@ struct DecimationQEM_Helper
 
 	Vec3 edge_optimal(Edge e)
 	{
-		std::vector<Vertex> iv = incident_vertices(m_, e);
+		auto iv = incident_vertices(m_, e);
 		// Quadric q;
 		// q += value<Quadric>(m_, vertex_quadric_, iv[0]);
 		// q += value<Quadric>(m_, vertex_quadric_, iv[1]);
@@ -95,12 +95,18 @@ struct DecimationQEM_Helper
 		return Scalar(0.5) * (value<Vec3>(m_, vertex_position_, iv[0]) + value<Vec3>(m_, vertex_position_, iv[1]));
 	}
 
+	Quadric edge_quadric(Edge e) const
+	{
+		auto iv = incident_vertices(m_, e);
+		Quadric q;
+		q += value<Quadric>(m_, vertex_quadric_, iv[0]);
+		q += value<Quadric>(m_, vertex_quadric_, iv[1]);
+		return q;
+	}
+
 	void before_collapse(Edge e)
 	{
-		std::vector<Vertex> iv = incident_vertices(m_, e);
-		q_.zero();
-		q_ += value<Quadric>(m_, vertex_quadric_, iv[0]);
-		q_ += value<Quadric>(m_, vertex_quadric_, iv[1]);
+		q_ = edge_quadric(e);
 	}
 
 	void after_collapse(Vertex v)
@@ -108,6 +114,11 @@ struct DecimationQEM_Helper
 		value<Quadric>(m_, vertex_quadric_, v) = q_;
 	}
 
+	void set_quadric(Vertex v, const Quadric& q)
+	{
+		value<Quadric>(m_, vertex_quadric_, v) = q;
+	}
+
 	MESH& m_;
 	const Attribute<Vec3>* vertex_position_;
 	std::shared_ptr<Attribute<Quadric>> vertex_quadric_;
@@ -27,7 +27,10 @@
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/traversals/global.h>
 
+#include <algorithm>
+#include <functional>
 #include <map>
+#include <vector>
 
 namespace cgogn
 {
@@ -61,6 +64,39 @@ public:
 	// set to 64 bit to avoid conversion warning, can be 32 but need cast on insertion
 	CellCostMap cells_;
 
+	inline bool empty() const
+	{
+		return cells_.empty();
+	}
+
+	inline uint32 size() const
+	{
+		return uint32(cells_.size());
+	}
+
+	inline CELL top() const
+	{
+		return cells_.begin()->second;
+	}
+
+	// insert the cell or update its cost if already present
+	inline void update(uint32, CellQueueInfo& info, float64 cost, CELL c)
+	{
+		if (info.valid_)
+			cells_.erase(info.it_);
+		info.it_ = cells_.insert(std::make_pair(cost, c));
+		info.valid_ = true;
+	}
+
+	inline void remove(uint32, CellQueueInfo& info)
+	{
+		if (info.valid_)
+		{
+			cells_.erase(info.it_);
+			info.valid_ = false;
+		}
+	}
+
 	class const_iterator
 	{
 	public:
@@ -107,6 +143,250 @@ public:
 	}
 };
 
+/**
+ * Indexed d-ary min-heap of cells keyed by cell index.
+ * The position of each key in the heap is stored in a flat array so that
+ * the cost of a queued cell is updated in place (decrease/increase-key) without allocation.
+ */
+template <typename CELL, uint32 ARITY = 4u>
+class IndexedCellQueue
+{
+	static_assert(ARITY >= 2u, "Heap arity should be at least 2");
+
+public:
+	struct CellQueueInfo
+	{
+		bool valid_;
+		CellQueueInfo() : valid_(false)
+		{
+		}
+	};
+
+private:
+	struct Entry
+	{
+		float64 cost_;
+		CELL cell_;
+		uint32 key_;
+	};
+
+	std::vector<Entry> heap_;
+	std::vector<uint32> positions_; // key -> position in heap_
+
+	inline void place(uint32 pos, const Entry& e)
+	{
+		heap_[pos] = e;
+		positions_[e.key_] = pos;
+	}
+
+	void sift_up(uint32 pos)
+	{
+		Entry e = heap_[pos];
+		while (pos > 0u)
+		{
+			uint32 parent = (pos - 1u) / ARITY;
+			if (heap_[parent].cost_ <= e.cost_)
+				break;
+			place(pos, heap_[parent]);
+			pos = parent;
+		}
+		place(pos, e);
+	}
+
+	void sift_down(uint32 pos)
+	{
+		Entry e = heap_[pos];
+		const uint32 n = uint32(heap_.size());
+		for (;;)
+		{
+			uint32 first = pos * ARITY + 1u;
+			if (first >= n)
+				break;
+			uint32 best = first;
+			for (uint32 c = first + 1u, end = std::min(first + ARITY, n); c < end; ++c)
+				if (heap_[c].cost_ < heap_[best].cost_)
+					best = c;
+			if (heap_[best].cost_ >= e.cost_)
+				break;
+			place(pos, heap_[best]);
+			pos = best;
+		}
+		place(pos, e);
+	}
+
+public:
+	inline IndexedCellQueue()
+	{
+	}
+
+	inline bool empty() const
+	{
+		return heap_.empty();
+	}
+
+	inline uint32 size() const
+	{
+		return uint32(heap_.size());
+	}
+
+	inline CELL top() const
+	{
+		cgogn_message_assert(!heap_.empty(), "top() called on an empty queue");
+		return heap_.front().cell_;
+	}
+
+	// insert the cell or update its cost if already present
+	void update(uint32 key, CellQueueInfo& info, float64 cost, CELL c)
+	{
+		if (info.valid_)
+		{
+			uint32 pos = positions_[key];
+			float64 old_cost = heap_[pos].cost_;
+			heap_[pos].cost_ = cost;
+			heap_[pos].cell_ = c;
+			if (cost < old_cost)
+				sift_up(pos);
+			else
+				sift_down(pos);
+		}
+		else
+		{
+			if (key >= uint32(positions_.size()))
+				positions_.resize(key + 1u, INVALID_INDEX);
+			heap_.push_back({cost, c, key});
+			sift_up(uint32(heap_.size()) - 1u);
+			info.valid_ = true;
+		}
+	}
+
+	void remove(uint32 key, CellQueueInfo& info)
+	{
+		if (!info.valid_)
+			return;
+		info.valid_ = false;
+
+		uint32 pos = positions_[key];
+		positions_[key] = INVALID_INDEX;
+		float64 removed_cost = heap_[pos].cost_;
+		Entry last = heap_.back();
+		heap_.pop_back();
+		if (pos == uint32(heap_.size()))
+			return;
+		place(pos, last);
+		if (last.cost_ < removed_cost)
+			sift_up(pos);
+		else
+			sift_down(pos);
+	}
+};
+
+/**
+ * Binary min-heap of cells with lazy invalidation.
+ * Updates push a new entry and removals only bump the stamp of the key:
+ * outdated entries are discarded when they reach the top of the heap.
+ */
+template <typename CELL>
+class LazyCellQueue
+{
+public:
+	struct CellQueueInfo
+	{
+		bool valid_;
+		CellQueueInfo() : valid_(false)
+		{
+		}
+	};
+
+private:
+	struct Entry
+	{
+		float64 cost_;
+		CELL cell_;
+		uint32 key_;
+		uint32 stamp_;
+		inline bool operator>(const Entry& e) const
+		{
+			return cost_ > e.cost_;
+		}
+	};
+
+	std::vector<Entry> heap_;
+	std::vector<uint32> stamps_; // key -> stamp of its valid entry
+	uint32 nb_valid_;
+
+	inline bool is_stale(const Entry& e) const
+	{
+		return e.stamp_ != stamps_[e.key_];
+	}
+
+	inline void discard_stale_top()
+	{
+		while (!heap_.empty() && is_stale(heap_.front()))
+		{
+			std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+			heap_.pop_back();
+		}
+	}
+
+	inline void compact_if_needed()
+	{
+		if (heap_.size() > 1024u && heap_.size() > 4u * std::size_t(nb_valid_))
+		{
+			heap_.erase(std::remove_if(heap_.begin(), heap_.end(), [this](const Entry& e) { return is_stale(e); }),
+						heap_.end());
+			std::make_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+		}
+	}
+
+public:
+	inline LazyCellQueue() : nb_valid_(0u)
+	{
+	}
+
+	inline bool empty()
+	{
+		discard_stale_top();
+		return heap_.empty();
+	}
+
+	inline uint32 size() const
+	{
+		return nb_valid_;
+	}
+
+	inline CELL top()
+	{
+		discard_stale_top();
+		cgogn_message_assert(!heap_.empty(), "top() called on an empty queue");
+		return heap_.front().cell_;
+	}
+
+	// insert the cell or update its cost if already present
+	void update(uint32 key, CellQueueInfo& info, float64 cost, CELL c)
+	{
+		if (key >= uint32(stamps_.size()))
+			stamps_.resize(key + 1u, 0u);
+		if (!info.valid_)
+		{
+			info.valid_ = true;
+			++nb_valid_;
+		}
+		heap_.push_back({cost, c, key, ++stamps_[key]});
+		std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+		compact_if_needed();
+	}
+
+	void remove(uint32 key, CellQueueInfo& info)
+	{
+		if (!info.valid_)
+			return;
+		info.valid_ = false;
+		--nb_valid_;
+		++stamps_[key];
+		compact_if_needed();
+	}
+};
+
 } // namespace modeling
 
 } // namespace cgogn
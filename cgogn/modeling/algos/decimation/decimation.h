@@ -25,7 +25,11 @@
 #define CGOGN_GEOMETRY_ALGOS_DECIMATION_H_
 
 #include <cgogn/core/functions/mesh_ops/edge.h>
+#include <cgogn/core/functions/traversals/face.h>
 #include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/geometry/types/vector_traits.h>
 
@@ -33,6 +37,11 @@
 #include <cgogn/modeling/algos/decimation/edge_approximator.h>
 #include <cgogn/modeling/algos/decimation/edge_queue_update.h>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
 namespace cgogn
 {
 
@@ -46,15 +55,17 @@ using Scalar = geometry::Scalar;
 // GENERIC //
 /////////////
 
-template <typename MESH>
+// the edge queue engine can be chosen among CellQueue (ordered multimap),
+// IndexedCellQueue (indexed d-ary heap, default) and LazyCellQueue (heap with lazy invalidation)
+template <typename MESH, typename QUEUE = IndexedCellQueue<typename mesh_traits<MESH>::Edge>>
 void decimate(MESH& m, typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
 			  uint32 nb_vertices_to_remove)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Edge = typename mesh_traits<MESH>::Edge;
 
-	CellQueue<Edge> edge_queue;
-	using EdgeQueueInfo = typename CellQueue<Edge>::CellQueueInfo;
+	QUEUE edge_queue;
+	using EdgeQueueInfo = typename QUEUE::CellQueueInfo;
 	auto edge_queue_info = add_attribute<EdgeQueueInfo, Edge>(m, "__decimate_edge_queue_info");
 
 	// static map to store helpers associated to meshes
@@ -79,14 +90,15 @@ void decimate(MESH& m, typename mesh_traits<MESH>::template Attribute<Vec3>* ver
 	});
 
 	uint32 count = 0;
-	for (auto it = edge_queue.begin(); it != edge_queue.end(); ++it)
+	while (!edge_queue.empty())
 	{
-		Vec3 newpos = approx(*it);
+		Edge e = edge_queue.top();
+		Vec3 newpos = approx(e);
 
 		Edge e1, e2;
-		pre_collapse(m, *it, e1, e2, edge_queue, edge_queue_info.get());
-		before(*it);
-		Vertex v = collapse_edge(m, *it);
+		pre_collapse(m, e, e1, e2, edge_queue, edge_queue_info.get());
+		before(e);
+		Vertex v = collapse_edge(m, e);
 		value<Vec3>(m, vertex_position, v) = newpos;
 		after(v);
 		post_collapse(m, e1, e2, edge_queue, edge_queue_info.get(), edge_cost);
@@ -99,6 +111,198 @@ void decimate(MESH& m, typename mesh_traits<MESH>::template Attribute<Vec3>* ver
 	remove_attribute<Edge>(m, edge_queue_info);
 }
 
+/**
+ * Parallel multiple-choice decimation.
+ * Each round evaluates the cost of all the collapsible edges and keeps the cheapest ones as candidates.
+ * An independent set is selected among them: a candidate wins if it has the lowest rank on all the vertices
+ * of the faces incident to its two vertices. The winners modify disjoint parts of the mesh and are collapsed
+ * concurrently.
+ * @param candidates_ratio proportion of the collapsible edges that compete in each round
+ * @param nb_selection_passes maximum number of independent set selection passes in each round
+ */
+template <typename MESH>
+void decimate_parallel(MESH& m, typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+					   uint32 nb_vertices_to_remove, float64 candidates_ratio = 0.25, uint32 nb_selection_passes = 4)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	ThreadPool* pool = thread_pool();
+	uint32 nb_workers = pool->nb_workers();
+	if (nb_workers == 0)
+		return decimate(m, vertex_position, nb_vertices_to_remove);
+
+	DecimationQEM_Helper<MESH> helper(m, vertex_position);
+
+	struct Candidate
+	{
+		Scalar cost_;
+		Edge e_;
+	};
+	std::vector<std::vector<Candidate>> worker_candidates(nb_workers);
+	std::vector<Candidate> candidates;
+	std::vector<uint32> collapses;
+	std::vector<uint32> neighborhood_offsets;
+	std::vector<uint32> neighborhood_vertices;
+
+	enum : uint8
+	{
+		UNDECIDED = 0,
+		SELECTED,
+		DISCARDED
+	};
+	std::vector<uint8> status;
+
+	// vertex index -> lowest rank of the candidates whose neighborhood contains the vertex
+	const uint32 nb_vertex_indices = m.attribute_containers_[Vertex::ORBIT].maximum_index();
+	std::vector<std::atomic<uint32>> vertex_owner(nb_vertex_indices);
+	// vertex index -> 1 if the vertex belongs to the neighborhood of a selected candidate
+	std::vector<uint8> vertex_blocked(nb_vertex_indices);
+
+	auto foreach_neighborhood_vertex = [&](Edge e, const auto& func) {
+		foreach_incident_vertex(m, e, [&](Vertex v) -> bool {
+			foreach_incident_face(m, v, [&](Face f) -> bool {
+				foreach_incident_vertex(m, f, [&](Vertex fv) -> bool {
+					func(index_of(m, fv));
+					return true;
+				});
+				return true;
+			});
+			return true;
+		});
+	};
+
+	uint32 count = 0;
+	while (count < nb_vertices_to_remove)
+	{
+		for (auto& wc : worker_candidates)
+			wc.clear();
+		parallel_foreach_cell(m, [&](Edge e) -> bool {
+			if (edge_can_collapse(m, e))
+				worker_candidates[current_worker_index()].push_back({helper.edge_cost(e, helper.edge_optimal(e)), e});
+			return true;
+		});
+
+		candidates.clear();
+		for (const auto& wc : worker_candidates)
+			candidates.insert(candidates.end(), wc.begin(), wc.end());
+		if (candidates.empty())
+			break;
+
+		auto cheaper = [](const Candidate& c1, const Candidate& c2) { return c1.cost_ < c2.cost_; };
+		uint32 nb_candidates = std::max(1u, uint32(candidates_ratio * candidates.size()));
+		nb_candidates = std::min(nb_candidates, uint32(candidates.size()));
+		std::nth_element(candidates.begin(), candidates.begin() + (nb_candidates - 1), candidates.end(), cheaper);
+		std::sort(candidates.begin(), candidates.begin() + nb_candidates, cheaper);
+
+		// neighborhood vertices of the candidates stored in CSR form (neighborhood_offsets, neighborhood_vertices)
+		neighborhood_offsets.resize(nb_candidates + 1u);
+		neighborhood_offsets[0] = 0u;
+		pool->parallel_for(0u, nb_candidates, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 rank = b; rank < e; ++rank)
+			{
+				uint32 nb = 0u;
+				foreach_neighborhood_vertex(candidates[rank].e_, [&](uint32) { ++nb; });
+				neighborhood_offsets[rank + 1] = nb;
+			}
+		});
+		for (uint32 rank = 0u; rank < nb_candidates; ++rank)
+			neighborhood_offsets[rank + 1] += neighborhood_offsets[rank];
+		neighborhood_vertices.resize(neighborhood_offsets[nb_candidates]);
+		pool->parallel_for(0u, nb_candidates, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+			for (uint32 rank = b; rank < e; ++rank)
+			{
+				uint32 i = neighborhood_offsets[rank];
+				foreach_neighborhood_vertex(candidates[rank].e_,
+											[&](uint32 vertex_index) { neighborhood_vertices[i++] = vertex_index; });
+			}
+		});
+		auto foreach_candidate_vertex = [&](uint32 rank, const auto& func) {
+			for (uint32 i = neighborhood_offsets[rank], end = neighborhood_offsets[rank + 1]; i < end; ++i)
+				func(neighborhood_vertices[i]);
+		};
+
+		// independent set selection: the undecided candidates that are local minima are selected,
+		// their neighborhoods are blocked and the process is repeated a few times
+		status.assign(nb_candidates, UNDECIDED);
+		std::fill(vertex_blocked.begin(), vertex_blocked.end(), 0u);
+		for (uint32 pass = 0; pass < nb_selection_passes; ++pass)
+		{
+			pool->parallel_for(0u, uint32(vertex_owner.size()), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 i = b; i < e; ++i)
+					vertex_owner[i].store(std::numeric_limits<uint32>::max(), std::memory_order_relaxed);
+			});
+
+			pool->parallel_for(0u, nb_candidates, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				for (uint32 rank = b; rank < e; ++rank)
+				{
+					if (status[rank] != UNDECIDED)
+						continue;
+					bool blocked = false;
+					foreach_candidate_vertex(rank,
+											 [&](uint32 vertex_index) { blocked |= vertex_blocked[vertex_index] != 0u; });
+					if (blocked)
+					{
+						status[rank] = DISCARDED;
+						continue;
+					}
+					foreach_candidate_vertex(rank, [&](uint32 vertex_index) {
+						std::atomic<uint32>& owner = vertex_owner[vertex_index];
+						uint32 current = owner.load(std::memory_order_relaxed);
+						while (rank < current && !owner.compare_exchange_weak(current, rank, std::memory_order_relaxed))
+							;
+					});
+				}
+			});
+
+			std::atomic<uint32> nb_selected = 0u;
+			pool->parallel_for(0u, nb_candidates, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+				uint32 nb = 0u;
+				for (uint32 rank = b; rank < e; ++rank)
+				{
+					if (status[rank] != UNDECIDED)
+						continue;
+					bool owns_all = true;
+					foreach_candidate_vertex(rank, [&](uint32 vertex_index) {
+						owns_all &= vertex_owner[vertex_index].load(std::memory_order_relaxed) == rank;
+					});
+					if (owns_all)
+					{
+						status[rank] = SELECTED;
+						foreach_candidate_vertex(rank, [&](uint32 vertex_index) { vertex_blocked[vertex_index] = 1u; });
+						++nb;
+					}
+				}
+				nb_selected += nb;
+			});
+			if (nb_selected == 0u)
+				break;
+		}
+
+		collapses.clear();
+		for (uint32 rank = 0; rank < nb_candidates && count + uint32(collapses.size()) < nb_vertices_to_remove; ++rank)
+		{
+			if (status[rank] == SELECTED)
+				collapses.push_back(rank);
+		}
+
+		pool->parallel_for(0u, uint32(collapses.size()), 64u, [&](uint32 b, uint32 e) {
+			for (uint32 i = b; i < e; ++i)
+			{
+				Edge ce = candidates[collapses[i]].e_;
+				Vec3 newpos = helper.edge_optimal(ce);
+				geometry::Quadric q = helper.edge_quadric(ce);
+				Vertex v = collapse_edge(m, ce);
+				value<Vec3>(m, vertex_position, v) = newpos;
+				helper.set_quadric(v, q);
+			}
+		});
+
+		count += uint32(collapses.size());
+	}
+}
+
 } // namespace modeling
 
 } // namespace cgogn
@@ -39,64 +39,45 @@ namespace modeling
 // GENERIC //
 /////////////
 
-template <typename MESH, typename FUNC>
-void update_edge_queue(
-	const MESH& m, typename mesh_traits<MESH>::Edge e, CellQueue<typename mesh_traits<MESH>::Edge>& edge_queue,
-	typename mesh_traits<MESH>::template Attribute<typename CellQueue<typename mesh_traits<MESH>::Edge>::CellQueueInfo>*
-		edge_queue_info,
-	const FUNC& edge_cost)
+// QUEUE is any of CellQueue, IndexedCellQueue or LazyCellQueue (see cell_queue.h)
+
+template <typename MESH, typename QUEUE, typename FUNC>
+void update_edge_queue(const MESH& m, typename mesh_traits<MESH>::Edge e, QUEUE& edge_queue,
+					   typename mesh_traits<MESH>::template Attribute<typename QUEUE::CellQueueInfo>* edge_queue_info,
+					   const FUNC& edge_cost)
 {
 	using Edge = typename mesh_traits<MESH>::Edge;
-	using EdgeQueueInfo = typename CellQueue<Edge>::CellQueueInfo;
+	using EdgeQueueInfo = typename QUEUE::CellQueueInfo;
 
 	static_assert(is_func_parameter_same<FUNC, Edge>::value, "Given function should take an Edge as parameter");
 	static_assert(std::is_floating_point<func_return_type<FUNC>>::value,
 				  "Given function should return a floating point value");
 
+	const uint32 key = index_of(m, e);
 	EdgeQueueInfo& ei = value<EdgeQueueInfo>(m, edge_queue_info, e);
 	if (edge_can_collapse(m, e))
-	{
-		if (ei.valid_)
-		{
-			edge_queue.cells_.erase(ei.it_);
-			ei.it_ = edge_queue.cells_.insert(std::make_pair(edge_cost(e), e));
-		}
-		else
-		{
-			ei.it_ = edge_queue.cells_.insert(std::make_pair(edge_cost(e), e));
-			ei.valid_ = true;
-		}
-	}
+		edge_queue.update(key, ei, edge_cost(e), e);
 	else
-	{
-		if (ei.valid_)
-		{
-			edge_queue.cells_.erase(ei.it_);
-			ei.valid_ = false;
-		}
-	}
+		edge_queue.remove(key, ei);
 }
 
 //////////////
 // CMapBase //
 //////////////
 
-template <typename MESH, typename std::enable_if_t<std::is_base_of<CMapBase, MESH>::value>* = nullptr>
-void pre_collapse(
-	const MESH& m, typename mesh_traits<MESH>::Edge e, typename mesh_traits<MESH>::Edge& e1,
-	typename mesh_traits<MESH>::Edge& e2, CellQueue<typename mesh_traits<MESH>::Edge>& edge_queue,
-	typename mesh_traits<MESH>::template Attribute<typename CellQueue<typename mesh_traits<MESH>::Edge>::CellQueueInfo>*
-		edge_queue_info)
+template <typename MESH, typename QUEUE, typename std::enable_if_t<std::is_base_of<CMapBase, MESH>::value>* = nullptr>
+void pre_collapse(const MESH& m, typename mesh_traits<MESH>::Edge e, typename mesh_traits<MESH>::Edge& e1,
+				  typename mesh_traits<MESH>::Edge& e2, QUEUE& edge_queue,
+				  typename mesh_traits<MESH>::template Attribute<typename QUEUE::CellQueueInfo>* edge_queue_info)
 {
 	using Edge = typename mesh_traits<MESH>::Edge;
-	using EdgeQueueInfo = typename CellQueue<Edge>::CellQueueInfo;
+	using EdgeQueueInfo = typename QUEUE::CellQueueInfo;
 
-	EdgeQueueInfo& ei = value<EdgeQueueInfo>(m, edge_queue_info, e);
-	if (ei.valid_)
-	{
-		edge_queue.cells_.erase(ei.it_);
-		ei.valid_ = false;
-	}
+	auto remove_edge = [&](Edge re) {
+		edge_queue.remove(index_of(m, re), value<EdgeQueueInfo>(m, edge_queue_info, re));
+	};
+
+	remove_edge(e);
 
 	e1 = Edge(phi2(m, phi_1(m, e.dart)));
 	e2 = Edge(phi2(m, phi_1(m, phi2(m, e.dart))));
@@ -104,45 +85,20 @@ void pre_collapse(
 	Dart ed1 = e.dart;
 	Dart ed2 = phi2(m, ed1);
 
-	EdgeQueueInfo& ei1 = value<EdgeQueueInfo>(m, edge_queue_info, Edge(phi1(m, ed1)));
-	if (ei1.valid_)
-	{
-		edge_queue.cells_.erase(ei1.it_);
-		ei1.valid_ = false;
-	}
-
-	EdgeQueueInfo& ei2 = value<EdgeQueueInfo>(m, edge_queue_info, Edge(phi_1(m, ed1)));
-	if (ei2.valid_)
-	{
-		edge_queue.cells_.erase(ei2.it_);
-		ei2.valid_ = false;
-	}
-
-	EdgeQueueInfo& ei3 = value<EdgeQueueInfo>(m, edge_queue_info, Edge(phi1(m, ed2)));
-	if (ei3.valid_)
-	{
-		edge_queue.cells_.erase(ei3.it_);
-		ei3.valid_ = false;
-	}
-
-	EdgeQueueInfo& ei4 = value<EdgeQueueInfo>(m, edge_queue_info, Edge(phi_1(m, ed2)));
-	if (ei4.valid_)
-	{
-		edge_queue.cells_.erase(ei4.it_);
-		ei4.valid_ = false;
-	}
+	remove_edge(Edge(phi1(m, ed1)));
+	remove_edge(Edge(phi_1(m, ed1)));
+	remove_edge(Edge(phi1(m, ed2)));
+	remove_edge(Edge(phi_1(m, ed2)));
 }
 
-template <typename MESH, typename FUNC, typename std::enable_if_t<std::is_base_of<CMapBase, MESH>::value>* = nullptr>
+template <typename MESH, typename QUEUE, typename FUNC,
+		  typename std::enable_if_t<std::is_base_of<CMapBase, MESH>::value>* = nullptr>
 void post_collapse(
-	const MESH& m, typename mesh_traits<MESH>::Edge& e1, typename mesh_traits<MESH>::Edge& e2,
-	CellQueue<typename mesh_traits<MESH>::Edge>& edge_queue,
-	typename mesh_traits<MESH>::template Attribute<typename CellQueue<typename mesh_traits<MESH>::Edge>::CellQueueInfo>*
-		edge_queue_info,
+	const MESH& m, typename mesh_traits<MESH>::Edge& e1, typename mesh_traits<MESH>::Edge& e2, QUEUE& edge_queue,
+	typename mesh_traits<MESH>::template Attribute<typename QUEUE::CellQueueInfo>* edge_queue_info,
 	const FUNC& edge_cost)
 {
 	using Edge = typename mesh_traits<MESH>::Edge;
-	using EdgeQueueInfo = typename CellQueue<Edge>::CellQueueInfo;
 
 	Dart vit = e1.dart;
 	do
@@ -172,17 +128,15 @@ void post_collapse(
 // CellFilter //
 ////////////////
 
-template <typename MESH, typename FUNC,
+template <typename MESH, typename QUEUE, typename FUNC,
 		  typename std::enable_if<std::is_base_of<CMapBase, MESH>::value>::type* = nullptr>
 void post_collapse(
 	const CellFilter<MESH>& cf, typename mesh_traits<MESH>::Edge& e1, typename mesh_traits<MESH>::Edge& e2,
-	CellQueue<typename mesh_traits<MESH>::Edge>& edge_queue,
-	typename mesh_traits<MESH>::template Attribute<typename CellQueue<typename mesh_traits<MESH>::Edge>::CellQueueInfo>*
-		edge_queue_info,
+	QUEUE& edge_queue,
+	typename mesh_traits<MESH>::template Attribute<typename QUEUE::CellQueueInfo>* edge_queue_info,
 	const FUNC& edge_cost)
 {
 	using Edge = typename mesh_traits<MESH>::Edge;
-	using EdgeQueueInfo = typename CellQueue<Edge>::CellQueueInfo;
 
 	const MESH& m = cf.mesh();
 
@@ -55,14 +55,14 @@ using Scalar = geometry::Scalar;
 
 inline void triangulate_incident_faces(CMap2& m, CMap2::Vertex v)
 {
-	std::vector<CMap2::Face> ifaces = incident_faces(m, v);
+	auto ifaces = incident_faces(m, v);
 	for (CMap2::Face f : ifaces)
 		cut_face(m, CMap2::Vertex(f.dart), CMap2::Vertex(phi<11>(m, f.dart)));
 }
 
 inline bool edge_should_flip(CMap2& m, CMap2::Edge e)
 {
-	std::vector<CMap2::Vertex> iv = incident_vertices(m, e);
+	auto iv = incident_vertices(m, e);
 	const int32 w = degree(m, iv[0]);
 	const int32 x = degree(m, iv[1]);
 	const int32 y = degree(m, CMap2::Vertex(phi1(m, phi1(m, iv[0].dart))));
@@ -136,7 +136,7 @@ struct PliantRemeshing_Helper
 		auto vertex_normal = add_attribute<Vec3, Vertex>(m_, "__vertex_normal");
 		geometry::compute_normal(m_, vertex_position_.get(), vertex_normal.get());
 		auto vertex_medial_point = add_attribute<Vec3, Vertex>(m_, "__vertex_medial_point");
-		geometry::shrinking_ball_centers(m_, vertex_position_.get(), vertex_normal.get(), vertex_medial_point.get());
+		geometry::shrinking_ball_centers(m_, vertex_position_, vertex_normal.get(), vertex_medial_point.get());
 
 		vertex_lfs_ = get_or_add_attribute<Scalar, Vertex>(m_, "__vertex_lfs");
 		lfs_min_ = std::numeric_limits<float64>::max();
@@ -181,7 +181,7 @@ struct PliantRemeshing_Helper
 			if (std::fabs(geometry::angle(m_, e, vertex_position_.get())) > angle_threshold)
 			{
 				value<bool>(m_, feature_edge_, e) = true;
-				std::vector<Vertex> iv = incident_vertices(m_, e);
+				auto iv = incident_vertices(m_, e);
 				value<bool>(m_, feature_vertex_, iv[0]) = true;
 				value<bool>(m_, feature_vertex_, iv[1]) = true;
 			}
@@ -249,7 +249,7 @@ void pliant_remeshing(MESH& m, std::shared_ptr<typename mesh_traits<MESH>::templ
 			cache.template build<Edge>();
 			has_long_edge = false;
 			foreach_cell(cache, [&](Edge e) -> bool {
-				std::vector<Vertex> iv = incident_vertices(m, e);
+				auto iv = incident_vertices(m, e);
 				Scalar lfs;
 				Scalar coeff = 1.0;
 				if (lfs_adaptive)
@@ -298,7 +298,7 @@ void pliant_remeshing(MESH& m, std::shared_ptr<typename mesh_traits<MESH>::templ
 		{
 			has_short_edge = false;
 			foreach_cell(m, [&](Edge e) -> bool {
-				std::vector<Vertex> iv = incident_vertices(m, e);
+				auto iv = incident_vertices(m, e);
 				Scalar lfs;
 				Scalar coeff = 1.0;
 				if (lfs_adaptive)
@@ -358,7 +358,7 @@ void pliant_remeshing(MESH& m, std::shared_ptr<typename mesh_traits<MESH>::templ
 			else
 			{
 				// Delaunay flips
-				std::vector<Vertex> iv = incident_vertices(m, e);
+				auto iv = incident_vertices(m, e);
 				if (degree(m, iv[0]) > 4 && degree(m, iv[1]) > 4)
 				{
 					std::vector<Scalar> op_angles = geometry::opposite_angles(m, e, vertex_position.get());
@@ -24,6 +24,7 @@
 #ifndef CGOGN_MODELING_ALGOS_SKELETON_H_
 #define CGOGN_MODELING_ALGOS_SKELETON_H_
 
+#include <cgogn/core/functions/mesh_info.h>
 #include <cgogn/core/functions/mesh_ops/edge.h>
 #include <cgogn/core/functions/traversals/global.h>
 #include <cgogn/core/functions/traversals/halfedge.h>
@@ -43,6 +44,7 @@
 
 #include <algorithm>
 #include <array>
+#include <memory>
 #include <vector>
 
 namespace cgogn
@@ -60,7 +62,7 @@ using Scalar = geometry::Scalar;
 
 inline void cut_incident_faces(CMap2& m, CMap2::Vertex v)
 {
-	std::vector<CMap2::Face> ifaces = incident_faces(m, v);
+	auto ifaces = incident_faces(m, v);
 	for (CMap2::Face f : ifaces)
 		cut_face(m, CMap2::Vertex(f.dart), CMap2::Vertex(phi<11>(m, f.dart)));
 }
@@ -130,7 +132,7 @@ struct MeanCurvatureSkeleton_Helper
 		geometry::compute_normal(m_, vertex_position_.get(), vertex_normal_.get());
 
 		vertex_medial_point_ = add_attribute<Vec3, Vertex>(m_, "__vertex_medial_point");
-		geometry::shrinking_ball_centers(m_, vertex_position_.get(), vertex_normal_.get(), vertex_medial_point_.get());
+		geometry::shrinking_ball_centers(m_, vertex_position_, vertex_normal_.get(), vertex_medial_point_.get());
 
 		vertex_is_fixed_ = add_attribute<bool, Vertex>(m_, "__vertex_is_fixed");
 		vertex_is_fixed_color_ = add_attribute<Vec3, Vertex>(m_, "__vertex_is_fixed_color");
@@ -142,16 +144,17 @@ struct MeanCurvatureSkeleton_Helper
 
 		edge_collapse_threshold_ = 0.004 * bb_diag;
 
-		vertex_index_ = add_attribute<uint32, Vertex>(m_, "__vertex_index");
-		edge_weight_ = add_attribute<Scalar, Edge>(m_, "__edge_weight");
+		laplacian_ = std::make_unique<geometry::CotanLaplacian<MESH>>(m_, vertex_position_.get());
+		vertex_maximum_index_ = maximum_index<Vertex>(m_);
+		connectivity_changed_ = false;
+		solver_pattern_analyzed_ = false;
 	}
 	~MeanCurvatureSkeleton_Helper()
 	{
+		laplacian_.reset();
 		remove_attribute<Vertex>(m_, vertex_normal_);
 		remove_attribute<Vertex>(m_, vertex_medial_point_);
 		remove_attribute<Vertex>(m_, vertex_is_fixed_);
-		remove_attribute<Vertex>(m_, vertex_index_);
-		remove_attribute<Edge>(m_, edge_weight_);
 	}
 
 	MESH& m_;
@@ -161,8 +164,13 @@ struct MeanCurvatureSkeleton_Helper
 	std::shared_ptr<Attribute<Vec3>> vertex_medial_point_;
 	std::shared_ptr<Attribute<bool>> vertex_is_fixed_;
 	std::shared_ptr<Attribute<Vec3>> vertex_is_fixed_color_;
-	std::shared_ptr<Attribute<uint32>> vertex_index_;
-	std::shared_ptr<Attribute<Scalar>> edge_weight_;
+
+	// the Laplacian pattern & the symbolic factorization are kept while the connectivity does not change
+	std::unique_ptr<geometry::CotanLaplacian<MESH>> laplacian_;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<Scalar, Eigen::ColMajor>> solver_;
+	uint32 vertex_maximum_index_; // maximum vertex index at the last update of the Laplacian connectivity
+	bool connectivity_changed_;
+	bool solver_pattern_analyzed_;
 
 	Scalar wL_, wH_, wM_, edge_collapse_threshold_;
 };
@@ -185,78 +193,59 @@ void mean_curvature_skeleton(MESH& m,
 	auto [it, inserted] = helpers_.try_emplace(&m, m, vertex_position, surface_resampling_ratio);
 	MeanCurvatureSkeleton_Helper<MESH>& helper = it->second;
 
-	uint32 nb_vertices = 0;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		value<uint32>(m, helper.vertex_index_, v) = nb_vertices++;
-		return true;
-	});
-
-	geometry::compute_edge_cotan_weight(m, helper.vertex_position_.get(), helper.edge_weight_.get());
-
-	std::vector<Eigen::Triplet<Scalar>> Acoeffs;
-	Acoeffs.reserve(nb_vertices * 10);
-
-	// smoothness
-	foreach_cell(m, [&](Edge e) -> bool {
-		Scalar w = value<Scalar>(m, helper.edge_weight_, e);
-		auto iv = incident_vertices(m, e);
-		uint32 vidx1 = value<uint32>(m, helper.vertex_index_, iv[0]);
-		uint32 vidx2 = value<uint32>(m, helper.vertex_index_, iv[1]);
-		Scalar v_wL1 = value<bool>(m, helper.vertex_is_fixed_, iv[0]) ? 0.0 : wL;
-		Scalar v_wL2 = value<bool>(m, helper.vertex_is_fixed_, iv[1]) ? 0.0 : wL;
-		Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx1), int(vidx2), w* v_wL1));
-		Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx1), int(vidx1), -w* v_wL1));
-		Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx2), int(vidx1), w* v_wL2));
-		Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx2), int(vidx2), -w* v_wL2));
-		return true;
-	});
-
-	// velocity
-	foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, helper.vertex_index_, v);
-		Scalar v_wH = value<bool>(m, helper.vertex_is_fixed_, v) ? 1e6 : wH;
-		Acoeffs.push_back(Eigen::Triplet<Scalar>(int(nb_vertices + vidx), int(vidx), v_wH));
-		return true;
-	});
-
-	// medial attraction
-	foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, helper.vertex_index_, v);
-		Scalar v_wM = value<bool>(m, helper.vertex_is_fixed_, v) ? 0.0 : wM;
-		Acoeffs.push_back(Eigen::Triplet<Scalar>(int(2 * nb_vertices + vidx), int(vidx), v_wM));
-		return true;
-	});
+	// the helper outlives the call: the mesh may have been edited in between by other operations than the ones of
+	// this function (which set connectivity_changed_), detected here by a change of the vertices count or indexing
+	if (!helper.connectivity_changed_ && (maximum_index<Vertex>(m) != helper.vertex_maximum_index_ ||
+										  nb_cells<Vertex>(m) != helper.laplacian_->nb_vertices()))
+		helper.connectivity_changed_ = true;
 
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> A(3 * nb_vertices, nb_vertices);
-	A.setFromTriplets(Acoeffs.begin(), Acoeffs.end());
-
-	Eigen::MatrixXd x(nb_vertices, 3);
-	Eigen::MatrixXd b(3 * nb_vertices, 3);
-
-	foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, helper.vertex_index_, v);
-		b(vidx, 0) = 0;
-		b(vidx, 1) = 0;
-		b(vidx, 2) = 0;
+	if (helper.connectivity_changed_)
+	{
+		helper.laplacian_->update_connectivity();
+		helper.vertex_maximum_index_ = maximum_index<Vertex>(m);
+		helper.connectivity_changed_ = false;
+		helper.solver_pattern_analyzed_ = false;
+	}
+	helper.laplacian_->update_values();
+
+	const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& LAPL = helper.laplacian_->matrix();
+	uint32 nb_vertices = helper.laplacian_->nb_vertices();
+
+	// the least squares system stacks the smoothness (wL * LAPL), velocity (wH) & medial attraction (wM) rows:
+	// its normal equations are (LAPL^T * wL^2 * LAPL + wH^2 + wM^2) x = wH^2 * position + wM^2 * medial_point
+	Eigen::VectorXd wL2(nb_vertices);
+	Eigen::VectorXd wHM2(nb_vertices);
+	Eigen::MatrixXd b(nb_vertices, 3);
+	parallel_foreach_cell(m, [&](Vertex v) -> bool {
+		uint32 vidx = helper.laplacian_->vertex_index(v);
+		bool is_fixed = value<bool>(m, helper.vertex_is_fixed_, v);
+		Scalar v_wL = is_fixed ? 0.0 : wL;
+		Scalar v_wH = is_fixed ? 1e6 : wH;
+		Scalar v_wM = is_fixed ? 0.0 : wM;
+		wL2(vidx) = v_wL * v_wL;
+		wHM2(vidx) = v_wH * v_wH + v_wM * v_wM;
 		const Vec3& pos = value<Vec3>(m, helper.vertex_position_, v);
-		Scalar v_wH = value<bool>(m, helper.vertex_is_fixed_, v) ? 1e6 : wH;
-		b(nb_vertices + vidx, 0) = v_wH * pos[0];
-		b(nb_vertices + vidx, 1) = v_wH * pos[1];
-		b(nb_vertices + vidx, 2) = v_wH * pos[2];
 		const Vec3& medp = value<Vec3>(m, helper.vertex_medial_point_, v);
-		Scalar v_wM = value<bool>(m, helper.vertex_is_fixed_, v) ? 0.0 : wM;
-		b(2 * nb_vertices + vidx, 0) = v_wM * medp[0];
-		b(2 * nb_vertices + vidx, 1) = v_wM * medp[1];
-		b(2 * nb_vertices + vidx, 2) = v_wM * medp[2];
+		for (uint32 i = 0; i < 3; ++i)
+			b(vidx, i) = v_wH * v_wH * pos[i] + v_wM * v_wM * medp[i];
 		return true;
 	});
 
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> At = A.transpose();
-	Eigen::SimplicialLDLT<Eigen::SparseMatrix<Scalar, Eigen::ColMajor>> solver(At * A);
-	x = solver.solve(At * b);
+	// the pattern of N only depends on the pattern of LAPL (the diagonal is always present)
+	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> N = LAPL.transpose() * (wL2.asDiagonal() * LAPL);
+	for (uint32 i = 0; i < nb_vertices; ++i)
+		N.coeffRef(i, i) += wHM2(i);
 
-	foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, helper.vertex_index_, v);
+	if (!helper.solver_pattern_analyzed_)
+	{
+		helper.solver_.analyzePattern(N);
+		helper.solver_pattern_analyzed_ = true;
+	}
+	helper.solver_.factorize(N);
+	Eigen::MatrixXd x = helper.solver_.solve(b);
+
+	parallel_foreach_cell(m, [&](Vertex v) -> bool {
+		uint32 vidx = helper.laplacian_->vertex_index(v);
 		Vec3& pos = value<Vec3>(m, helper.vertex_position_, v);
 		pos[0] = x(vidx, 0);
 		pos[1] = x(vidx, 1);
@@ -269,7 +258,7 @@ void mean_curvature_skeleton(MESH& m,
 	{
 		has_flat_edge = false;
 		foreach_cell(m, [&](Edge e) -> bool {
-			std::vector<Vertex> iv = incident_vertices(m, e);
+			auto iv = incident_vertices(m, e);
 			if (degree(m, iv[0]) < 5 || degree(m, iv[1]) < 5)
 				return true;
 
@@ -280,7 +269,10 @@ void mean_curvature_skeleton(MESH& m,
 				if (edge_can_flip(m, e))
 				{
 					if (flip_edge(m, e))
+					{
 						has_flat_edge = true;
+						helper.connectivity_changed_ = true;
+					}
 				}
 			}
 			return true;
@@ -348,12 +340,13 @@ void mean_curvature_skeleton(MESH& m,
 	{
 		has_short_edge = false;
 		foreach_cell(m, [&](Edge e) -> bool {
-			std::vector<Vertex> iv = incident_vertices(m, e);
+			auto iv = incident_vertices(m, e);
 			if (geometry::length(m, e, helper.vertex_position_.get()) < helper.edge_collapse_threshold_)
 			{
 				if (edge_can_collapse(m, e))
 				{
 					has_short_edge = true;
+					helper.connectivity_changed_ = true;
 					Vec3 newp = (value<Vec3>(m, helper.vertex_position_, iv[0]) +
 								 value<Vec3>(m, helper.vertex_position_, iv[1])) *
 								0.5;
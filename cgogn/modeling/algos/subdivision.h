@@ -33,6 +33,8 @@
 
 #include <cgogn/geometry/algos/angle.h>
 
+#include <queue>
+
 namespace cgogn
 {
 
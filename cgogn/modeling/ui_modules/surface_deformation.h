@@ -30,6 +30,7 @@
 #include <cgogn/ui/module.h>
 
 #include <cgogn/geometry/algos/angle.h>
+#include <cgogn/geometry/algos/incremental_geometry.h>
 #include <cgogn/geometry/algos/laplacian.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
@@ -65,7 +66,7 @@ class SurfaceDeformation : public ViewModule
 	struct Parameters
 	{
 		Parameters()
-			: vertex_position_(nullptr), selected_free_vertices_set_(nullptr), selected_handle_vertices_set_(nullptr),
+			: vertex_position_(nullptr), vertex_normal_(nullptr), selected_free_vertices_set_(nullptr), selected_handle_vertices_set_(nullptr),
 			  initialized_(false), solver_ready_(false), vertex_position_init_(nullptr), vertex_diff_coord_(nullptr),
 			  vertex_bi_diff_coord_(nullptr), vertex_rotation_matrix_(nullptr), vertex_rotated_diff_coord_(nullptr),
 			  vertex_rotated_bi_diff_coord_(nullptr), vertex_index_(nullptr), edge_weight_(nullptr), solver_(nullptr)
@@ -81,6 +82,10 @@ class SurfaceDeformation : public ViewModule
 		CGOGN_NOT_COPYABLE_NOR_MOVABLE(Parameters);
 
 		std::shared_ptr<Attribute<Vec3>> vertex_position_;
+		std::shared_ptr<Attribute<Vec3>> vertex_normal_;
+
+		// keeps the normals of the working area up to date while dragging (built on the first drag)
+		std::unique_ptr<geometry::IncrementalGeometry<MESH>> incremental_geometry_;
 
 		CellsSet<MESH, Vertex>* selected_free_vertices_set_;
 		CellsSet<MESH, Vertex>* selected_handle_vertices_set_;
@@ -465,6 +470,14 @@ public:
 	{
 		Parameters& p = parameters_[&m];
 		p.vertex_position_ = vertex_position;
+		p.incremental_geometry_.reset();
+	}
+
+	void set_vertex_normal(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_normal)
+	{
+		Parameters& p = parameters_[&m];
+		p.vertex_normal_ = vertex_normal;
+		p.incremental_geometry_.reset();
 	}
 
 	void set_selected_free_vertices_set(const MESH& m, CellsSet<MESH, Vertex>* set)
@@ -538,7 +551,25 @@ protected:
 			as_rigid_as_possible(*selected_mesh_);
 			previous_drag_pos_ = drag_pos;
 
+			// only the normals around the working area are recomputed
+			if (p.vertex_normal_)
+			{
+				if (!p.incremental_geometry_)
+				{
+					p.incremental_geometry_ = std::make_unique<geometry::IncrementalGeometry<MESH>>(
+						*selected_mesh_, p.vertex_position_.get());
+					p.incremental_geometry_->set_vertex_normal(p.vertex_normal_.get());
+				}
+				foreach_cell(*p.working_cells_, [&](Vertex v) -> bool {
+					p.incremental_geometry_->vertex_moved(v);
+					return true;
+				});
+				p.incremental_geometry_->update();
+			}
+
 			mesh_provider_->emit_attribute_changed(*selected_mesh_, p.vertex_position_.get());
+			if (p.vertex_normal_)
+				mesh_provider_->emit_attribute_changed(*selected_mesh_, p.vertex_normal_.get());
 		}
 	}
 
@@ -560,6 +591,10 @@ protected:
 												[&](const std::shared_ptr<Attribute<Vec3>>& attribute) {
 													set_vertex_position(*selected_mesh_, attribute);
 												});
+			imgui_combo_attribute<Vertex, Vec3>(*selected_mesh_, p.vertex_normal_, "Normal",
+												[&](const std::shared_ptr<Attribute<Vec3>>& attribute) {
+													set_vertex_normal(*selected_mesh_, attribute);
+												});
 
 			if (p.vertex_position_)
 			{
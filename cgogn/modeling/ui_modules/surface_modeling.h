@@ -31,6 +31,7 @@
 #include <cgogn/geometry/types/vector_traits.h>
 
 #include <cgogn/geometry/algos/filtering.h>
+#include <cgogn/geometry/algos/incremental_geometry.h>
 #include <cgogn/geometry/algos/laplacian.h>
 
 #include <cgogn/modeling/algos/decimation/decimation.h>
@@ -65,7 +66,7 @@ class SurfaceModeling : public Module
 public:
 	SurfaceModeling(const App& app)
 		: Module(app, "SurfaceModeling (" + std::string{mesh_traits<MESH>::name} + ")"), selected_mesh_(nullptr),
-		  selected_vertex_position_(nullptr)
+		  selected_vertex_position_(nullptr), selected_vertex_normal_(nullptr)
 	{
 	}
 	~SurfaceModeling()
@@ -136,8 +137,13 @@ public:
 		mesh_provider_->emit_attribute_changed(m, vertex_position);
 	}
 
-	void delaunay_flips(MESH& m, Attribute<Vec3>* vertex_position)
+	// if given, vertex_normal is updated around the flipped edges only
+	void delaunay_flips(MESH& m, Attribute<Vec3>* vertex_position, Attribute<Vec3>* vertex_normal = nullptr)
 	{
+		geometry::IncrementalGeometry<MESH> incremental_geometry(m, vertex_position);
+		if (vertex_normal)
+			incremental_geometry.set_vertex_normal(vertex_normal);
+
 		foreach_cell(m, [&](Edge e) -> bool {
 			if (edge_can_flip(m, e))
 			{
@@ -146,12 +152,15 @@ public:
 					return true;
 				std::vector<Scalar> op_angles = geometry::opposite_angles(m, e, vertex_position);
 				if (op_angles[0] + op_angles[1] > M_PI)
-					flip_edge(m, e);
+					incremental_geometry.flip_edge(e);
 			}
 			return true;
 		});
+		incremental_geometry.update();
 
 		mesh_provider_->emit_connectivity_changed(m);
+		if (vertex_normal)
+			mesh_provider_->emit_attribute_changed(m, vertex_normal);
 	}
 
 	void decimate_mesh(MESH& m, Attribute<Vec3>* vertex_position, uint32 percent_vertices_to_remove)
@@ -197,7 +206,7 @@ protected:
 		imgui_mesh_selector(mesh_provider_, selected_mesh_, "Surface", [&](MESH& m) {
 			selected_mesh_ = &m;
 			selected_vertex_position_.reset();
-			// selected_vertex_normal_.reset();
+			selected_vertex_normal_.reset();
 			mesh_provider_->mesh_data(m).outlined_until_ = App::frame_time_ + 1.0;
 		});
 
@@ -207,9 +216,9 @@ protected:
 				*selected_mesh_, selected_vertex_position_, "Position",
 				[&](const std::shared_ptr<Attribute<Vec3>>& attribute) { selected_vertex_position_ = attribute; });
 
-			// imgui_combo_attribute<Vertex, Vec3>(
-			// 	*selected_mesh_, selected_vertex_normal_, "Normal",
-			// 	[&](const std::shared_ptr<Attribute<Vec3>>& attribute) { selected_vertex_normal_ = attribute; });
+			imgui_combo_attribute<Vertex, Vec3>(
+				*selected_mesh_, selected_vertex_normal_, "Normal",
+				[&](const std::shared_ptr<Attribute<Vec3>>& attribute) { selected_vertex_normal_ = attribute; });
 
 			if (selected_vertex_position_)
 			{
@@ -222,7 +231,7 @@ protected:
 				if (ImGui::Button("Catmull-Clark subdivision"))
 					subdivide_catmull_clark(*selected_mesh_, selected_vertex_position_.get());
 				if (ImGui::Button("Delaunay flips"))
-					delaunay_flips(*selected_mesh_, selected_vertex_position_.get());
+					delaunay_flips(*selected_mesh_, selected_vertex_position_.get(), selected_vertex_normal_.get());
 				if (ImGui::Button("Fill holes"))
 					fill_holes(*selected_mesh_);
 				static int32 min_vertices = 1000;
@@ -255,7 +264,7 @@ protected:
 private:
 	MESH* selected_mesh_;
 	std::shared_ptr<Attribute<Vec3>> selected_vertex_position_;
-	// std::shared_ptr<Attribute<Vec3>> selected_vertex_normal_;
+	std::shared_ptr<Attribute<Vec3>> selected_vertex_normal_;
 	MeshProvider<MESH>* mesh_provider_;
 };
 
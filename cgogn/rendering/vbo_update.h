@@ -25,6 +25,7 @@
 #ifndef CGOGN_RENDERING_SHADERS_VBO_H_
 #define CGOGN_RENDERING_SHADERS_VBO_H_
 
+#include <cgogn/core/types/container/aligned_array.h>
 #include <cgogn/core/types/container/chunk_array.h>
 #include <cgogn/core/types/container/vector.h>
 #include <cgogn/core/utils/numerics.h>
@@ -167,8 +168,9 @@ void update_vbo(const Vector<VEC>* attribute, VBO* vbo, const FUNC& convert)
 	vbo->bind();
 	vbo->allocate(nb_elements, output_type_size);
 	OutputType* dst = reinterpret_cast<OutputType*>(vbo->lock_pointer());
-	for (const VEC& v : *attribute)
-		*dst++ = convert(v);
+	// written by index (the iterator skips the released indices): the vbo entries match the element indices
+	for (uint32 i = 0; i < nb_elements; ++i)
+		dst[i] = convert((*attribute)[i]);
 	vbo->release_pointer();
 	vbo->release();
 }
@@ -201,6 +203,86 @@ void update_vbo(const Vector<VEC>* attribute, VBO* vbo)
 	}
 }
 
+//////////////////
+// AlignedArray //
+//////////////////
+
+/**
+ * @brief update vbo from an AlignedArray<VEC>
+ * @param attribute
+ * @param vbo vbo to update
+ */
+template <typename VEC,
+		  typename std::enable_if<std::is_same<typename geometry::vector_traits<VEC>::Scalar, float32>::value>::type* =
+			  nullptr>
+void update_vbo(const AlignedArray<VEC>* attribute, VBO* vbo)
+{
+	vbo->set_name(attribute->name());
+
+	static const std::size_t element_size = geometry::vector_traits<VEC>::SIZE;
+	uint32 nb_elements = attribute->maximum_index();
+
+	vbo->bind();
+	vbo->allocate(nb_elements, element_size);
+	vbo->copy_data(0, nb_elements * element_size * uint32(sizeof(float32)), attribute->data_pointer());
+	vbo->release();
+}
+
+/**
+ * @brief update vbo from an on-the-fly converted AlignedArray<VEC>
+ * @param attribute
+ * @param vbo vbo to update
+ * @param convert the conversion function
+ */
+template <typename VEC, typename FUNC>
+void update_vbo(const AlignedArray<VEC>* attribute, VBO* vbo, const FUNC& convert)
+{
+	static_assert(is_func_parameter_same<FUNC, const VEC&>::value, "Wrong conversion function parameter type");
+
+	vbo->set_name(attribute->name());
+
+	using OutputType = func_return_type<FUNC>;
+	static const std::size_t output_type_size = geometry::vector_traits<OutputType>::SIZE;
+	uint32 nb_elements = attribute->maximum_index();
+
+	vbo->bind();
+	vbo->allocate(nb_elements, output_type_size);
+	OutputType* dst = reinterpret_cast<OutputType*>(vbo->lock_pointer());
+	// written by index (the iterator skips the released indices): the vbo entries match the element indices
+	for (uint32 i = 0; i < nb_elements; ++i)
+		dst[i] = convert((*attribute)[i]);
+	vbo->release_pointer();
+	vbo->release();
+}
+
+template <typename VEC,
+		  typename std::enable_if<std::is_same<typename geometry::vector_traits<VEC>::Scalar, float64>::value>::type* =
+			  nullptr>
+void update_vbo(const AlignedArray<VEC>* attribute, VBO* vbo)
+{
+	static const std::size_t element_size = geometry::vector_traits<VEC>::SIZE;
+	if constexpr (element_size == 1)
+	{
+		update_vbo(attribute, vbo, [](const VEC& n) -> float32 { return float32(n); });
+	}
+	if constexpr (element_size == 2)
+	{
+		update_vbo(attribute, vbo, [](const VEC& n) -> geometry::Vec2f { return {float32(n[0]), float32(n[1])}; });
+	}
+	if constexpr (element_size == 3)
+	{
+		update_vbo(attribute, vbo, [](const VEC& n) -> geometry::Vec3f {
+			return {float32(n[0]), float32(n[1]), float32(n[2])};
+		});
+	}
+	if constexpr (element_size == 4)
+	{
+		update_vbo(attribute, vbo, [](const VEC& n) -> geometry::Vec4f {
+			return {float32(n[0]), float32(n[1]), float32(n[2]), float32(n[3])};
+		});
+	}
+}
+
 ////////////////
 // ChunkArray //
 ////////////////
@@ -24,6 +24,7 @@
 #ifndef CGOGN_SIMULATION_SHALLOW_WATER_RIEMANN_SOLVER_H_
 #define CGOGN_SIMULATION_SHALLOW_WATER_RIEMANN_SOLVER_H_
 
+#include <cgogn/core/utils/numerics.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
 namespace cgogn
@@ -84,12 +85,66 @@ struct Str_Riemann_Flux
 		s2R; /**< Quantité de mouvement associée well-balancing du terme source pour la maille droite de l'interface **/
 };
 
+/**
+ * Batched interfaces: the n states and fluxes are given as structures of arrays
+ */
+struct Str_Riemann_States
+{
+	const Scalar* zbL;
+	const Scalar* zbR;
+	const Scalar* PhiL;
+	const Scalar* PhiR;
+	const Scalar* hL;
+	const Scalar* qL; /**< in the frame of the interface (normal component) **/
+	const Scalar* rL; /**< in the frame of the interface (longitudinal component) **/
+	const Scalar* hR;
+	const Scalar* qR;
+	const Scalar* rR;
+};
+
+struct Str_Border_States
+{
+	const BoundaryCondition* typBC;
+	const Scalar* valBC;
+	const Scalar* NormX;
+	const Scalar* NormY;
+	const Scalar* q; /**< in the global frame **/
+	const Scalar* r;
+	const Scalar* z;
+	const Scalar* zb;
+};
+
+struct Str_Riemann_Fluxes
+{
+	Scalar* F1;
+	Scalar* F2;
+	Scalar* F3;
+	Scalar* s2L;
+	Scalar* s2R;
+};
+
 Str_Riemann_Flux Solv_HLLC(Scalar g, Scalar hmin, Scalar smalll, Scalar zbL, Scalar zbR, Scalar PhiL, Scalar PhiR,
 						   Scalar hL, Scalar qL, Scalar rL, Scalar hR, Scalar qR, Scalar rR);
 
 Str_Riemann_Flux border_condition(BoundaryCondition typBC, Scalar valBC, Scalar NormX, Scalar NormY, Scalar q, Scalar r,
 								  Scalar z, Scalar zb, Scalar g, Scalar hmin, Scalar smalll);
 
+/**
+ * @brief batched Solv_HLLC: the branches are evaluated for all the interfaces and selected afterwards so that the
+ * packs of interfaces are vectorized
+ * The batched kernels are compiled without FMA contraction: their results are the same (bit for bit) as the ones of
+ * the scalar version as long as the compiler does not contract the scalar version either (i.e. when the target has no
+ * FMA instructions, as the default x86-64 one).
+ */
+void Solv_HLLC(Scalar g, Scalar hmin, Scalar smalll, uint32 n, const Str_Riemann_States& states,
+			   const Str_Riemann_Fluxes& fluxes);
+
+/**
+ * @brief batched border_condition (same results as the scalar version)
+ */
+void border_condition(uint32 n, const Str_Border_States& states, Scalar g, Scalar hmin, Scalar smalll,
+					  const Str_Riemann_Fluxes& fluxes);
+
 } // namespace shallow_water
 
 } // namespace simulation
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * CGoGN                                                                        *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/simulation/algos/shallow_water/riemann_solver.h>
+
+namespace cgogn
+{
+
+namespace simulation
+{
+
+namespace shallow_water
+{
+
+namespace
+{
+
+// number of interfaces processed together by the batched solver
+constexpr uint32 HLLC_PACK_SIZE = 8u;
+
+// branchless version of Solv_HLLC: each expression is the same as in the scalar version
+inline void Solv_HLLC_select(Scalar g, Scalar hmin, Scalar smalll, Scalar zbL, Scalar zbR, Scalar PhiL, Scalar PhiR,
+							 Scalar hL, Scalar qL, Scalar rL, Scalar hR, Scalar qR, Scalar rR, Scalar& F1, Scalar& F2,
+							 Scalar& F3, Scalar& s2L, Scalar& s2R)
+{
+	Scalar zL = zbL + hL;
+	Scalar zR = zbR + hR;
+
+	bool exchange = ((hL > hmin) & (hR > hmin)) | ((hL < hmin) & (zR >= zbL + hmin) & (hR > hmin)) |
+					((hR < hmin) & (zL >= zbR + hmin) & (hL > hmin));
+	bool emptyL = !exchange & (hL < hmin) & (zR < zbL) & (hR > hmin);
+	bool emptyR = !exchange & !emptyL & (hR < hmin) & (zL < zbR) & (hL > hmin);
+
+	//---possible exchange--------
+	Scalar L1L = qL / std::max(hL, smalll) - sqrt(g * std::max(hL, smalll));
+	Scalar L3L = qL / std::max(hL, smalll) + sqrt(g * std::max(hL, smalll));
+	Scalar L1R = qR / std::max(hR, smalll) - sqrt(g * std::max(hR, smalll));
+	Scalar L3R = qR / std::max(hR, smalll) + sqrt(g * std::max(hR, smalll));
+	Scalar L1LR = std::min(std::min(L1L, L1R), 0e0);
+	Scalar L3LR = std::max(std::max(L3L, L3R), 0e0);
+	Scalar PhiLR = std::min(PhiL, PhiR);
+	Scalar eF1 = L3LR * qL - L1LR * qR + L1LR * L3LR * (zR - zL);
+	eF1 = eF1 * PhiLR / std::max(L3LR - L1LR, smalll);
+	Scalar F2L = (qL * qL) / std::max(hL, smalll) + 5e-1 * g * hL * hL;
+	Scalar F2R = (qR * qR) / std::max(hR, smalll) + 5e-1 * g * hR * hR;
+	Scalar eF2 = (L3LR * PhiL * F2L - L1LR * PhiR * F2R + L1LR * L3LR * (PhiR * qR - PhiL * qL)) /
+				 std::max(L3LR - L1LR, smalll);
+	Scalar Fact = 0.5 * PhiLR * (hL + hR);
+	Scalar es2L = 0.5 * (PhiL * hL * hL - PhiR * hR * hR) - Fact * (zL - zR);
+	es2L = g * L1LR * es2L / std::max(L3LR - L1LR, smalll);
+	Scalar es2R = 0.5 * (PhiR * hR * hR - PhiL * hL * hL) - Fact * (zR - zL);
+	es2R = g * L3LR * es2R / std::max(L3LR - L1LR, smalll);
+	Scalar eF3r = eF1 > 0 ? rL : rR;
+	Scalar eF3h = eF1 > 0 ? hL : hR;
+	Scalar eF3 = eF1 * eF3r / std::max(eF3h, smalll);
+
+	//------impossible exchange-Cell L or R empty------
+	Scalar Ls2R = PhiR * 5e-1 * g * hR * hR;
+	Scalar Rs2L = -PhiL * 0.5 * g * hL * hL;
+
+	F1 = exchange ? eF1 : 0e0;
+	F2 = exchange ? eF2 : 0e0;
+	F3 = exchange ? eF3 : 0e0;
+	s2L = exchange ? es2L : (emptyR ? Rs2L : 0e0);
+	s2R = exchange ? es2R : (emptyL ? Ls2R : 0e0);
+}
+
+} // namespace
+
+void Solv_HLLC(Scalar g, Scalar hmin, Scalar smalll, uint32 n, const Str_Riemann_States& states,
+			   const Str_Riemann_Fluxes& fluxes)
+{
+	const Scalar *zbL = states.zbL, *zbR = states.zbR, *PhiL = states.PhiL, *PhiR = states.PhiR;
+	const Scalar *hL = states.hL, *qL = states.qL, *rL = states.rL, *hR = states.hR, *qR = states.qR, *rR = states.rR;
+
+	uint64 i = 0u; // (64 bits index: i + j does not wrap around, which the vectorizer needs to know)
+	for (; i + HLLC_PACK_SIZE <= n; i += HLLC_PACK_SIZE)
+	{
+		// the results of a pack go through local arrays: they cannot alias the inputs
+		Scalar F1[HLLC_PACK_SIZE], F2[HLLC_PACK_SIZE], F3[HLLC_PACK_SIZE], s2L[HLLC_PACK_SIZE], s2R[HLLC_PACK_SIZE];
+		for (uint32 j = 0u; j < HLLC_PACK_SIZE; ++j)
+			Solv_HLLC_select(g, hmin, smalll, zbL[i + j], zbR[i + j], PhiL[i + j], PhiR[i + j], hL[i + j], qL[i + j],
+							 rL[i + j], hR[i + j], qR[i + j], rR[i + j], F1[j], F2[j], F3[j], s2L[j], s2R[j]);
+		for (uint32 j = 0u; j < HLLC_PACK_SIZE; ++j)
+		{
+			fluxes.F1[i + j] = F1[j];
+			fluxes.F2[i + j] = F2[j];
+			fluxes.F3[i + j] = F3[j];
+			fluxes.s2L[i + j] = s2L[j];
+			fluxes.s2R[i + j] = s2R[j];
+		}
+	}
+	for (; i < n; ++i)
+		Solv_HLLC_select(g, hmin, smalll, zbL[i], zbR[i], PhiL[i], PhiR[i], hL[i], qL[i], rL[i], hR[i], qR[i], rR[i],
+						 fluxes.F1[i], fluxes.F2[i], fluxes.F3[i], fluxes.s2L[i], fluxes.s2R[i]);
+}
+
+void border_condition(uint32 n, const Str_Border_States& states, Scalar g, Scalar hmin, Scalar smalll,
+					  const Str_Riemann_Fluxes& fluxes)
+{
+	// the boundary interfaces are few & each one branches on its own boundary condition type:
+	// they are simply processed one after the other
+	for (uint32 i = 0u; i < n; ++i)
+	{
+		Str_Riemann_Flux flux =
+			border_condition(states.typBC[i], states.valBC[i], states.NormX[i], states.NormY[i], states.q[i],
+							 states.r[i], states.z[i], states.zb[i], g, hmin, smalll);
+		fluxes.F1[i] = flux.F1;
+		fluxes.F2[i] = flux.F2;
+		fluxes.F3[i] = flux.F3;
+		fluxes.s2L[i] = flux.s2L;
+		fluxes.s2R[i] = flux.s2R;
+	}
+}
+
+} // namespace shallow_water
+
+} // namespace simulation
+
+} // namespace cgogn
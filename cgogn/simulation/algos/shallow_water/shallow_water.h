@@ -28,15 +28,29 @@
 
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/mesh_ops/edge.h>
+#include <cgogn/core/functions/mesh_ops/face.h>
 #include <cgogn/core/functions/traversals/face.h>
 #include <cgogn/core/functions/traversals/global.h>
 #include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/types/cmap/phi.h>
 
 #include <cgogn/geometry/algos/area.h>
 #include <cgogn/geometry/algos/length.h>
 
 #include <cgogn/simulation/algos/shallow_water/riemann_solver.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace cgogn
 {
 
@@ -49,6 +63,38 @@ namespace shallow_water
 using Vec3 = geometry::Vec3;
 using Scalar = geometry::Scalar;
 
+/**
+ * Connectivity of the domain in flat arrays (the cells are given by their index)
+ * The topology only changes when the mesh is adapted: it is extracted again after each adaptation so that the time step
+ * kernels are plain indexed loops instead of mesh traversals.
+ */
+struct Connectivity
+{
+	// left & right faces of each edge (the right face of a boundary edge is INVALID_INDEX)
+	std::vector<uint32> edges_;
+	std::vector<uint32> edge_left_face_;
+	std::vector<uint32> edge_right_face_;
+
+	// incident edges of each face (CSR), side of the face w.r.t. each edge (-1 on the left, +1 on the right),
+	// face on the other side of each edge & position of the edge in the list of this other face (INVALID_INDEX on the
+	// boundary)
+	std::vector<uint32> faces_;
+	std::vector<uint32> face_edges_offset_;
+	std::vector<uint32> face_edges_;
+	std::vector<Scalar> face_edges_sign_;
+	std::vector<uint32> face_edges_neighbour_;
+	std::vector<uint32> face_edges_twin_;
+
+	inline uint32 nb_edges() const
+	{
+		return uint32(edges_.size());
+	}
+	inline uint32 nb_faces() const
+	{
+		return uint32(faces_.size());
+	}
+};
+
 template <typename MESH>
 struct Attributes
 {
@@ -78,6 +124,19 @@ struct Attributes
 	std::shared_ptr<Attribute<Scalar>> edge_bc_value_;
 	std::shared_ptr<Attribute<BoundaryCondition>> edge_bc_type_;
 	std::shared_ptr<Attribute<uint32>> edge_left_face_index_;
+
+	// adaptive mesh: subdivision level of the faces, level at which the vertices have been created & centers of the
+	// subdivided faces
+	std::shared_ptr<Attribute<uint32>> face_level_;
+	std::shared_ptr<Attribute<uint32>> vertex_level_;
+	std::shared_ptr<Attribute<uint8>> vertex_center_;
+
+	Connectivity connectivity_;
+
+	// flux balance of each face (in the order of connectivity_.faces_), computed by the fused kernels
+	std::vector<Scalar> face_balance_h_;
+	std::vector<Scalar> face_balance_q_;
+	std::vector<Scalar> face_balance_r_;
 };
 
 struct Context
@@ -96,8 +155,46 @@ struct Context
 	Scalar t_max_ = 10.0;
 	Scalar dt_ = 0.0;
 	Scalar dt_max_ = 1.0;
+	uint32 nb_steps_ = 0;
+
+	// each time step lasts at least dt_ of wall-clock time (interactive display), otherwise run as fast as possible
+	bool real_time_ = true;
+
+	// compute the fluxes, the flux balance of the faces & the time step in a single pass over the faces, then update
+	// & correct the faces in a second pass: the fluxes are not stored on the edges (edge_f1_, ..., face_swept_ &
+	// face_discharge_ are not updated) and the fluxes of the edges between two blocks of faces are computed twice (once
+	// for each side). The time step is the same as in the default mode but the updated states differ from it by
+	// rounding.
+	bool fused_kernels_ = false;
+
+	// adaptive mesh (CMap2 only): every adaptation_interval_ steps, the faces whose water height differs from the one
+	// of a neighbour by more than refinement_threshold_ are subdivided (up to max_level_ times) & the subdivided faces
+	// whose children are all calm or dry (differences below coarsening_threshold_) are merged back.
+	// The water volume & the momentum are conserved by the transfers between levels.
+	bool adaptive_mesh_ = false;
+	uint32 adaptation_interval_ = 10;
+	uint32 max_level_ = 3;
+	Scalar refinement_threshold_ = 0.1;
+	Scalar coarsening_threshold_ = 0.02;
+
+	// cumulated duration (in seconds) of each kernel of the time steps (only measured if measure_kernel_timings_)
+	bool measure_kernel_timings_ = false;
+	std::vector<std::pair<std::string, float64>> kernel_timings_;
 };
 
+inline void add_kernel_timing(Context& swc, const std::string& name, float64 duration)
+{
+	for (auto& [kernel, time] : swc.kernel_timings_)
+	{
+		if (kernel == name)
+		{
+			time += duration;
+			return;
+		}
+	}
+	swc.kernel_timings_.emplace_back(name, duration);
+}
+
 template <typename MESH>
 void get_attributes(MESH& m, Attributes<MESH>& swa)
 {
@@ -128,20 +225,122 @@ void get_attributes(MESH& m, Attributes<MESH>& swa)
 	swa.edge_bc_value_ = add_attribute<Scalar, Edge>(m, "bc_value");
 	swa.edge_bc_type_ = add_attribute<BoundaryCondition, Edge>(m, "bc_type");
 	swa.edge_left_face_index_ = add_attribute<uint32, Edge>(m, "left_face_index");
+
+	swa.face_level_ = add_attribute<uint32, Face>(m, "level");
+	swa.vertex_level_ = add_attribute<uint32, Vertex>(m, "level");
+	swa.vertex_center_ = add_attribute<uint8, Vertex>(m, "center");
 }
 
+// must be called again if the topology of the domain is modified
 template <typename MESH>
-void init_attributes(MESH& m, Attributes<MESH>& swa, Context& swc)
+void build_connectivity(const MESH& m, Attributes<MESH>& swa)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Edge = typename mesh_traits<MESH>::Edge;
 	using Face = typename mesh_traits<MESH>::Face;
 
-	parallel_foreach_cell(m, [&](Edge e) -> bool {
-		if (is_incident_to_boundary(m, e))
-			value<BoundaryCondition>(m, swa.edge_bc_type_, e) = BC_Q;
+	ThreadPool* pool = thread_pool();
+	Connectivity& c = swa.connectivity_;
+
+	std::vector<Edge> edges;
+	foreach_cell(m, [&](Edge e) -> bool {
+		edges.push_back(e);
+		return true;
+	});
+	const uint32 nb_edges = uint32(edges.size());
+	c.edges_.resize(nb_edges);
+	c.edge_left_face_.resize(nb_edges);
+	c.edge_right_face_.resize(nb_edges);
+	pool->parallel_for(0u, nb_edges, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			// the left face is the one the normal of the edge has been computed with
+			uint32 eidx = index_of(m, edges[i]);
+			c.edges_[i] = eidx;
+			c.edge_left_face_[i] = (*swa.edge_left_face_index_)[eidx];
+			c.edge_right_face_[i] = INVALID_INDEX;
+			foreach_incident_face(m, edges[i], [&](Face f) -> bool {
+				uint32 fidx = index_of(m, f);
+				if (fidx != c.edge_left_face_[i])
+					c.edge_right_face_[i] = fidx;
+				return true;
+			});
+		}
+	});
 
-		std::vector<Vertex> vertices = incident_vertices(m, e);
+	std::vector<Face> faces;
+	foreach_cell(m, [&](Face f) -> bool {
+		faces.push_back(f);
+		return true;
+	});
+	const uint32 nb_faces = uint32(faces.size());
+	c.faces_.resize(nb_faces);
+	c.face_edges_offset_.resize(nb_faces + 1);
+	c.face_edges_offset_[0] = 0u;
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			c.faces_[i] = index_of(m, faces[i]);
+			uint32 nb = 0u;
+			foreach_incident_edge(m, faces[i], [&](Edge) -> bool {
+				++nb;
+				return true;
+			});
+			c.face_edges_offset_[i + 1] = nb;
+		}
+	});
+	for (uint32 i = 0u; i < nb_faces; ++i)
+		c.face_edges_offset_[i + 1] += c.face_edges_offset_[i];
+	c.face_edges_.resize(c.face_edges_offset_[nb_faces]);
+	c.face_edges_sign_.resize(c.face_edges_offset_[nb_faces]);
+	c.face_edges_neighbour_.resize(c.face_edges_offset_[nb_faces]);
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint32 k = c.face_edges_offset_[i];
+			foreach_incident_edge(m, faces[i], [&](Edge ie) -> bool {
+				uint32 ieidx = index_of(m, ie);
+				c.face_edges_[k] = ieidx;
+				c.face_edges_sign_[k] = c.faces_[i] == (*swa.edge_left_face_index_)[ieidx] ? Scalar(-1) : Scalar(1);
+				c.face_edges_neighbour_[k] = INVALID_INDEX;
+				foreach_incident_face(m, ie, [&](Face f) -> bool {
+					uint32 fidx = index_of(m, f);
+					if (fidx != c.faces_[i])
+						c.face_edges_neighbour_[k] = fidx;
+					return true;
+				});
+				++k;
+				return true;
+			});
+		}
+	});
+
+	const uint32 nb_slots = c.face_edges_offset_[nb_faces];
+	c.face_edges_twin_.assign(nb_slots, INVALID_INDEX);
+	uint32 max_eidx = 0u;
+	for (uint32 eidx : c.edges_)
+		max_eidx = std::max(max_eidx, eidx);
+	std::vector<uint32> edge_slot(max_eidx + 1, INVALID_INDEX);
+	for (uint32 k = 0u; k < nb_slots; ++k)
+	{
+		uint32& slot = edge_slot[c.face_edges_[k]];
+		if (slot == INVALID_INDEX)
+			slot = k;
+		else
+		{
+			c.face_edges_twin_[k] = slot;
+			c.face_edges_twin_[slot] = k;
+		}
+	}
+}
+
+// length, normal & left face of the edges (the normal points out of the left face)
+template <typename MESH>
+void compute_edge_geometry(const MESH& m, Attributes<MESH>& swa)
+{
+	using Edge = typename mesh_traits<MESH>::Edge;
+
+	parallel_foreach_cell(m, [&](Edge e) -> bool {
+		auto vertices = incident_vertices(m, e);
 		Vec3 vec =
 			value<Vec3>(m, swa.vertex_position_, vertices[1]) - value<Vec3>(m, swa.vertex_position_, vertices[0]);
 		Scalar l = vec.norm();
@@ -152,6 +351,27 @@ void init_attributes(MESH& m, Attributes<MESH>& swa, Context& swc)
 
 		return true;
 	});
+}
+
+template <typename MESH>
+void init_attributes(MESH& m, Attributes<MESH>& swa, Context& swc)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	parallel_foreach_cell(m, [&](Edge e) -> bool {
+		if (is_incident_to_boundary(m, e))
+			value<BoundaryCondition>(m, swa.edge_bc_type_, e) = BC_Q;
+		return true;
+	});
+	compute_edge_geometry(m, swa);
+
+	parallel_foreach_cell(m, [&](Vertex v) -> bool {
+		value<uint32>(m, swa.vertex_level_, v) = 0u;
+		value<uint8>(m, swa.vertex_center_, v) = 0u;
+		return true;
+	});
 
 	srand(time(0));
 	parallel_foreach_cell(m, [&](Face f) -> bool {
@@ -189,9 +409,12 @@ void init_attributes(MESH& m, Attributes<MESH>& swa, Context& swc)
 		value<Scalar>(m, swa.face_h_, f) = h;
 		value<Scalar>(m, swa.face_q_, f) = 0.0;
 		value<Scalar>(m, swa.face_r_, f) = 0.0;
+		value<uint32>(m, swa.face_level_, f) = 0u;
 
 		return true;
 	});
+
+	build_connectivity(m, swa);
 }
 
 template <typename MESH>
@@ -202,7 +425,7 @@ void domain_geometry_changed(MESH& m, Attributes<MESH>& swa, Context& swc)
 	using Face = typename mesh_traits<MESH>::Face;
 
 	parallel_foreach_cell(m, [&](Edge e) -> bool {
-		std::vector<Vertex> vertices = incident_vertices(m, e);
+		auto vertices = incident_vertices(m, e);
 		Vec3 vec =
 			value<Vec3>(m, swa.vertex_position_, vertices[1]) - value<Vec3>(m, swa.vertex_position_, vertices[0]);
 		Scalar l = vec.norm();
@@ -243,242 +466,921 @@ void domain_geometry_changed(MESH& m, Attributes<MESH>& swa, Context& swc)
 }
 
 template <typename MESH>
-void update_time_step(MESH& m, Attributes<MESH>& swa, Context& swc)
+void update_time_step(MESH&, Attributes<MESH>& swa, Context& swc)
 {
-	using Edge = typename mesh_traits<MESH>::Edge;
-	using Face = typename mesh_traits<MESH>::Face;
-
-	swa.face_discharge_->fill(0.);
-	swa.face_swept_->fill(0.);
+	const Connectivity& c = swa.connectivity_;
+	ThreadPool* pool = thread_pool();
+	const uint32 nb_faces = c.nb_faces();
 
-	parallel_foreach_cell(m, [&](Face f) -> bool {
-		uint32 fidx = index_of(m, f);
-		foreach_incident_edge(m, f, [&](Edge ie) -> bool {
-			uint32 ieidx = index_of(m, ie);
-			Scalar le = (*swa.edge_length_)[ieidx];
-			Scalar f1e = (*swa.edge_f1_)[ieidx];
-			Scalar lambda = 0.;
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint32 fidx = c.faces_[i];
 			Scalar h = (*swa.face_h_)[fidx];
-			if (h > swc.hmin_)
-				lambda = fabs((*swa.face_q_)[fidx] * (*swa.edge_normX_)[ieidx] +
-							  (*swa.face_r_)[fidx] * (*swa.edge_normY_)[ieidx]) /
-							 std::max(h, swc.hmin_) +
-						 sqrt(9.81 * h);
-			(*swa.face_swept_)[fidx] += le * lambda;
-			if (fidx == (*swa.edge_left_face_index_)[ieidx])
-				(*swa.face_discharge_)[fidx] -= le * f1e;
-			else
-				(*swa.face_discharge_)[fidx] += le * f1e;
-			return true;
-		});
-		return true;
+			Scalar swept = 0.;
+			Scalar discharge = 0.;
+			for (uint32 k = c.face_edges_offset_[i], end = c.face_edges_offset_[i + 1]; k < end; ++k)
+			{
+				uint32 ieidx = c.face_edges_[k];
+				Scalar le = (*swa.edge_length_)[ieidx];
+				Scalar f1e = (*swa.edge_f1_)[ieidx];
+				Scalar lambda = 0.;
+				if (h > swc.hmin_)
+					lambda = fabs((*swa.face_q_)[fidx] * (*swa.edge_normX_)[ieidx] +
+								  (*swa.face_r_)[fidx] * (*swa.edge_normY_)[ieidx]) /
+								 std::max(h, swc.hmin_) +
+							 sqrt(9.81 * h);
+				swept += le * lambda;
+				discharge += c.face_edges_sign_[k] * (le * f1e);
+			}
+			(*swa.face_swept_)[fidx] = swept;
+			(*swa.face_discharge_)[fidx] = discharge;
+		}
 	});
 
-	std::vector<Scalar> min_dt_per_thread(thread_pool()->nb_workers());
-	// for (Scalar& d : min_dt_per_thread) d = std::min(swc.dt_max_, swc.t_max_ - swc.t_); // Timestep for ending
-	// simulation
-	for (Scalar& d : min_dt_per_thread)
-		d = swc.dt_max_;
+	// the minimum is reduced per block of faces (independently of the scheduling)
+	const uint32 nb_blocks = (nb_faces + PARALLEL_BUFFER_SIZE - 1) / PARALLEL_BUFFER_SIZE;
+	// std::min(swc.dt_max_, swc.t_max_ - swc.t_); // Timestep for ending simulation
+	std::vector<Scalar> min_dt_per_block(nb_blocks, swc.dt_max_);
 
-	parallel_foreach_cell(m, [&](Face f) -> bool {
-		uint32 fidx = index_of(m, f);
-		uint32 threadidx = current_worker_index();
-		// Ensure CFL condition
-		Scalar cfl = (*swa.face_area_)[fidx] / std::max((*swa.face_swept_)[fidx], swc.small_);
-		min_dt_per_thread[threadidx] = std::min(min_dt_per_thread[threadidx], cfl);
-		// Ensure overdry condition
-		if ((*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx] * ((*swa.face_h_)[fidx] + (*swa.face_zb_)[fidx]) <
-			(-(*swa.face_discharge_)[fidx] * min_dt_per_thread[threadidx]))
-			min_dt_per_thread[threadidx] = -(*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx] *
-										   ((*swa.face_h_)[fidx] + (*swa.face_zb_)[fidx]) /
-										   (*swa.face_discharge_)[fidx];
-		return true;
+	pool->parallel_for(0u, nb_blocks, 1u, [&](uint32 bb, uint32 be) {
+		for (uint32 block = bb; block < be; ++block)
+		{
+			Scalar& min_dt = min_dt_per_block[block];
+			for (uint32 i = block * PARALLEL_BUFFER_SIZE, end = std::min(nb_faces, i + PARALLEL_BUFFER_SIZE); i < end;
+				 ++i)
+			{
+				uint32 fidx = c.faces_[i];
+				// Ensure CFL condition
+				Scalar cfl = (*swa.face_area_)[fidx] / std::max((*swa.face_swept_)[fidx], swc.small_);
+				min_dt = std::min(min_dt, cfl);
+				// Ensure overdry condition
+				if ((*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx] * ((*swa.face_h_)[fidx] + (*swa.face_zb_)[fidx]) <
+					(-(*swa.face_discharge_)[fidx] * min_dt))
+					min_dt = -(*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx] *
+							 ((*swa.face_h_)[fidx] + (*swa.face_zb_)[fidx]) / (*swa.face_discharge_)[fidx];
+			}
+		}
 	});
 
-	swc.dt_ = *(std::min_element(min_dt_per_thread.begin(), min_dt_per_thread.end()));
+	swc.dt_ = swc.dt_max_;
+	for (Scalar d : min_dt_per_block)
+		swc.dt_ = std::min(swc.dt_, d);
 }
 
 template <typename MESH>
-void execute_time_step(MESH& m, Attributes<MESH>& swa, Context& swc)
+void correct_face_state(Attributes<MESH>& swa, const Context& swc, uint32 fidx)
 {
-	using Edge = typename mesh_traits<MESH>::Edge;
-	using Face = typename mesh_traits<MESH>::Face;
+	// friction
+	if (swc.friction_ != 0)
+	{
+		Scalar qx = (*swa.face_q_)[fidx] * cos(swc.alphaK_) + (*swa.face_r_)[fidx] * sin(swc.alphaK_);
+		Scalar qy = -(*swa.face_q_)[fidx] * sin(swc.alphaK_) + (*swa.face_r_)[fidx] * cos(swc.alphaK_);
+		if ((*swa.face_h_)[fidx] > swc.hmin_)
+		{
+			qx = qx * exp(-(9.81 * sqrt(qx * qx + qy * qy) /
+							(std::max(swc.kx_ * swc.kx_, swc.small_ * swc.small_) *
+							 pow((*swa.face_h_)[fidx], 7. / 3.))) *
+						  swc.dt_);
+			qy = qy * exp(-(9.81 * sqrt(qx * qx + qy * qy) /
+							(std::max(swc.ky_ * swc.ky_, swc.small_ * swc.small_) *
+							 pow((*swa.face_h_)[fidx], 7. / 3.))) *
+						  swc.dt_);
+		}
+		else
+		{
+			qx = 0.;
+			qy = 0.;
+		}
+		(*swa.face_q_)[fidx] = qx * cos(swc.alphaK_) - qy * sin(swc.alphaK_);
+		(*swa.face_r_)[fidx] = qx * sin(swc.alphaK_) + qy * cos(swc.alphaK_);
+	}
+
+	// optional correction
+	// Negative water depth
+	if ((*swa.face_h_)[fidx] < 0.)
+	{
+		(*swa.face_h_)[fidx] = 0.;
+		// (*swa.face_h_)[fidx] = swc.hmin_;
+		(*swa.face_q_)[fidx] = 0.;
+		(*swa.face_r_)[fidx] = 0.;
+	}
+
+	// Abnormal large velocity => Correction of q and r to respect Vmax and Frmax
+	if ((*swa.face_h_)[fidx] > swc.hmin_)
+	{
+		Scalar v =
+			sqrt((*swa.face_q_)[fidx] * (*swa.face_q_)[fidx] + (*swa.face_r_)[fidx] * (*swa.face_r_)[fidx]) /
+			std::max((*swa.face_h_)[fidx], swc.small_);
+		Scalar c = sqrt(9.81 * std::max((*swa.face_h_)[fidx], swc.small_));
+		Scalar Fr = v / c;
+		Scalar Fact = std::max({1.0, v / swc.v_max_, Fr / swc.Fr_max_});
+		(*swa.face_q_)[fidx] /= Fact;
+		(*swa.face_r_)[fidx] /= Fact;
+	}
+	else // Quasi-zero
+	{
+		(*swa.face_q_)[fidx] = 0.;
+		(*swa.face_r_)[fidx] = 0.;
+	}
+}
 
-	auto start = std::chrono::high_resolution_clock::now();
+// states of the edges gathered for the batched Riemann solvers (structures of arrays)
+struct EdgeStates
+{
+	Scalar *zbL, *zbR, *phiL, *phiR, *hL, *qL, *rL, *hR, *qR, *rR;
+	BoundaryCondition* bc_type;
+	Scalar *bc_value, *normX, *normY, *q, *r, *z, *zb;
+	uint32 nb_inner;
+	uint32 nb_border;
+
+	inline Str_Riemann_States inner_states() const
+	{
+		return Str_Riemann_States{zbL, zbR, phiL, phiR, hL, qL, rL, hR, qR, rR};
+	}
+	inline Str_Border_States border_states() const
+	{
+		return Str_Border_States{bc_type, bc_value, normX, normY, q, r, z, zb};
+	}
+};
 
-	parallel_foreach_cell(m, [&](Edge e) -> bool {
-		uint32 eidx = index_of(m, e);
+// flag of the border slots returned by gather_edge_state
+const uint32 BORDER_STATE = 1u << 31;
 
-		// solve flux on edge
-		Str_Riemann_Flux riemann_flux;
+/**
+ * @brief append the state of the given edge to the states to solve
+ * @param f1idx left face of the edge (the one its normal points out of)
+ * @param f2idx right face of the edge, INVALID_INDEX for the border edges
+ * @return the slot of the edge in the inner states, or in the border states (flagged with BORDER_STATE), or
+ * INVALID_INDEX if there is no flux through the edge
+ */
+template <typename MESH>
+inline uint32 gather_edge_state(const Attributes<MESH>& swa, const Context& swc, uint32 eidx, uint32 f1idx,
+								uint32 f2idx, EdgeStates& states)
+{
+	if (f2idx == INVALID_INDEX) // border conditions
+	{
+		if (!((*swa.face_phi_)[f1idx] > swc.small_))
+			return INVALID_INDEX;
+		uint32 k = states.nb_border++;
+		states.bc_type[k] = (*swa.edge_bc_type_)[eidx];
+		states.bc_value[k] = (*swa.edge_bc_value_)[eidx];
+		states.normX[k] = (*swa.edge_normX_)[eidx];
+		states.normY[k] = (*swa.edge_normY_)[eidx];
+		states.q[k] = (*swa.face_q_)[f1idx];
+		states.r[k] = (*swa.face_r_)[f1idx];
+		states.z[k] = (*swa.face_h_)[f1idx] + (*swa.face_zb_)[f1idx];
+		states.zb[k] = (*swa.face_zb_)[f1idx];
+		return BORDER_STATE | k;
+	}
+
+	if (!((*swa.face_h_)[f1idx] > swc.hmin_ || (*swa.face_h_)[f2idx] > swc.hmin_))
+		return INVALID_INDEX;
+
+	// Inner cell: use the lateralised Riemann solver
+	uint32 k = states.nb_inner++;
+	states.zbL[k] = (*swa.face_zb_)[f1idx];
+	states.zbR[k] = (*swa.face_zb_)[f2idx];
+	states.phiL[k] = (*swa.face_phi_)[f1idx];
+	states.phiR[k] = (*swa.face_phi_)[f2idx];
+	states.hL[k] = (*swa.face_h_)[f1idx];
+	states.hR[k] = (*swa.face_h_)[f2idx];
+	states.qL[k] = (*swa.face_q_)[f1idx] * (*swa.edge_normX_)[eidx] + (*swa.face_r_)[f1idx] * (*swa.edge_normY_)[eidx];
+	states.qR[k] = (*swa.face_q_)[f2idx] * (*swa.edge_normX_)[eidx] + (*swa.face_r_)[f2idx] * (*swa.edge_normY_)[eidx];
+	states.rL[k] = -(*swa.face_q_)[f1idx] * (*swa.edge_normY_)[eidx] + (*swa.face_r_)[f1idx] * (*swa.edge_normX_)[eidx];
+	states.rR[k] = -(*swa.face_q_)[f2idx] * (*swa.edge_normY_)[eidx] + (*swa.face_r_)[f2idx] * (*swa.edge_normX_)[eidx];
+	return k;
+}
 
-		if (is_incident_to_boundary(m, e)) // border conditions
-		{
-			uint32 fidx = (*swa.edge_left_face_index_)[eidx];
-			if ((*swa.face_phi_)[fidx] > swc.small_)
-				riemann_flux = border_condition(
-					(*swa.edge_bc_type_)[eidx], (*swa.edge_bc_value_)[eidx], (*swa.edge_normX_)[eidx],
-					(*swa.edge_normY_)[eidx], (*swa.face_q_)[fidx], (*swa.face_r_)[fidx],
-					(*swa.face_h_)[fidx] + (*swa.face_zb_)[fidx], (*swa.face_zb_)[fidx], 9.81, swc.hmin_, swc.small_);
-		}
-		else // Inner cell: use the lateralised Riemann solver
+template <typename MESH, typename FUNC>
+void execute_kernels(MESH& m, Attributes<MESH>& swa, Context& swc, const FUNC& end_kernel)
+{
+	const Connectivity& c = swa.connectivity_;
+	ThreadPool* pool = thread_pool();
+
+	pool->parallel_for(0u, c.nb_edges(), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		// the states of the edges are gathered in batches for the batched Riemann solvers
+		constexpr uint32 BATCH_SIZE = 256u;
+		uint32 inner[BATCH_SIZE], border[BATCH_SIZE];
+		Scalar zbL[BATCH_SIZE], zbR[BATCH_SIZE], phiL[BATCH_SIZE], phiR[BATCH_SIZE];
+		Scalar hL[BATCH_SIZE], qL[BATCH_SIZE], rL[BATCH_SIZE], hR[BATCH_SIZE], qR[BATCH_SIZE], rR[BATCH_SIZE];
+		BoundaryCondition bc_type[BATCH_SIZE];
+		Scalar bc_value[BATCH_SIZE], normX[BATCH_SIZE], normY[BATCH_SIZE];
+		Scalar q[BATCH_SIZE], r[BATCH_SIZE], z[BATCH_SIZE], zb[BATCH_SIZE];
+		Scalar F1[BATCH_SIZE], F2[BATCH_SIZE], F3[BATCH_SIZE], s2L[BATCH_SIZE], s2R[BATCH_SIZE];
+		const Str_Riemann_Fluxes fluxes{F1, F2, F3, s2L, s2R};
+
+		auto write_fluxes = [&](const uint32* edges, uint32 n) {
+			for (uint32 k = 0u; k < n; ++k)
+			{
+				uint32 eidx = c.edges_[edges[k]];
+				(*swa.edge_f1_)[eidx] = F1[k];
+				(*swa.edge_f2_)[eidx] = F2[k];
+				(*swa.edge_f3_)[eidx] = F3[k];
+				(*swa.edge_s2L_)[eidx] = s2L[k];
+				(*swa.edge_s2R_)[eidx] = s2R[k];
+			}
+		};
+
+		for (uint32 bb = b; bb < e; bb += BATCH_SIZE)
 		{
-			std::vector<Face> faces = incident_faces(m, e);
-			uint32 f1idx = index_of(m, faces[0]);
-			uint32 f2idx = index_of(m, faces[1]);
-
-			Scalar phiL = (*swa.face_phi_)[f1idx];
-			Scalar phiR = (*swa.face_phi_)[f2idx];
-			Scalar zbL = (*swa.face_zb_)[f1idx];
-			Scalar zbR = (*swa.face_zb_)[f2idx];
-			if ((*swa.face_h_)[f1idx] > swc.hmin_ || (*swa.face_h_)[f2idx] > swc.hmin_)
+			uint32 be = std::min(e, bb + BATCH_SIZE);
+			EdgeStates states{zbL,	 zbR, phiL, phiR, hL, qL, rL, hR, qR, rR, bc_type, bc_value, normX,
+							  normY, q,	  r,	z,	  zb, 0u, 0u};
+
+			for (uint32 i = bb; i < be; ++i)
 			{
-				Scalar hL = (*swa.face_h_)[f1idx];
-				Scalar hR = (*swa.face_h_)[f2idx];
-				Scalar qL =
-					(*swa.face_q_)[f1idx] * (*swa.edge_normX_)[eidx] + (*swa.face_r_)[f1idx] * (*swa.edge_normY_)[eidx];
-				Scalar qR =
-					(*swa.face_q_)[f2idx] * (*swa.edge_normX_)[eidx] + (*swa.face_r_)[f2idx] * (*swa.edge_normY_)[eidx];
-				Scalar rL = -(*swa.face_q_)[f1idx] * (*swa.edge_normY_)[eidx] +
-							(*swa.face_r_)[f1idx] * (*swa.edge_normX_)[eidx];
-				Scalar rR = -(*swa.face_q_)[f2idx] * (*swa.edge_normY_)[eidx] +
-							(*swa.face_r_)[f2idx] * (*swa.edge_normX_)[eidx];
-
-				riemann_flux = Solv_HLLC(9.81, swc.hmin_, swc.small_, zbL, zbR, phiL, phiR, hL, qL, rL, hR, qR, rR);
+				uint32 slot =
+					gather_edge_state(swa, swc, c.edges_[i], c.edge_left_face_[i], c.edge_right_face_[i], states);
+				if (slot == INVALID_INDEX)
+				{
+					// no flux through the edge
+					uint32 eidx = c.edges_[i];
+					(*swa.edge_f1_)[eidx] = 0.;
+					(*swa.edge_f2_)[eidx] = 0.;
+					(*swa.edge_f3_)[eidx] = 0.;
+					(*swa.edge_s2L_)[eidx] = 0.;
+					(*swa.edge_s2R_)[eidx] = 0.;
+				}
+				else if (slot & BORDER_STATE)
+					border[slot & ~BORDER_STATE] = i;
+				else
+					inner[slot] = i;
 			}
-		}
 
-		(*swa.edge_f1_)[eidx] = riemann_flux.F1;
-		(*swa.edge_f2_)[eidx] = riemann_flux.F2;
-		(*swa.edge_f3_)[eidx] = riemann_flux.F3;
-		(*swa.edge_s2L_)[eidx] = riemann_flux.s2L;
-		(*swa.edge_s2R_)[eidx] = riemann_flux.s2R;
+			Solv_HLLC(9.81, swc.hmin_, swc.small_, states.nb_inner, states.inner_states(), fluxes);
+			write_fluxes(inner, states.nb_inner);
 
-		return true;
+			border_condition(states.nb_border, states.border_states(), 9.81, swc.hmin_, swc.small_, fluxes);
+			write_fluxes(border, states.nb_border);
+		}
 	});
 
-	update_time_step(m, swa, swc);
+	end_kernel("fluxes");
 
-	// simu_data_access_.lock();
+	update_time_step(m, swa, swc);
+	end_kernel("time step");
 
-	parallel_foreach_cell(m, [&](Face f) -> bool {
-		uint32 fidx = index_of(m, f);
+	pool->parallel_for(0u, c.nb_faces(), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint32 fidx = c.faces_[i];
+			Scalar h = (*swa.face_h_)[fidx];
+			Scalar q = (*swa.face_q_)[fidx];
+			Scalar r = (*swa.face_r_)[fidx];
 
-		foreach_incident_edge(m, f, [&](Edge ie) -> bool {
-			uint32 ieidx = index_of(m, ie);
-			Scalar fact = swc.dt_ * (*swa.edge_length_)[ieidx];
-			Scalar factF = 0.;
-			if ((*swa.face_phi_)[fidx] > swc.small_)
-				factF = fact / (*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx];
-			if (fidx == (*swa.edge_left_face_index_)[ieidx])
-			{
-				(*swa.face_h_)[fidx] -= factF * (*swa.edge_f1_)[ieidx];
-				(*swa.face_q_)[fidx] -=
-					factF * (((*swa.edge_f2_)[ieidx] + (*swa.edge_s2L_)[ieidx]) * (*swa.edge_normX_)[ieidx] -
-							 (*swa.edge_f3_)[ieidx] * (*swa.edge_normY_)[ieidx]);
-				(*swa.face_r_)[fidx] -=
-					factF * ((*swa.edge_f3_)[ieidx] * (*swa.edge_normX_)[ieidx] +
-							 ((*swa.edge_f2_)[ieidx] + (*swa.edge_s2L_)[ieidx]) * (*swa.edge_normY_)[ieidx]);
-			}
-			else
+			for (uint32 k = c.face_edges_offset_[i], end = c.face_edges_offset_[i + 1]; k < end; ++k)
 			{
-				(*swa.face_h_)[fidx] += factF * (*swa.edge_f1_)[ieidx];
-				(*swa.face_q_)[fidx] +=
-					factF * (((*swa.edge_f2_)[ieidx] + (*swa.edge_s2R_)[ieidx]) * (*swa.edge_normX_)[ieidx] -
-							 (*swa.edge_f3_)[ieidx] * (*swa.edge_normY_)[ieidx]);
-				(*swa.face_r_)[fidx] +=
-					factF * ((*swa.edge_f3_)[ieidx] * (*swa.edge_normX_)[ieidx] +
-							 ((*swa.edge_f2_)[ieidx] + (*swa.edge_s2R_)[ieidx]) * (*swa.edge_normY_)[ieidx]);
+				uint32 ieidx = c.face_edges_[k];
+				Scalar fact = swc.dt_ * (*swa.edge_length_)[ieidx];
+				Scalar factF = 0.;
+				if ((*swa.face_phi_)[fidx] > swc.small_)
+					factF = fact / (*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx];
+				// the flux leaves the left face & enters the right face
+				const Scalar sign = c.face_edges_sign_[k];
+				factF *= sign;
+				Scalar s2 = sign < 0 ? (*swa.edge_s2L_)[ieidx] : (*swa.edge_s2R_)[ieidx];
+				h += factF * (*swa.edge_f1_)[ieidx];
+				q += factF * (((*swa.edge_f2_)[ieidx] + s2) * (*swa.edge_normX_)[ieidx] -
+							  (*swa.edge_f3_)[ieidx] * (*swa.edge_normY_)[ieidx]);
+				r += factF * ((*swa.edge_f3_)[ieidx] * (*swa.edge_normX_)[ieidx] +
+							  ((*swa.edge_f2_)[ieidx] + s2) * (*swa.edge_normY_)[ieidx]);
 			}
-			return true;
-		});
-		return true;
+
+			(*swa.face_h_)[fidx] = h;
+			(*swa.face_q_)[fidx] = q;
+			(*swa.face_r_)[fidx] = r;
+		}
 	});
+	end_kernel("face update");
 
-	parallel_foreach_cell(m, [&](Face f) -> bool {
-		uint32 fidx = index_of(m, f);
+	pool->parallel_for(0u, c.nb_faces(), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+			correct_face_state(swa, swc, c.faces_[i]);
+	});
+	end_kernel("corrections");
+}
+
+// number of blocks of PARALLEL_BUFFER_SIZE faces whose fluxes are computed together in the fused kernels
+const uint32 FUSED_NB_BLOCKS = 4u;
 
-		// friction
-		if (swc.friction_ != 0)
+template <typename MESH, typename FUNC>
+void execute_fused_kernels(Attributes<MESH>& swa, Context& swc, const FUNC& end_kernel)
+{
+	const Connectivity& c = swa.connectivity_;
+	ThreadPool* pool = thread_pool();
+	const uint32 nb_faces = c.nb_faces();
+
+	swa.face_balance_h_.resize(nb_faces);
+	swa.face_balance_q_.resize(nb_faces);
+	swa.face_balance_r_.resize(nb_faces);
+
+	// the minimum is reduced on the same blocks of faces as in update_time_step: the time step is the same as in the
+	// default mode
+	const uint32 nb_blocks = (nb_faces + PARALLEL_BUFFER_SIZE - 1) / PARALLEL_BUFFER_SIZE;
+	std::vector<Scalar> min_dt_per_block(nb_blocks, swc.dt_max_);
+
+	// the fluxes are computed on larger blocks of faces: an inner edge is solved twice only when its faces are in
+	// different blocks
+	const uint32 nb_flux_blocks = (nb_blocks + FUSED_NB_BLOCKS - 1) / FUSED_NB_BLOCKS;
+
+	pool->parallel_for(0u, nb_flux_blocks, 1u, [&](uint32 bb, uint32 be) {
+		// the states of the edges of a block of faces are gathered for the batched Riemann solvers
+		// (slot_flux: slot of the flux of each edge of the faces, as returned by gather_edge_state)
+		std::vector<uint32> slot_flux;
+		std::vector<Scalar> buffer;
+		std::vector<BoundaryCondition> bc_type;
+
+		for (uint32 block = bb; block < be; ++block)
 		{
-			Scalar qx = (*swa.face_q_)[fidx] * cos(swc.alphaK_) + (*swa.face_r_)[fidx] * sin(swc.alphaK_);
-			Scalar qy = -(*swa.face_q_)[fidx] * sin(swc.alphaK_) + (*swa.face_r_)[fidx] * cos(swc.alphaK_);
-			if ((*swa.face_h_)[fidx] > swc.hmin_)
+			const uint32 fb = block * FUSED_NB_BLOCKS * PARALLEL_BUFFER_SIZE;
+			const uint32 fe = std::min(nb_faces, fb + FUSED_NB_BLOCKS * PARALLEL_BUFFER_SIZE);
+			const uint32 sb = c.face_edges_offset_[fb];
+			const uint32 n = c.face_edges_offset_[fe] - sb;
+
+			slot_flux.resize(n);
+			bc_type.resize(n);
+			buffer.resize(27u * n);
+			// 17 arrays of states followed by 2 * 5 arrays of fluxes
+			Scalar* a = buffer.data();
+			EdgeStates states{a,		  a + n,	  a + 2 * n,  a + 3 * n,  a + 4 * n,  a + 5 * n,	  a + 6 * n,
+							  a + 7 * n,  a + 8 * n,  a + 9 * n,  bc_type.data(), a + 10 * n, a + 11 * n, a + 12 * n,
+							  a + 13 * n, a + 14 * n, a + 15 * n, a + 16 * n, 0u,		  0u};
+			const Str_Riemann_Fluxes inner_fluxes{a + 17 * n, a + 18 * n, a + 19 * n, a + 20 * n, a + 21 * n};
+			const Str_Riemann_Fluxes border_fluxes{a + 22 * n, a + 23 * n, a + 24 * n, a + 25 * n, a + 26 * n};
+
+			for (uint32 i = fb; i < fe; ++i)
 			{
-				qx =
-					qx *
-					exp(-(9.81 * sqrt(qx * qx + qy * qy) /
-						  (std::max(swc.kx_ * swc.kx_, swc.small_ * swc.small_) * pow((*swa.face_h_)[fidx], 7. / 3.))) *
-						swc.dt_);
-				qy =
-					qy *
-					exp(-(9.81 * sqrt(qx * qx + qy * qy) /
-						  (std::max(swc.ky_ * swc.ky_, swc.small_ * swc.small_) * pow((*swa.face_h_)[fidx], 7. / 3.))) *
-						swc.dt_);
+				uint32 fidx = c.faces_[i];
+				for (uint32 k = c.face_edges_offset_[i], end = c.face_edges_offset_[i + 1]; k < end; ++k)
+				{
+					uint32 nidx = c.face_edges_neighbour_[k];
+					uint32 twin = c.face_edges_twin_[k];
+					if (nidx != INVALID_INDEX && twin >= sb && twin < k)
+					{
+						// already computed for the neighbour face in this block
+						slot_flux[k - sb] = slot_flux[twin - sb];
+					}
+					else
+					{
+						// the left face of the edge is on the left of the Riemann problem
+						bool left = nidx == INVALID_INDEX || c.face_edges_sign_[k] < 0;
+						slot_flux[k - sb] = gather_edge_state(swa, swc, c.face_edges_[k], left ? fidx : nidx,
+															  left ? nidx : fidx, states);
+					}
+				}
 			}
-			else
+
+			Solv_HLLC(9.81, swc.hmin_, swc.small_, states.nb_inner, states.inner_states(), inner_fluxes);
+			border_condition(states.nb_border, states.border_states(), 9.81, swc.hmin_, swc.small_, border_fluxes);
+
+			for (uint32 i = fb; i < fe; ++i)
 			{
-				qx = 0.;
-				qy = 0.;
+				Scalar& min_dt = min_dt_per_block[i / PARALLEL_BUFFER_SIZE];
+				uint32 fidx = c.faces_[i];
+				Scalar h = (*swa.face_h_)[fidx];
+				Scalar swept = 0.;
+				Scalar discharge = 0.;
+				Scalar balance_q = 0.;
+				Scalar balance_r = 0.;
+				for (uint32 k = c.face_edges_offset_[i], end = c.face_edges_offset_[i + 1]; k < end; ++k)
+				{
+					uint32 ieidx = c.face_edges_[k];
+					Scalar le = (*swa.edge_length_)[ieidx];
+					Scalar nx = (*swa.edge_normX_)[ieidx];
+					Scalar ny = (*swa.edge_normY_)[ieidx];
+					const Scalar sign = c.face_edges_sign_[k];
+
+					Scalar lambda = 0.;
+					if (h > swc.hmin_)
+						lambda = fabs((*swa.face_q_)[fidx] * nx + (*swa.face_r_)[fidx] * ny) / std::max(h, swc.hmin_) +
+								 sqrt(9.81 * h);
+					swept += le * lambda;
+
+					uint32 flux = slot_flux[k - sb];
+					if (flux == INVALID_INDEX)
+						continue;
+					const Str_Riemann_Fluxes& fluxes = (flux & BORDER_STATE) ? border_fluxes : inner_fluxes;
+					flux &= ~BORDER_STATE;
+					Scalar f1 = fluxes.F1[flux];
+					Scalar f2 = fluxes.F2[flux] + (sign < 0 ? fluxes.s2L[flux] : fluxes.s2R[flux]);
+					Scalar f3 = fluxes.F3[flux];
+					// the flux leaves the left face & enters the right face
+					discharge += sign * (le * f1);
+					balance_q += sign * (le * (f2 * nx - f3 * ny));
+					balance_r += sign * (le * (f3 * nx + f2 * ny));
+				}
+				swa.face_balance_h_[i] = discharge;
+				swa.face_balance_q_[i] = balance_q;
+				swa.face_balance_r_[i] = balance_r;
+
+				// Ensure CFL condition
+				Scalar cfl = (*swa.face_area_)[fidx] / std::max(swept, swc.small_);
+				min_dt = std::min(min_dt, cfl);
+				// Ensure overdry condition
+				if ((*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx] * (h + (*swa.face_zb_)[fidx]) <
+					(-discharge * min_dt))
+					min_dt = -(*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx] * (h + (*swa.face_zb_)[fidx]) / discharge;
 			}
-			(*swa.face_q_)[fidx] = qx * cos(swc.alphaK_) - qy * sin(swc.alphaK_);
-			(*swa.face_r_)[fidx] = qx * sin(swc.alphaK_) + qy * cos(swc.alphaK_);
 		}
+	});
 
-		// optional correction
-		// Negative water depth
-		if ((*swa.face_h_)[fidx] < 0.)
-		{
-			(*swa.face_h_)[fidx] = 0.;
-			// (*swa.face_h_)[fidx] = swc.hmin_;
-			(*swa.face_q_)[fidx] = 0.;
-			(*swa.face_r_)[fidx] = 0.;
-		}
+	swc.dt_ = swc.dt_max_;
+	for (Scalar d : min_dt_per_block)
+		swc.dt_ = std::min(swc.dt_, d);
+	end_kernel("fluxes & time step");
 
-		// Abnormal large velocity => Correction of q and r to respect Vmax and Frmax
-		if ((*swa.face_h_)[fidx] > swc.hmin_)
+	pool->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
 		{
-			Scalar v = sqrt((*swa.face_q_)[fidx] * (*swa.face_q_)[fidx] + (*swa.face_r_)[fidx] * (*swa.face_r_)[fidx]) /
-					   std::max((*swa.face_h_)[fidx], swc.small_);
-			Scalar c = sqrt(9.81 * std::max((*swa.face_h_)[fidx], swc.small_));
-			Scalar Fr = v / c;
-			Scalar Fact = std::max({1.0, v / swc.v_max_, Fr / swc.Fr_max_});
-			(*swa.face_q_)[fidx] /= Fact;
-			(*swa.face_r_)[fidx] /= Fact;
+			uint32 fidx = c.faces_[i];
+			if ((*swa.face_phi_)[fidx] > swc.small_)
+			{
+				Scalar fact = swc.dt_ / (*swa.face_area_)[fidx] * (*swa.face_phi_)[fidx];
+				(*swa.face_h_)[fidx] += fact * swa.face_balance_h_[i];
+				(*swa.face_q_)[fidx] += fact * swa.face_balance_q_[i];
+				(*swa.face_r_)[fidx] += fact * swa.face_balance_r_[i];
+			}
+			correct_face_state(swa, swc, fidx);
 		}
-		else // Quasi-zero
+	});
+	end_kernel("face update & corrections");
+}
+
+/**
+ * Adaptive mesh
+ * A face of level l is subdivided into quads by linking a new center vertex to the midpoints of its edges. The corners
+ * of the face are its vertices of level <= l; the midpoints of level l + 1 are created, unless they already exist as
+ * hanging vertices left by the subdivision of a neighbour. The levels of two adjacent faces differ by at most one so
+ * that each edge of a face has at most one hanging vertex: the solver handles them as the vertices of polygonal faces.
+ * The children of a subdivided face are merged back by removing their center & the midpoints that are not used by
+ * the neighbours anymore.
+ */
+
+// centroid & area of a face created by an adaptation
+template <typename MESH>
+void compute_face_geometry(const MESH& m, Attributes<MESH>& swa, typename mesh_traits<MESH>::Face f)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+
+	uint32 nbv = 0;
+	Vec3 centroid{0, 0, 0};
+	foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
+		centroid += value<Vec3>(m, swa.vertex_position_, v);
+		nbv++;
+		return true;
+	});
+	value<Vec3>(m, swa.face_centroid_, f) = centroid / nbv;
+	value<Scalar>(m, swa.face_area_, f) = geometry::area(m, f, swa.vertex_position_.get());
+}
+
+/**
+ * @brief subdivide the given face: the children get the state of the face, scaled so that the water volume & the
+ * momentum are conserved
+ * @return false if the face cannot be subdivided (a neighbour is coarser than the face)
+ */
+template <typename MESH>
+bool refine_face(MESH& m, Attributes<MESH>& swa, typename mesh_traits<MESH>::Face f)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	const uint32 level = value<uint32>(m, swa.face_level_, f);
+	auto is_corner = [&](Dart d) -> bool { return value<uint32>(m, swa.vertex_level_, Vertex(d)) <= level; };
+
+	// the darts of the face that start at a corner, in order
+	std::vector<Dart> corners;
+	bool balanced = true;
+	foreach_dart_of_orbit(m, f, [&](Dart d) -> bool {
+		Dart d2 = phi2(m, d);
+		if (!is_boundary(m, d2) && value<uint32>(m, swa.face_level_, Face(d2)) < level)
+			balanced = false;
+		if (is_corner(d))
+			corners.push_back(d);
+		return balanced;
+	});
+	if (!balanced || corners.size() < 3)
+		return false;
+
+	// edges between two corners without midpoint
+	std::vector<Dart> to_cut;
+	for (uint32 i = 0, nb = uint32(corners.size()); i < nb; ++i)
+	{
+		Dart next_corner = corners[(i + 1) % nb];
+		Dart d = phi1(m, corners[i]);
+		if (d == next_corner)
+			to_cut.push_back(corners[i]);
+		else if (phi1(m, d) != next_corner)
+			return false;
+	}
+
+	const Scalar h = value<Scalar>(m, swa.face_h_, f);
+	const Scalar q = value<Scalar>(m, swa.face_q_, f);
+	const Scalar r = value<Scalar>(m, swa.face_r_, f);
+	const Scalar zb = value<Scalar>(m, swa.face_zb_, f);
+	const Scalar porosity = value<Scalar>(m, swa.face_phi_, f);
+	const Scalar area = value<Scalar>(m, swa.face_area_, f);
+
+	Vec3 center_position{0, 0, 0};
+	for (Dart d : corners)
+		center_position += value<Vec3>(m, swa.vertex_position_, Vertex(d));
+	center_position /= Scalar(corners.size());
+
+	for (Dart d : to_cut)
+	{
+		Vec3 p = (value<Vec3>(m, swa.vertex_position_, Vertex(d)) +
+				  value<Vec3>(m, swa.vertex_position_, Vertex(phi1(m, d)))) /
+				 2.0;
+		Vertex mv = cut_edge(m, Edge(d));
+		value<Vec3>(m, swa.vertex_position_, mv) = p;
+		value<uint32>(m, swa.vertex_level_, mv) = level + 1;
+		value<uint8>(m, swa.vertex_center_, mv) = 0u;
+		// both halves of a boundary edge keep its boundary condition
+		value<BoundaryCondition>(m, swa.edge_bc_type_, Edge(phi1(m, d))) =
+			value<BoundaryCondition>(m, swa.edge_bc_type_, Edge(d));
+		value<Scalar>(m, swa.edge_bc_value_, Edge(phi1(m, d))) = value<Scalar>(m, swa.edge_bc_value_, Edge(d));
+	}
+
+	// the face now alternates corners & midpoints: link the midpoints to a center vertex
+	Dart d0 = phi1(m, corners[0]);
+	Dart d1 = phi<11>(m, d0);
+	cut_face(m, Vertex(d0), Vertex(d1));
+	cut_edge(m, Edge(phi_1(m, d0)));
+	Dart x = phi2(m, phi_1(m, d0));
+	Dart dd = phi<1111>(m, x);
+	while (dd != x)
+	{
+		Dart next = phi<11>(m, dd);
+		cut_face(m, Vertex(dd), Vertex(phi1(m, x)));
+		dd = next;
+	}
+
+	Vertex center(phi2(m, x));
+	value<Vec3>(m, swa.vertex_position_, center) = center_position;
+	value<uint32>(m, swa.vertex_level_, center) = level + 1;
+	value<uint8>(m, swa.vertex_center_, center) = 1u;
+
+	Scalar children_area = 0.0;
+	foreach_incident_face(m, center, [&](Face cf) -> bool {
+		compute_face_geometry(m, swa, cf);
+		children_area += value<Scalar>(m, swa.face_area_, cf);
+		return true;
+	});
+	const Scalar ratio = area / children_area;
+	foreach_incident_face(m, center, [&](Face cf) -> bool {
+		value<uint32>(m, swa.face_level_, cf) = level + 1;
+		value<Scalar>(m, swa.face_h_, cf) = h * ratio;
+		value<Scalar>(m, swa.face_q_, cf) = q * ratio;
+		value<Scalar>(m, swa.face_r_, cf) = r * ratio;
+		value<Scalar>(m, swa.face_zb_, cf) = zb;
+		value<Scalar>(m, swa.face_phi_, cf) = porosity;
+		return true;
+	});
+
+	return true;
+}
+
+/**
+ * @brief merge the children of the face subdivided with the given center vertex: the merged face gets the volume, the
+ * momentum & the mean bottom elevation of the children
+ * @return false if the children cannot be merged (a child is subdivided or a neighbour is finer than the children)
+ */
+template <typename MESH>
+bool coarsen_faces(MESH& m, Attributes<MESH>& swa, typename mesh_traits<MESH>::Vertex center)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	const uint32 level = value<uint32>(m, swa.vertex_level_, center);
+	const uint32 center_index = index_of(m, center);
+
+	bool mergeable = true;
+	Scalar area = 0.0;
+	Scalar volume = 0.0;
+	Scalar q = 0.0;
+	Scalar r = 0.0;
+	Scalar zb = 0.0;
+	Scalar porosity = 0.0;
+	// darts of the children that start at a midpoint & are on the border of the parent face
+	std::vector<Dart> midpoints;
+	foreach_incident_face(m, center, [&](Face cf) -> bool {
+		if (value<uint32>(m, swa.face_level_, cf) != level)
+			mergeable = false;
+		foreach_dart_of_orbit(m, cf, [&](Dart d) -> bool {
+			Dart d2 = phi2(m, d);
+			if (!is_boundary(m, d2) && value<uint32>(m, swa.face_level_, Face(d2)) > level)
+				mergeable = false;
+			// the corners of the children may be the centers of coarser faces: only the own center is excluded
+			if (value<uint32>(m, swa.vertex_level_, Vertex(d)) == level && index_of(m, Vertex(d)) != center_index &&
+				index_of(m, Vertex(phi1(m, d))) != center_index)
+				midpoints.push_back(d);
+			return mergeable;
+		});
+		Scalar a = value<Scalar>(m, swa.face_area_, cf);
+		area += a;
+		volume += value<Scalar>(m, swa.face_h_, cf) * a;
+		q += value<Scalar>(m, swa.face_q_, cf) * a;
+		r += value<Scalar>(m, swa.face_r_, cf) * a;
+		zb += value<Scalar>(m, swa.face_zb_, cf) * a;
+		porosity += value<Scalar>(m, swa.face_phi_, cf) * a;
+		return mergeable;
+	});
+	if (!mergeable || midpoints.empty())
+		return false;
+
+	std::vector<Edge> spokes;
+	foreach_incident_edge(m, center, [&](Edge e) -> bool {
+		spokes.push_back(e);
+		return true;
+	});
+	// the last spoke is left dangling inside the merged face & is removed by the last merge
+	for (Edge e : spokes)
+		merge_incident_faces(m, e);
+
+	// the midpoints only used by the children become regular points of the edges of the merged face
+	for (Dart d : midpoints)
+	{
+		if (degree(m, Vertex(d)) == 2)
+			collapse_edge(m, Edge(phi_1(m, d)));
+	}
+
+	// merge_incident_faces only reindexes one dart of the merged face: give the same index to all its darts
+	Face pf(midpoints[0]);
+	set_index(m, pf, index_of(m, pf));
+	compute_face_geometry(m, swa, pf);
+	const Scalar parent_area = value<Scalar>(m, swa.face_area_, pf);
+	value<uint32>(m, swa.face_level_, pf) = level - 1;
+	value<Scalar>(m, swa.face_h_, pf) = volume / parent_area;
+	value<Scalar>(m, swa.face_q_, pf) = q / parent_area;
+	value<Scalar>(m, swa.face_r_, pf) = r / parent_area;
+	value<Scalar>(m, swa.face_zb_, pf) = zb / area;
+	value<Scalar>(m, swa.face_phi_, pf) = porosity / area;
+
+	return true;
+}
+
+/**
+ * @brief subdivide the faces where the water height varies more than swc.refinement_threshold_ & merge back the
+ * subdivided faces where it varies less than swc.coarsening_threshold_, then update the edges & the connectivity
+ */
+template <typename MESH>
+void adapt_mesh(MESH& m, Attributes<MESH>& swa, Context& swc)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	const Connectivity& c = swa.connectivity_;
+
+	// largest difference between the water height of each face & the ones of its neighbours (by face index)
+	uint32 max_face_index = 0u;
+	for (uint32 fidx : c.faces_)
+		max_face_index = std::max(max_face_index, fidx);
+	std::vector<Scalar> h_jump(max_face_index + 1, 0.0);
+	thread_pool()->parallel_for(0u, c.nb_faces(), PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
 		{
-			(*swa.face_q_)[fidx] = 0.;
-			(*swa.face_r_)[fidx] = 0.;
+			uint32 fidx = c.faces_[i];
+			Scalar jump = 0.0;
+			for (uint32 k = c.face_edges_offset_[i], end = c.face_edges_offset_[i + 1]; k < end; ++k)
+			{
+				uint32 nidx = c.face_edges_neighbour_[k];
+				if (nidx != INVALID_INDEX)
+					jump = std::max(jump, fabs((*swa.face_h_)[fidx] - (*swa.face_h_)[nidx]));
+			}
+			h_jump[fidx] = jump;
 		}
+	});
 
+	std::vector<Face> to_refine;
+	foreach_cell(m, [&](Face f) -> bool {
+		if (value<uint32>(m, swa.face_level_, f) < swc.max_level_ &&
+			h_jump[index_of(m, f)] > swc.refinement_threshold_)
+			to_refine.push_back(f);
+		return true;
+	});
+	std::vector<Vertex> to_coarsen;
+	foreach_cell(m, [&](Vertex v) -> bool {
+		if (!value<uint8>(m, swa.vertex_center_, v))
+			return true;
+		const uint32 level = value<uint32>(m, swa.vertex_level_, v);
+		bool calm = true;
+		foreach_incident_face(m, v, [&](Face f) -> bool {
+			calm = value<uint32>(m, swa.face_level_, f) == level && h_jump[index_of(m, f)] < swc.coarsening_threshold_;
+			return calm;
+		});
+		if (calm)
+			to_coarsen.push_back(v);
 		return true;
 	});
 
-	// simu_data_access_.unlock();
+	// the coarsest faces first: a face is not subdivided while one of its neighbours is coarser
+	std::stable_sort(to_refine.begin(), to_refine.end(), [&](Face f1, Face f2) {
+		return value<uint32>(m, swa.face_level_, f1) < value<uint32>(m, swa.face_level_, f2);
+	});
+	for (Face f : to_refine)
+		refine_face(m, swa, f);
+	for (Vertex v : to_coarsen)
+		coarsen_faces(m, swa, v);
 
-	// if (adaptive_mesh_)
-	// {
-	// 	if (nb_iter_ % iteradapt_ == 0 )
-	// 	{
-	// 		map_->lock_topo_access();
-	// 		try_simplification();
-	// 		try_subdivision();
-	// 		map_->unlock_topo_access();
-	// 	}
-	// }
+	compute_edge_geometry(m, swa);
+	build_connectivity(m, swa);
+}
+
+template <typename MESH>
+void execute_time_step(MESH& m, Attributes<MESH>& swa, Context& swc)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	auto start = Clock::now();
+	auto kernel_start = start;
+	auto end_kernel = [&](const char* name) {
+		if (swc.measure_kernel_timings_)
+		{
+			auto now = Clock::now();
+			add_kernel_timing(swc, name, std::chrono::duration<float64>(now - kernel_start).count());
+			kernel_start = now;
+		}
+	};
+
+	// simu_data_access_.lock();
+
+	if (swc.fused_kernels_)
+		execute_fused_kernels(swa, swc, end_kernel);
+	else
+		execute_kernels(m, swa, swc, end_kernel);
+
+	// simu_data_access_.unlock();
 
 	swc.t_ += swc.dt_;
-	// nb_iter_++;
+	++swc.nb_steps_;
+
+	if constexpr (std::is_convertible_v<MESH&, CMap2&>)
+	{
+		if (swc.adaptive_mesh_ && swc.nb_steps_ % swc.adaptation_interval_ == 0)
+		{
+			adapt_mesh(m, swa, swc);
+			end_kernel("adaptation");
+		}
+	}
+
+	if (swc.real_time_)
+	{
+		auto end = Clock::now();
 
-	auto end = std::chrono::high_resolution_clock::now();
+		std::chrono::nanoseconds sleep_duration =
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<Scalar>(swc.dt_)) -
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
 
-	std::chrono::nanoseconds sleep_duration =
-		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<Scalar>(swc.dt_)) -
-		std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+		if (sleep_duration > std::chrono::nanoseconds::zero())
+			std::this_thread::sleep_for(sleep_duration);
+	}
+}
 
-	if (sleep_duration > std::chrono::nanoseconds::zero())
-		std::this_thread::sleep_for(sleep_duration);
+/**
+ * Binary checkpoints of the simulation state: time, time step, number of steps and h, q, r of each face.
+ * The faces are stored in the order of the connectivity cache, which only depends on the domain mesh: a checkpoint
+ * can be reloaded in another run on the same domain. The data is stored in the native byte order.
+ * Checkpoints are not supported on an adaptive mesh, whose faces change during the run.
+ */
+
+static const char CHECKPOINT_MAGIC[8] = {'C', 'G', 'O', 'G', 'N', 'S', 'W', 'C'};
+static const uint32 CHECKPOINT_VERSION = 1u;
+static const uint32 CHECKPOINT_BYTE_ORDER_MARK = 0x01020304u;
+
+/**
+ * @brief save the state of the simulation in the given file (written in a temporary file first so that an interrupted
+ * save does not destroy a previous checkpoint)
+ * @return false if the file could not be written
+ */
+template <typename MESH>
+bool save_checkpoint(const Attributes<MESH>& swa, const Context& swc, const std::string& filename)
+{
+	if (swc.adaptive_mesh_)
+	{
+		std::cerr << "save_checkpoint: checkpoints are not supported on an adaptive mesh" << std::endl;
+		return false;
+	}
+
+	const Connectivity& c = swa.connectivity_;
+	const uint32 nb_faces = c.nb_faces();
+
+	std::vector<Scalar> values(3u * nb_faces);
+	thread_pool()->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint32 fidx = c.faces_[i];
+			values[i] = (*swa.face_h_)[fidx];
+			values[nb_faces + i] = (*swa.face_q_)[fidx];
+			values[2u * nb_faces + i] = (*swa.face_r_)[fidx];
+		}
+	});
+
+	const std::string tmp_filename = filename + ".tmp";
+	{
+		std::ofstream out(tmp_filename, std::ios::out | std::ios::binary);
+		if (!out.good())
+		{
+			std::cerr << "save_checkpoint: could not open \"" << tmp_filename << "\"" << std::endl;
+			return false;
+		}
+		out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+		out.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(uint32));
+		out.write(reinterpret_cast<const char*>(&CHECKPOINT_BYTE_ORDER_MARK), sizeof(uint32));
+		out.write(reinterpret_cast<const char*>(&nb_faces), sizeof(uint32));
+		out.write(reinterpret_cast<const char*>(&swc.t_), sizeof(Scalar));
+		out.write(reinterpret_cast<const char*>(&swc.dt_), sizeof(Scalar));
+		out.write(reinterpret_cast<const char*>(&swc.nb_steps_), sizeof(uint32));
+		out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(Scalar));
+		if (!out.good())
+		{
+			std::cerr << "save_checkpoint: could not write \"" << tmp_filename << "\"" << std::endl;
+			return false;
+		}
+	}
+
+	// POSIX rename atomically replaces an existing checkpoint, whereas the Windows one fails if the target exists
+#ifdef _WIN32
+	std::remove(filename.c_str());
+#endif
+	if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+	{
+		std::cerr << "save_checkpoint: could not rename \"" << tmp_filename << "\"" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief restore the state of the simulation from the given checkpoint (the attributes must be initialized)
+ * @return false if the file is not a valid checkpoint of this domain
+ */
+template <typename MESH>
+bool load_checkpoint(Attributes<MESH>& swa, Context& swc, const std::string& filename)
+{
+	if (swc.adaptive_mesh_)
+	{
+		std::cerr << "load_checkpoint: checkpoints are not supported on an adaptive mesh" << std::endl;
+		return false;
+	}
+
+	const Connectivity& c = swa.connectivity_;
+	const uint32 nb_faces = c.nb_faces();
+
+	std::ifstream in(filename, std::ios::in | std::ios::binary);
+	if (!in.good())
+	{
+		std::cerr << "load_checkpoint: could not open \"" << filename << "\"" << std::endl;
+		return false;
+	}
+
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	uint32 version = 0u;
+	uint32 byte_order_mark = 0u;
+	uint32 nb = 0u;
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(&version), sizeof(uint32));
+	in.read(reinterpret_cast<char*>(&byte_order_mark), sizeof(uint32));
+	in.read(reinterpret_cast<char*>(&nb), sizeof(uint32));
+	if (!in.good() || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION ||
+		byte_order_mark != CHECKPOINT_BYTE_ORDER_MARK)
+	{
+		std::cerr << "load_checkpoint: \"" << filename << "\" is not a valid checkpoint" << std::endl;
+		return false;
+	}
+	if (nb != nb_faces)
+	{
+		std::cerr << "load_checkpoint: \"" << filename << "\" is a checkpoint of a domain with " << nb << " faces"
+				  << std::endl;
+		return false;
+	}
+
+	Scalar t, dt;
+	uint32 nb_steps;
+	std::vector<Scalar> values(3u * nb_faces);
+	in.read(reinterpret_cast<char*>(&t), sizeof(Scalar));
+	in.read(reinterpret_cast<char*>(&dt), sizeof(Scalar));
+	in.read(reinterpret_cast<char*>(&nb_steps), sizeof(uint32));
+	in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(Scalar));
+	if (!in.good())
+	{
+		std::cerr << "load_checkpoint: \"" << filename << "\" is truncated" << std::endl;
+		return false;
+	}
+
+	swc.t_ = t;
+	swc.dt_ = dt;
+	swc.nb_steps_ = nb_steps;
+	thread_pool()->parallel_for(0u, nb_faces, PARALLEL_BUFFER_SIZE, [&](uint32 b, uint32 e) {
+		for (uint32 i = b; i < e; ++i)
+		{
+			uint32 fidx = c.faces_[i];
+			(*swa.face_h_)[fidx] = values[i];
+			(*swa.face_q_)[fidx] = values[nb_faces + i];
+			(*swa.face_r_)[fidx] = values[2u * nb_faces + i];
+		}
+	});
+	return true;
 }
 
 } // namespace shallow_water
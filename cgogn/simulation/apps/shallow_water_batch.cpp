@@ -0,0 +1,177 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/cmap/cmap2.h>
+#include <cgogn/core/utils/string.h>
+
+#include <cgogn/io/surface/obj.h>
+#include <cgogn/io/surface/off.h>
+#include <cgogn/io/surface/ply.h>
+
+#include <cgogn/simulation/algos/shallow_water/shallow_water.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using namespace cgogn::numerics;
+
+using Mesh = cgogn::CMap2;
+
+namespace sw = cgogn::simulation::shallow_water;
+
+// headless shallow-water run: no display & no wall-clock throttling of the time steps
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0]
+				  << " surface_file [-t t_max] [-n max_nb_steps] [-c checkpoint_file] [-i checkpoint_interval]"
+					 " [-r restart_file] [-f] [-a max_level]"
+				  << std::endl;
+		return 1;
+	}
+	std::string filename(argv[1]);
+
+	sw::Context sw_context;
+	sw_context.real_time_ = false;
+	sw_context.measure_kernel_timings_ = true;
+
+	uint32 max_nb_steps = std::numeric_limits<uint32>::max();
+	std::string checkpoint_filename;
+	uint32 checkpoint_interval = 1000u;
+	std::string restart_filename;
+
+	for (int i = 2; i < argc; ++i)
+	{
+		std::string option(argv[i]);
+		if (option == "-f")
+		{
+			sw_context.fused_kernels_ = true;
+			continue;
+		}
+		if (i + 1 == argc)
+		{
+			std::cout << "Missing value for option " << option << std::endl;
+			return 1;
+		}
+		++i;
+		if (option == "-t")
+			sw_context.t_max_ = std::atof(argv[i]);
+		else if (option == "-n")
+			max_nb_steps = uint32(std::atol(argv[i]));
+		else if (option == "-c")
+			checkpoint_filename = argv[i];
+		else if (option == "-i")
+			checkpoint_interval = std::max(1u, uint32(std::atol(argv[i])));
+		else if (option == "-r")
+			restart_filename = argv[i];
+		else if (option == "-a")
+		{
+			sw_context.adaptive_mesh_ = true;
+			sw_context.max_level_ = uint32(std::atol(argv[i]));
+		}
+		else
+		{
+			std::cout << "Unknown option " << option << std::endl;
+			return 1;
+		}
+	}
+
+	if (sw_context.adaptive_mesh_ && (!checkpoint_filename.empty() || !restart_filename.empty()))
+	{
+		std::cout << "Checkpoints are not supported on an adaptive mesh" << std::endl;
+		return 1;
+	}
+
+	cgogn::thread_start();
+
+	Mesh domain;
+	std::string ext = cgogn::extension(filename);
+	bool imported = false;
+	if (ext.compare("off") == 0)
+		imported = cgogn::io::import_OFF(domain, filename);
+	else if (ext.compare("obj") == 0)
+		imported = cgogn::io::import_OBJ(domain, filename);
+	else if (ext.compare("ply") == 0)
+		imported = cgogn::io::import_PLY(domain, filename);
+	if (!imported)
+	{
+		std::cout << "File could not be loaded" << std::endl;
+		return 1;
+	}
+
+	sw::Attributes<Mesh> sw_attributes;
+	sw::get_attributes(domain, sw_attributes);
+	sw::init_attributes(domain, sw_attributes, sw_context);
+
+	if (!restart_filename.empty())
+	{
+		if (!sw::load_checkpoint(sw_attributes, sw_context, restart_filename))
+			return 1;
+		std::cout << "Restart from step " << sw_context.nb_steps_ << " (t = " << sw_context.t_ << ")" << std::endl;
+	}
+
+	using Clock = std::chrono::high_resolution_clock;
+	auto start = Clock::now();
+	uint32 nb_steps = 0u;
+
+	auto report = [&]() {
+		float64 duration = std::chrono::duration<float64>(Clock::now() - start).count();
+		std::cout << "step " << sw_context.nb_steps_ << ", t = " << sw_context.t_ << ", dt = " << sw_context.dt_ << ", "
+				  << sw_attributes.connectivity_.nb_faces() << " faces, " << std::fixed << std::setprecision(1)
+				  << (nb_steps / std::max(duration, 1e-9)) << " steps/s"
+				  << std::defaultfloat << std::setprecision(6) << std::endl;
+	};
+
+	while (sw_context.t_ < sw_context.t_max_ && nb_steps < max_nb_steps)
+	{
+		sw::execute_time_step(domain, sw_attributes, sw_context);
+		++nb_steps;
+
+		if (!checkpoint_filename.empty() && sw_context.nb_steps_ % checkpoint_interval == 0u)
+		{
+			if (!sw::save_checkpoint(sw_attributes, sw_context, checkpoint_filename))
+				return 1;
+			report();
+		}
+	}
+
+	if (!checkpoint_filename.empty() && !sw::save_checkpoint(sw_attributes, sw_context, checkpoint_filename))
+		return 1;
+
+	float64 duration = std::chrono::duration<float64>(Clock::now() - start).count();
+	report();
+	std::cout << nb_steps << " steps in " << duration << " s" << std::endl;
+	for (const auto& [kernel, time] : sw_context.kernel_timings_)
+		std::cout << "  " << std::left << std::setw(28) << kernel << std::right << std::fixed << std::setprecision(3)
+				  << time << " s (" << std::setprecision(3) << (1000.0 * time / std::max(nb_steps, 1u))
+				  << " ms/step)" << std::defaultfloat << std::endl;
+
+	return 0;
+}